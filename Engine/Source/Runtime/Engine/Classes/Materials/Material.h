@@ -9,6 +9,7 @@
 #include "RenderCommandFence.h"
 #include "Materials/MaterialInterface.h"
 #include "MaterialShared.h"
+#include "Materials/MobileDownsampleTranslucencyResolution.h"
 #include "MaterialCachedData.h"
 #include "MaterialExpressionIO.h"
 #include "Materials/MaterialExpressionMaterialFunctionCall.h"
@@ -507,10 +508,13 @@ public:
 	UPROPERTY(EditAnywhere, Category = Translucency, meta = (DisplayName = "Mobile Separate Translucency"), AdvancedDisplay)
 	uint8 bEnableMobileSeparateTranslucency : 1;
 
-	//YJH Created By 2020-7-25
+	/** Replaced by MobileDownsampleSeparateTranslucencyResolution, only read to convert assets which disabled it. */
+	UPROPERTY()
+	uint8 bEnableMobileDownsampleSeparateTranslucency_DEPRECATED : 1;
+
+	/** Renders the material off-screen at the given resolution on mobile, then upsamples it onto scene color. Only applies to translucent and additive materials. */
 	UPROPERTY(EditAnywhere, Category = Translucency, meta = (DisplayName = "Mobile DownSample Separate Translucency"), AdvancedDisplay)
-	uint8 bEnableMobileDownsampleSeparateTranslucency : 1;
-	//End
+	EMobileDownsampleTranslucencyResolution MobileDownsampleSeparateTranslucencyResolution;
 
 
 	/** Number of customized UV inputs to display.  Unconnected customized UV inputs will just pass through the vertex UVs. */
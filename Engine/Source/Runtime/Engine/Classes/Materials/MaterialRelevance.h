@@ -6,6 +6,7 @@
 #include "CoreMinimal.h"
 
 struct FPrimitiveViewRelevance;
+enum class EMobileDownsampleTranslucencyResolution : uint8;
 
 // the class is only storing bits, initialized to 0 and has an |= operator
 // to provide a combined set of multiple materials (component / mesh)
@@ -41,6 +42,8 @@ struct ENGINE_API FMaterialRelevance
 			uint8 bUsesCustomDepthStencil : 1;
 			uint8 bUsesDistanceCullFade : 1;
 			uint8 bDisableDepthTest : 1;
+			/** GetMobileDownsampleTranslucencyResolutionBit of every off-screen particle resolution used, bDownSampleSeparateTranslucency is set with any. */
+			uint8 DownSampleSeparateTranslucencyResolutionMask : 4;
 		};
 		uint64 Raw;
 	};
@@ -60,6 +63,12 @@ struct ENGINE_API FMaterialRelevance
 
 	/** Copies the material's relevance flags to a primitive's view relevance flags. */
 	void SetPrimitiveViewRelevance(FPrimitiveViewRelevance& OutViewRelevance) const;
+
+	/**
+	 * Sets the bits routing a material to the translucency passes, DownsampleResolution being Disabled for the blend modes the
+	 * off-screen particle passes can't composite. Shared by UMaterialInterface::GetRelevance_Internal and the routing validation.
+	 */
+	void SetTranslucencyPassRelevance(bool bIsTranslucent, bool bMaterialSeparateTranslucency, bool bMaterialSeparateModulation, EMobileDownsampleTranslucencyResolution DownsampleResolution);
 };
 
 static_assert(sizeof(FMaterialRelevance) == sizeof(FMaterialRelevance::Raw), "Union Raw type is too small");
@@ -0,0 +1,31 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectMacros.h"
+#include "MobileDownsampleTranslucencyResolution.generated.h"
+
+/** Resolution a translucent material is rendered at by the mobile off-screen particle pass. */
+UENUM()
+enum class EMobileDownsampleTranslucencyResolution : uint8
+{
+	/** Rendered with the rest of the translucency at scene color resolution. */
+	Disabled,
+	/** Off-screen at full resolution, composited with the other off-screen particles. */
+	Full,
+	/** Off-screen at half resolution. */
+	Half,
+	/** Off-screen at quarter resolution. */
+	Quarter,
+	/** Off-screen at the resolution picked by r.Mobile.SeparateTranslucencyScreenPercentage and r.Mobile.SeparateTranslucencyAutoDownsample. */
+	Auto,
+
+	Num UMETA(Hidden)
+};
+
+/** Bit of a resolution in FMaterialRelevance::DownSampleSeparateTranslucencyResolutionMask, Disabled has none. */
+inline uint8 GetMobileDownsampleTranslucencyResolutionBit(EMobileDownsampleTranslucencyResolution Resolution)
+{
+	return Resolution == EMobileDownsampleTranslucencyResolution::Disabled ? 0 : uint8(1u << (uint8(Resolution) - 1));
+}
@@ -81,6 +81,7 @@
 #include "Curves/CurveLinearColorAtlas.h"
 #include "HAL/ThreadHeartBeat.h"
 #include "Misc/ScopedSlowTask.h"
+#include "Misc/CoreDelegates.h"
 
 #define LOCTEXT_NAMESPACE "Material"
 
@@ -922,7 +923,8 @@ UMaterial::UMaterial(const FObjectInitializer& ObjectInitializer)
 	MaxDisplacement = 0.0f;
 	bEnableSeparateTranslucency = true;
 	bEnableMobileSeparateTranslucency = false;
-	bEnableMobileDownsampleSeparateTranslucency = true;
+	bEnableMobileDownsampleSeparateTranslucency_DEPRECATED = true;
+	MobileDownsampleSeparateTranslucencyResolution = EMobileDownsampleTranslucencyResolution::Auto;
 	bEnableResponsiveAA = false;
 	bScreenSpaceReflections = false;
 	bContactShadows = false;
@@ -3484,6 +3486,13 @@ void UMaterial::PostLoad()
 		MaterialDomain = MD_UI;
 	}
 
+	// The deprecated flag defaulted to true, so it is only serialized by assets which turned the pass off
+	if (!bEnableMobileDownsampleSeparateTranslucency_DEPRECATED)
+	{
+		MobileDownsampleSeparateTranslucencyResolution = EMobileDownsampleTranslucencyResolution::Disabled;
+		bEnableMobileDownsampleSeparateTranslucency_DEPRECATED = true;
+	}
+
 #if WITH_EDITORONLY_DATA
 	// Ensure expressions have been postloaded before we use them for compiling
 	// Any UObjects used by material compilation must be postloaded here
@@ -3722,6 +3731,112 @@ void UMaterial::PropagateDataToMaterialProxy()
 {
 	UpdateMaterialRenderProxy(*DefaultMaterialInstance);
 }
+#if WITH_EDITOR
+/**
+ * Cook totals of the materials drawn off-screen and of their mobile base pass pixel shaders, the only ones compiled with
+ * MOBILE_DOWNSAMPLE_TRANSLUCENCY, gathered as cooked material resources are released and logged on exit of the cook,
+ * or with r.Mobile.OffScreenParticles.CookReport. The define changes the code of these shaders, it adds no permutation,
+ * so the bytes are their whole code and not what the feature costs on top of the stock base pass.
+ */
+namespace MobileDownsampleTranslucencyCookReport
+{
+	struct FTotals
+	{
+		int32 NumMaterials = 0;
+		int32 NumShaders = 0;
+		/** Compressed code of the mobile base pass pixel shaders of these materials, entries shared within a map counted once. */
+		uint64 NumBytes = 0;
+	};
+
+	static FCriticalSection TotalsCS;
+	static TMap<FString, FTotals> TotalsPerPlatform;
+	/** Material path and platform already counted, a material can be cached and released more than once per cook. */
+	static TSet<TPair<FString, FString>> CountedMaterials;
+
+	static void Report()
+	{
+		FScopeLock Lock(&TotalsCS);
+		for (const TPair<FString, FTotals>& Pair : TotalsPerPlatform)
+		{
+			UE_LOG(LogMaterial, Display, TEXT("Mobile off-screen particles [%s]: %d materials, %d mobile base pass pixel shaders, %.1f KB of code in these shaders"),
+				*Pair.Key, Pair.Value.NumMaterials, Pair.Value.NumShaders, Pair.Value.NumBytes / 1024.0);
+		}
+	}
+
+	/** Identified by their shader type, every type of the mobile base pass pixel shader is compiled from this file. */
+	static bool IsMobileBasePassPixelShaderType(const FShaderType* ShaderType)
+	{
+		return ShaderType && ShaderType->GetFrequency() == SF_Pixel && FCString::Strcmp(ShaderType->GetShaderFilename(), TEXT("/Engine/Private/MobileBasePassPixelShader.usf")) == 0;
+	}
+
+	static void Accumulate(const UMaterial* Material, const ITargetPlatform* TargetPlatform, const TArray<FMaterialResource*>& MaterialResources)
+	{
+		FTotals MaterialTotals;
+		for (const FMaterialResource* MaterialResource : MaterialResources)
+		{
+			FMaterialShaderMap* ShaderMap = MaterialResource ? MaterialResource->GetGameThreadShaderMap() : nullptr;
+			if (!ShaderMap || MaterialResource->GetFeatureLevel() > ERHIFeatureLevel::ES3_1 || !MaterialResource->IsMobileDownSampleSeparateTranslucencyEnabled())
+			{
+				continue;
+			}
+
+			const FShaderMapResourceCode* ResourceCode = ShaderMap->GetResourceCode();
+			if (!ResourceCode || ResourceCode->ShaderEntries.Num() == 0)
+			{
+				continue;
+			}
+
+			TMap<FShaderId, TShaderRef<FShader>> Shaders;
+			ShaderMap->GetShaderList(Shaders);
+
+			// The code entries are deduplicated, several shaders of the map can reference the same one
+			TBitArray<> BasePassCode(false, ResourceCode->ShaderEntries.Num());
+			for (const TPair<FShaderId, TShaderRef<FShader>>& Pair : Shaders)
+			{
+				if (IsMobileBasePassPixelShaderType(Pair.Value.GetType()))
+				{
+					MaterialTotals.NumShaders++;
+					BasePassCode[Pair.Value->GetResourceIndex()] = true;
+				}
+			}
+
+			for (TConstSetBitIterator<> It(BasePassCode); It; ++It)
+			{
+				MaterialTotals.NumBytes += ResourceCode->ShaderEntries[It.GetIndex()].Code.Num();
+			}
+		}
+
+		if (MaterialTotals.NumShaders == 0)
+		{
+			return;
+		}
+
+		FScopeLock Lock(&TotalsCS);
+		bool bAlreadyCounted = false;
+		CountedMaterials.Add(TPair<FString, FString>(Material->GetPathName(), TargetPlatform->PlatformName()), &bAlreadyCounted);
+		if (bAlreadyCounted)
+		{
+			return;
+		}
+
+		if (TotalsPerPlatform.Num() == 0)
+		{
+			FCoreDelegates::OnPreExit.AddStatic(&Report);
+		}
+		FTotals& Totals = TotalsPerPlatform.FindOrAdd(TargetPlatform->PlatformName());
+		Totals.NumMaterials++;
+		Totals.NumShaders += MaterialTotals.NumShaders;
+		Totals.NumBytes += MaterialTotals.NumBytes;
+	}
+
+	static FAutoConsoleCommand CmdCookReport(
+		TEXT("r.Mobile.OffScreenParticles.CookReport"),
+		TEXT("Logs the number of materials drawn off-screen cooked so far, and the number and code size of their mobile base pass pixel shaders."),
+		FConsoleCommandDelegate::CreateStatic(Report)
+		);
+}
+#endif // WITH_EDITOR
+
 #if WITH_EDITOR
 void UMaterial::BeginCacheForCookedPlatformData( const ITargetPlatform *TargetPlatform )
 {
@@ -3780,6 +3895,8 @@ void UMaterial::ClearCachedCookedPlatformData( const ITargetPlatform *TargetPlat
 	TArray<FMaterialResource*> *CachedMaterialResourcesForPlatform = CachedMaterialResourcesForCooking.Find( TargetPlatform );
 	if ( CachedMaterialResourcesForPlatform != NULL )
 	{
+		MobileDownsampleTranslucencyCookReport::Accumulate(this, TargetPlatform, *CachedMaterialResourcesForPlatform);
+
 		for (int32 CachedResourceIndex = 0; CachedResourceIndex < CachedMaterialResourcesForPlatform->Num(); CachedResourceIndex++)
 		{
 			delete (*CachedMaterialResourcesForPlatform)[CachedResourceIndex];
@@ -3796,6 +3913,7 @@ void UMaterial::ClearAllCachedCookedPlatformData()
 	for ( auto It : CachedMaterialResourcesForCooking )
 	{
 		TArray<FMaterialResource*> &CachedMaterialResourcesForPlatform = It.Value;
+		MobileDownsampleTranslucencyCookReport::Accumulate(this, It.Key, CachedMaterialResourcesForPlatform);
 		for (int32 CachedResourceIndex = 0; CachedResourceIndex < CachedMaterialResourcesForPlatform.Num(); CachedResourceIndex++)
 		{
 			delete (CachedMaterialResourcesForPlatform)[CachedResourceIndex];
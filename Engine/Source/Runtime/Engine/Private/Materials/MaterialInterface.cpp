@@ -41,6 +41,16 @@ void FMaterialRelevance::SetPrimitiveViewRelevance(FPrimitiveViewRelevance& OutV
 	OutViewRelevance.Raw = Raw;
 }
 
+void FMaterialRelevance::SetTranslucencyPassRelevance(bool bIsTranslucent, bool bMaterialSeparateTranslucency, bool bMaterialSeparateModulation, EMobileDownsampleTranslucencyResolution DownsampleResolution)
+{
+	bDownSampleSeparateTranslucency = DownsampleResolution != EMobileDownsampleTranslucencyResolution::Disabled;
+	DownSampleSeparateTranslucencyResolutionMask = GetMobileDownsampleTranslucencyResolutionBit(DownsampleResolution);
+
+	bSeparateTranslucency = bIsTranslucent && bMaterialSeparateTranslucency && !bDownSampleSeparateTranslucency;
+	bSeparateTranslucencyModulate = bIsTranslucent && bMaterialSeparateModulation;
+	bNormalTranslucency = bIsTranslucent && !bMaterialSeparateTranslucency && !bDownSampleSeparateTranslucency;
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 UMaterialInterface::UMaterialInterface(const FObjectInitializer& ObjectInitializer)
@@ -188,13 +198,10 @@ FMaterialRelevance UMaterialInterface::GetRelevance_Internal(const UMaterial* Ma
 			MaterialRelevance.bDistortion = MaterialResource->IsDistorted();
 			MaterialRelevance.bHairStrands = IsCompatibleWithHairStrands(MaterialResource, InFeatureLevel);
 
-			//1.Only Mobile
-			//2.Blend is Translucency or Additive,
-			MaterialRelevance.bDownSampleSeparateTranslucency = bIsMobile && Material->bEnableMobileDownsampleSeparateTranslucency && (BlendMode == BLEND_Translucent || BlendMode == BLEND_Additive);
-
-			MaterialRelevance.bSeparateTranslucency = bIsTranslucent && bMaterialSeparateTranslucency && !MaterialRelevance.bDownSampleSeparateTranslucency;
-			MaterialRelevance.bSeparateTranslucencyModulate = bIsTranslucent && bMaterialSeparateModulation;
-			MaterialRelevance.bNormalTranslucency = bIsTranslucent && !bMaterialSeparateTranslucency && !MaterialRelevance.bDownSampleSeparateTranslucency;
+			// Only translucent and additive blending can be composited from the off-screen target, as per FMaterialResource::GetMobileDownsampleTranslucencyResolution
+			const bool bSupportsDownsample = bIsMobile && (BlendMode == BLEND_Translucent || BlendMode == BLEND_Additive);
+			const EMobileDownsampleTranslucencyResolution DownsampleResolution = bSupportsDownsample ? Material->MobileDownsampleSeparateTranslucencyResolution : EMobileDownsampleTranslucencyResolution::Disabled;
+			MaterialRelevance.SetTranslucencyPassRelevance(bIsTranslucent, bMaterialSeparateTranslucency, bMaterialSeparateModulation, DownsampleResolution);
 
 
 			MaterialRelevance.bDisableDepthTest = bIsTranslucent && Material->bDisableDepthTest;		
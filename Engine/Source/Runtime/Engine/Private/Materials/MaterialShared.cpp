@@ -1184,13 +1184,14 @@ bool FMaterialResource::IsMobileSeparateTranslucencyEnabled() const
 	return Material->bEnableMobileSeparateTranslucency && !IsUIMaterial() && !IsDeferredDecal();
 }
 
-//Yjh Created By 2020-7-25
-bool FMaterialResource::IsMobileDownSampleSeparateTranslucencyEnabled() const {
-	return Material->bEnableMobileDownsampleSeparateTranslucency && (Material->BlendMode == BLEND_Translucent || Material->BlendMode == BLEND_Additive);
+EMobileDownsampleTranslucencyResolution FMaterialResource::GetMobileDownsampleTranslucencyResolution() const
+{
+	// Instance blend mode overrides count, the relevance is computed from them too
+	const EBlendMode BlendMode = GetBlendMode();
+	const bool bSupportsDownsample = BlendMode == BLEND_Translucent || BlendMode == BLEND_Additive;
+	return bSupportsDownsample ? Material->MobileDownsampleSeparateTranslucencyResolution : EMobileDownsampleTranslucencyResolution::Disabled;
 }
 
-//End
-
 
 bool FMaterialResource::IsAdaptiveTessellationEnabled() const
 {
@@ -26,6 +26,7 @@
 #include "Serialization/MemoryWriter.h"
 #include "Serialization/ArchiveProxy.h"
 #include "MaterialSceneTextureId.h"
+#include "Materials/MobileDownsampleTranslucencyResolution.h"
 #include "VirtualTexturing.h"
 
 struct FExpressionInput;
@@ -1588,9 +1589,9 @@ public:
 	virtual bool IsTranslucencyAfterDOFEnabled() const { return false; }
 	virtual bool IsDualBlendingEnabled(EShaderPlatform Platform) const { return false; }
 	virtual bool IsMobileSeparateTranslucencyEnabled() const { return false; }
-	//YJH Created By 2020-7-25
-	virtual bool IsMobileDownSampleSeparateTranslucencyEnabled() const { return false; }
-	//End
+	/** Resolution tier of the mobile off-screen particle pass, Disabled when the material is rendered with the regular translucency. */
+	virtual EMobileDownsampleTranslucencyResolution GetMobileDownsampleTranslucencyResolution() const { return EMobileDownsampleTranslucencyResolution::Disabled; }
+	bool IsMobileDownSampleSeparateTranslucencyEnabled() const { return GetMobileDownsampleTranslucencyResolution() != EMobileDownsampleTranslucencyResolution::Disabled; }
 	virtual FLinearColor GetTranslucentMultipleScatteringExtinction() const { return FLinearColor::White; }
 	virtual float GetTranslucentShadowStartOffset() const { return 0.0f; }
 	virtual float GetRefractionDepthBiasValue() const { return 0.0f; }
@@ -2384,9 +2385,7 @@ public:
 	ENGINE_API virtual bool IsDualBlendingEnabled(EShaderPlatform Platform) const override;
 	ENGINE_API virtual bool IsMobileSeparateTranslucencyEnabled() const override;
 
-	//YJH Created By 2020-7-25
-	ENGINE_API virtual bool IsMobileDownSampleSeparateTranslucencyEnabled() const override;
-	//End
+	ENGINE_API virtual EMobileDownsampleTranslucencyResolution GetMobileDownsampleTranslucencyResolution() const override;
 
 	ENGINE_API virtual FLinearColor GetTranslucentMultipleScatteringExtinction() const override;
 	ENGINE_API virtual float GetTranslucentShadowStartOffset() const override;
@@ -2919,6 +2918,7 @@ struct FMaterialShaderParameters
 	uint32 DecalBlendMode;
 	int32 NumCustomizedUVs;
 	uint32 StencilCompare;
+	EMobileDownsampleTranslucencyResolution MobileDownsampleTranslucencyResolution;
 	union
 	{
 		uint64 PackedFlags;
@@ -2990,6 +2990,8 @@ struct FMaterialShaderParameters
 		DecalBlendMode = InMaterial->GetDecalBlendMode();
 		NumCustomizedUVs = InMaterial->GetNumCustomizedUVs();
 		StencilCompare = InMaterial->GetStencilCompare();
+		// Only the mobile base pass composites off-screen, other feature levels must not fork their shader maps on it
+		MobileDownsampleTranslucencyResolution = FeatureLevel <= ERHIFeatureLevel::ES3_1 ? InMaterial->GetMobileDownsampleTranslucencyResolution() : EMobileDownsampleTranslucencyResolution::Disabled;
 		bIsDefaultMaterial = InMaterial->IsDefaultMaterial();
 		bIsSpecialEngineMaterial = InMaterial->IsSpecialEngineMaterial();
 		bIsMasked = InMaterial->IsMasked();
@@ -3024,7 +3026,7 @@ struct FMaterialShaderParameters
 		bIsTranslucencyWritingVelocity = InMaterial->IsTranslucencyWritingVelocity();
 		bIsTranslucencyWritingCustomDepth = InMaterial->IsTranslucencyWritingCustomDepth();
 		//YJH Created By 2020-7-28
-		bIsDownSampleSeparateTranslucency = InMaterial->IsMobileDownSampleSeparateTranslucencyEnabled();
+		bIsDownSampleSeparateTranslucency = MobileDownsampleTranslucencyResolution != EMobileDownsampleTranslucencyResolution::Disabled;
 		//End
 		bIsDitheredLODTransition = InMaterial->IsDitheredLODTransition();
 		bIsUsedWithInstancedStaticMeshes = InMaterial->IsUsedWithInstancedStaticMeshes();
@@ -8,6 +8,7 @@ MeshDrawCommandSetup.cpp: Mesh draw command setup.
 #include "RendererModule.h"
 #include "ScenePrivate.h"
 #include "TranslucentRendering.h"
+#include "Misc/ScopeLock.h"
 
 TGlobalResource<FPrimitiveIdVertexBufferPool> GPrimitiveIdVertexBufferPool;
 
@@ -25,6 +26,32 @@ static TAutoConsoleVariable<int32> CVarMobileMeshSortingMethod(
 	TEXT("\t1: Strict front to back sorting.\n"),
 	ECVF_RenderThreadSafe);
 
+DECLARE_DWORD_COUNTER_STAT(TEXT("Mobile Off-Screen Particles Order-Free Draws"), STAT_MobileDownsampleTranslucencyOrderFreeDraws, STATGROUP_SceneRendering);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Mobile Off-Screen Particles PSO Switches"), STAT_MobileDownsampleTranslucencyPipelineSwitches, STATGROUP_SceneRendering);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Mobile Off-Screen Particles PSO Switches Saved"), STAT_MobileDownsampleTranslucencyPipelineSwitchesSaved, STATGROUP_SceneRendering);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Mobile Off-Screen Particles Draws Saved By Instancing"), STAT_MobileDownsampleTranslucencyInstancedDrawsSaved, STATGROUP_SceneRendering);
+
+static TAutoConsoleVariable<int32> CVarMeshDrawCommandsTranslucentRadixSortThreshold(
+	TEXT("r.MeshDrawCommands.TranslucentRadixSortThreshold"),
+	256,
+	TEXT("Translucent passes with at least this many mesh draw commands are sorted with a radix sort instead of a comparison sort.\n")
+	TEXT("0 disables the radix sort."),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<float> CVarMeshDrawCommandsTranslucentIncrementalSort(
+	TEXT("r.MeshDrawCommands.TranslucentIncrementalSort"),
+	4.0f,
+	TEXT("Translucent passes of views with persistent state start from the draw order of the previous frame and finish with an insertion sort.\n")
+	TEXT("The value is the average number of moves per mesh draw command after which the insertion sort gives up for a full sort.\n")
+	TEXT("0 disables the incremental sort."),
+	ECVF_RenderThreadSafe);
+
+DECLARE_CYCLE_STAT(TEXT("Translucent Full Sort"), STAT_TranslucentMeshDrawCommandsFullSort, STATGROUP_SceneRendering);
+DECLARE_CYCLE_STAT(TEXT("Translucent Incremental Sort"), STAT_TranslucentMeshDrawCommandsIncrementalSort, STATGROUP_SceneRendering);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Translucent Incremental Sorts"), STAT_TranslucentMeshDrawCommandsIncrementalSorts, STATGROUP_SceneRendering);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Translucent Incremental Sort Fallbacks"), STAT_TranslucentMeshDrawCommandsIncrementalSortFallbacks, STATGROUP_SceneRendering);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Translucent Incremental Sort Moves"), STAT_TranslucentMeshDrawCommandsIncrementalSortMoves, STATGROUP_SceneRendering);
+
 FPrimitiveIdVertexBufferPool::FPrimitiveIdVertexBufferPool()
 	: DiscardId(0)
 {
@@ -144,8 +171,190 @@ uint32 BitInvertIfNegativeFloat(uint32 f)
 	return f ^ mask;
 }
 
+/** Distance of a translucent primitive along the view's sort policy. */
+static FORCEINLINE float GetTranslucentSortDistance(
+	ETranslucentSortPolicy::Type TranslucentSortPolicy,
+	const FVector& TranslucentSortAxis,
+	const FVector& ViewOrigin,
+	const FMatrix& ViewMatrix,
+	const FVector& BoundsOrigin)
+{
+	if (TranslucentSortPolicy == ETranslucentSortPolicy::SortByDistance)
+	{
+		//sort based on distance to the view position, view rotation is not a factor
+		return (BoundsOrigin - ViewOrigin).Size();
+	}
+	else if (TranslucentSortPolicy == ETranslucentSortPolicy::SortAlongAxis)
+	{
+		// Sort based on enforced orthogonal distance
+		const FVector CameraToObject = BoundsOrigin - ViewOrigin;
+		return FVector::DotProduct(CameraToObject, TranslucentSortAxis);
+	}
+	else
+	{
+		// Sort based on projected Z distance
+		check(TranslucentSortPolicy == ETranslucentSortPolicy::SortByProjectedZ);
+		return ViewMatrix.TransformPosition(BoundsOrigin).Z;
+	}
+}
+
+/** Patches the distance inside a translucent mesh sort key, farther sorts first. */
+static FORCEINLINE void SetTranslucentSortKeyDistance(FMeshDrawCommandSortKey& SortKey, float Distance)
+{
+	uint32 DistanceBits;
+	FMemory::Memcpy(&DistanceBits, &Distance, sizeof(DistanceBits));
+	SortKey.Translucent.Distance = (uint32)~BitInvertIfNegativeFloat(DistanceBits);
+}
+
+static FORCEINLINE const FVector& GetTranslucentSortOrigin(const TArray<struct FPrimitiveBounds>& PrimitiveBounds, int32 PrimitiveIndex)
+{
+	return PrimitiveIndex >= 0 ? PrimitiveBounds[PrimitiveIndex].BoxSphereBounds.Origin : FVector::ZeroVector;
+}
+
+/**
+* Update mesh sort keys with view dependent data, one command at a time. Reference of UpdateTranslucentMeshSortKeys.
+*/
+static void UpdateTranslucentMeshSortKeysScalar(
+	ETranslucentSortPolicy::Type TranslucentSortPolicy,
+	const FVector& TranslucentSortAxis,
+	const FVector& ViewOrigin,
+	const FMatrix& ViewMatrix,
+	const TArray<struct FPrimitiveBounds>& PrimitiveBounds,
+	FMeshCommandOneFrameArray& VisibleMeshCommands
+	)
+{
+	for (int32 CommandIndex = 0; CommandIndex < VisibleMeshCommands.Num(); ++CommandIndex)
+	{
+		FVisibleMeshDrawCommand& VisibleCommand = VisibleMeshCommands[CommandIndex];
+		const FVector& BoundsOrigin = GetTranslucentSortOrigin(PrimitiveBounds, VisibleCommand.ScenePrimitiveId);
+		SetTranslucentSortKeyDistance(VisibleCommand.SortKey, GetTranslucentSortDistance(TranslucentSortPolicy, TranslucentSortAxis, ViewOrigin, ViewMatrix, BoundsOrigin));
+	}
+}
+
+/**
+ * Translucent sort distances of four bounds origins at once, transposed to one register per axis. Operations are in the same
+ * order as GetTranslucentSortDistance so the results match it exactly.
+ */
+class FTranslucentSortDistanceVectorizer
+{
+public:
+	FTranslucentSortDistanceVectorizer(
+		ETranslucentSortPolicy::Type TranslucentSortPolicy,
+		const FVector& TranslucentSortAxis,
+		const FVector& ViewOrigin,
+		const FMatrix& ViewMatrix)
+		: bSortByDistance(TranslucentSortPolicy == ETranslucentSortPolicy::SortByDistance)
+		, bSortAlongAxis(TranslucentSortPolicy == ETranslucentSortPolicy::SortAlongAxis)
+		, OriginX(VectorSetFloat1(ViewOrigin.X))
+		, OriginY(VectorSetFloat1(ViewOrigin.Y))
+		, OriginZ(VectorSetFloat1(ViewOrigin.Z))
+		// Per axis factors: the sort axis, or the Z column of the view matrix
+		, AxisX(VectorSetFloat1(bSortAlongAxis ? TranslucentSortAxis.X : ViewMatrix.M[0][2]))
+		, AxisY(VectorSetFloat1(bSortAlongAxis ? TranslucentSortAxis.Y : ViewMatrix.M[1][2]))
+		, AxisZ(VectorSetFloat1(bSortAlongAxis ? TranslucentSortAxis.Z : ViewMatrix.M[2][2]))
+		, AxisW(VectorSetFloat1(ViewMatrix.M[3][2]))
+	{
+		check(bSortByDistance || bSortAlongAxis || TranslucentSortPolicy == ETranslucentSortPolicy::SortByProjectedZ);
+	}
+
+	FORCEINLINE void Compute(const FVector& Origin0, const FVector& Origin1, const FVector& Origin2, const FVector& Origin3, float* RESTRICT OutDistances) const
+	{
+		const VectorRegister X = MakeVectorRegister(Origin0.X, Origin1.X, Origin2.X, Origin3.X);
+		const VectorRegister Y = MakeVectorRegister(Origin0.Y, Origin1.Y, Origin2.Y, Origin3.Y);
+		const VectorRegister Z = MakeVectorRegister(Origin0.Z, Origin1.Z, Origin2.Z, Origin3.Z);
+
+		VectorRegister Distances;
+		if (bSortByDistance)
+		{
+			// Squared here, the square root is taken per lane below
+			const VectorRegister DeltaX = VectorSubtract(X, OriginX);
+			const VectorRegister DeltaY = VectorSubtract(Y, OriginY);
+			const VectorRegister DeltaZ = VectorSubtract(Z, OriginZ);
+			Distances = VectorAdd(VectorAdd(VectorMultiply(DeltaX, DeltaX), VectorMultiply(DeltaY, DeltaY)), VectorMultiply(DeltaZ, DeltaZ));
+		}
+		else if (bSortAlongAxis)
+		{
+			const VectorRegister DeltaX = VectorSubtract(X, OriginX);
+			const VectorRegister DeltaY = VectorSubtract(Y, OriginY);
+			const VectorRegister DeltaZ = VectorSubtract(Z, OriginZ);
+			Distances = VectorAdd(VectorAdd(VectorMultiply(DeltaX, AxisX), VectorMultiply(DeltaY, AxisY)), VectorMultiply(DeltaZ, AxisZ));
+		}
+		else
+		{
+			// Same sums as FMatrix::TransformPosition
+			Distances = VectorAdd(VectorAdd(VectorMultiply(X, AxisX), VectorMultiply(Y, AxisY)), VectorAdd(VectorMultiply(Z, AxisZ), AxisW));
+		}
+
+		MS_ALIGN(16) float DistanceArray[4] GCC_ALIGN(16);
+		VectorStoreAligned(Distances, DistanceArray);
+
+		for (int32 Lane = 0; Lane < 4; ++Lane)
+		{
+			OutDistances[Lane] = bSortByDistance ? FMath::Sqrt(DistanceArray[Lane]) : DistanceArray[Lane];
+		}
+	}
+
+private:
+	const bool bSortByDistance;
+	const bool bSortAlongAxis;
+	const VectorRegister OriginX;
+	const VectorRegister OriginY;
+	const VectorRegister OriginZ;
+	const VectorRegister AxisX;
+	const VectorRegister AxisY;
+	const VectorRegister AxisZ;
+	const VectorRegister AxisW;
+};
+
+void ComputeTranslucentSortDistances(
+	ETranslucentSortPolicy::Type TranslucentSortPolicy,
+	const FVector& TranslucentSortAxis,
+	const FVector& ViewOrigin,
+	const FMatrix& ViewMatrix,
+	const TArray<struct FPrimitiveBounds>& PrimitiveBounds,
+	const int32* PrimitiveIndices,
+	int32 NumPrimitives,
+	float* RESTRICT OutPrimitiveSortDistances)
+{
+	const FTranslucentSortDistanceVectorizer Vectorizer(TranslucentSortPolicy, TranslucentSortAxis, ViewOrigin, ViewMatrix);
+
+	int32 Index = 0;
+	for (; Index + 4 <= NumPrimitives; Index += 4)
+	{
+		float Distances[4];
+		Vectorizer.Compute(
+			PrimitiveBounds[PrimitiveIndices[Index + 0]].BoxSphereBounds.Origin,
+			PrimitiveBounds[PrimitiveIndices[Index + 1]].BoxSphereBounds.Origin,
+			PrimitiveBounds[PrimitiveIndices[Index + 2]].BoxSphereBounds.Origin,
+			PrimitiveBounds[PrimitiveIndices[Index + 3]].BoxSphereBounds.Origin,
+			Distances);
+
+		for (int32 Lane = 0; Lane < 4; ++Lane)
+		{
+			OutPrimitiveSortDistances[PrimitiveIndices[Index + Lane]] = Distances[Lane];
+		}
+	}
+
+	for (; Index < NumPrimitives; ++Index)
+	{
+		const int32 PrimitiveIndex = PrimitiveIndices[Index];
+		OutPrimitiveSortDistances[PrimitiveIndex] = GetTranslucentSortDistance(TranslucentSortPolicy, TranslucentSortAxis, ViewOrigin, ViewMatrix, PrimitiveBounds[PrimitiveIndex].BoxSphereBounds.Origin);
+	}
+}
+
+/** The view's per primitive sort distances, empty when they were not computed or not for the view transform the pass sorts with. */
+static TArrayView<const float> GetSharedTranslucentSortDistances(const FViewInfo& View, const FVector& ViewOrigin, const FMatrix& ViewMatrix, const TArray<struct FPrimitiveBounds>& PrimitiveBounds)
+{
+	const bool bValid = View.TranslucentSortDistances.Num() == PrimitiveBounds.Num()
+		&& View.TranslucentSortDistancesViewOrigin == ViewOrigin
+		&& View.TranslucentSortDistancesViewMatrix == ViewMatrix;
+	return bValid ? TArrayView<const float>(View.TranslucentSortDistances) : TArrayView<const float>();
+}
+
 /**
 * Update mesh sort keys with view dependent data.
+* The distances come from PrimitiveSortDistances when given, the view's per primitive distances computed during visibility and
+* shared by all the translucency passes. Otherwise four commands are processed per iteration.
 */
 void UpdateTranslucentMeshSortKeys(
 	ETranslucentSortPolicy::Type TranslucentSortPolicy,
@@ -153,46 +362,627 @@ void UpdateTranslucentMeshSortKeys(
 	const FVector& ViewOrigin,
 	const FMatrix& ViewMatrix,
 	const TArray<struct FPrimitiveBounds>& PrimitiveBounds,
+	TArrayView<const float> PrimitiveSortDistances,
 	ETranslucencyPass::Type TranslucencyPass, 
 	FMeshCommandOneFrameArray& VisibleMeshCommands
 	)
 {
 	QUICK_SCOPE_CYCLE_COUNTER(STAT_UpdateTranslucentMeshSortKeys);
 
-	for (int32 CommandIndex = 0; CommandIndex < VisibleMeshCommands.Num(); ++CommandIndex)
+	const int32 NumCommands = VisibleMeshCommands.Num();
+	FVisibleMeshDrawCommand* RESTRICT Commands = VisibleMeshCommands.GetData();
+	int32 CommandIndex = 0;
+
+	if (PrimitiveSortDistances.Num() > 0)
 	{
-		FVisibleMeshDrawCommand& VisibleCommand = VisibleMeshCommands[CommandIndex];
+		for (; CommandIndex < NumCommands; ++CommandIndex)
+		{
+			const int32 PrimitiveIndex = Commands[CommandIndex].ScenePrimitiveId;
+			// NaN for the primitives the relevance packets didn't find translucent
+			const bool bShared = PrimitiveSortDistances.IsValidIndex(PrimitiveIndex);
+			float Distance = bShared ? PrimitiveSortDistances[PrimitiveIndex] : 0.0f;
+			if (!bShared || FMath::IsNaN(Distance))
+			{
+				Distance = GetTranslucentSortDistance(TranslucentSortPolicy, TranslucentSortAxis, ViewOrigin, ViewMatrix, GetTranslucentSortOrigin(PrimitiveBounds, PrimitiveIndex));
+			}
+			SetTranslucentSortKeyDistance(Commands[CommandIndex].SortKey, Distance);
+		}
+		return;
+	}
 
-		const int32 PrimitiveIndex = VisibleCommand.ScenePrimitiveId;
-		const FVector BoundsOrigin = PrimitiveIndex >= 0 ? PrimitiveBounds[PrimitiveIndex].BoxSphereBounds.Origin : FVector::ZeroVector;
+	const FTranslucentSortDistanceVectorizer Vectorizer(TranslucentSortPolicy, TranslucentSortAxis, ViewOrigin, ViewMatrix);
 
-		float Distance = 0.0f;
-		if (TranslucentSortPolicy == ETranslucentSortPolicy::SortByDistance)
+	for (; CommandIndex + 4 <= NumCommands; CommandIndex += 4)
+	{
+		float Distances[4];
+		Vectorizer.Compute(
+			GetTranslucentSortOrigin(PrimitiveBounds, Commands[CommandIndex + 0].ScenePrimitiveId),
+			GetTranslucentSortOrigin(PrimitiveBounds, Commands[CommandIndex + 1].ScenePrimitiveId),
+			GetTranslucentSortOrigin(PrimitiveBounds, Commands[CommandIndex + 2].ScenePrimitiveId),
+			GetTranslucentSortOrigin(PrimitiveBounds, Commands[CommandIndex + 3].ScenePrimitiveId),
+			Distances);
+
+		for (int32 Lane = 0; Lane < 4; ++Lane)
 		{
-			//sort based on distance to the view position, view rotation is not a factor
-			Distance = (BoundsOrigin - ViewOrigin).Size();
+			SetTranslucentSortKeyDistance(Commands[CommandIndex + Lane].SortKey, Distances[Lane]);
 		}
-		else if (TranslucentSortPolicy == ETranslucentSortPolicy::SortAlongAxis)
+	}
+
+	for (; CommandIndex < NumCommands; ++CommandIndex)
+	{
+		const FVector& BoundsOrigin = GetTranslucentSortOrigin(PrimitiveBounds, Commands[CommandIndex].ScenePrimitiveId);
+		SetTranslucentSortKeyDistance(Commands[CommandIndex].SortKey, GetTranslucentSortDistance(TranslucentSortPolicy, TranslucentSortAxis, ViewOrigin, ViewMatrix, BoundsOrigin));
+	}
+}
+
+/**
+ * Stable LSD radix sort of visible mesh draw commands into the same order as FCompareFMeshDrawCommands: byte digits of the state
+ * bucket first, then of the sort key. Digits shared by every command are skipped, translucent keys mostly differ in their distance bytes.
+ * TempVisibleMeshCommands is scratch memory, it must be empty and presized for VisibleMeshCommands.
+ */
+static void RadixSortMeshDrawCommands(FMeshCommandOneFrameArray& VisibleMeshCommands, FMeshCommandOneFrameArray& TempVisibleMeshCommands)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_RadixSortVisibleMeshDrawCommands);
+
+	const int32 NumCommands = VisibleMeshCommands.Num();
+	check(TempVisibleMeshCommands.Num() == 0 && TempVisibleMeshCommands.Max() >= NumCommands);
+	if (NumCommands < 2)
+	{
+		return;
+	}
+
+	constexpr int32 NumStateBucketDigits = 4;
+	constexpr int32 NumDigits = NumStateBucketDigits + 8;
+
+	// Signed state bucket ids are flipped to order as unsigned
+	auto GetDigit = [](const FVisibleMeshDrawCommand& Command, int32 Digit) -> uint32
+	{
+		return Digit < NumStateBucketDigits
+			? ((uint32(Command.StateBucketId) ^ 0x80000000u) >> (Digit * 8)) & 0xFF
+			: uint32(Command.SortKey.PackedData >> ((Digit - NumStateBucketDigits) * 8)) & 0xFF;
+	};
+
+	uint32 Histograms[NumDigits][256];
+	FMemory::Memzero(Histograms);
+	for (const FVisibleMeshDrawCommand& Command : VisibleMeshCommands)
+	{
+		for (int32 Digit = 0; Digit < NumDigits; ++Digit)
 		{
-			// Sort based on enforced orthogonal distance
-			const FVector CameraToObject = BoundsOrigin - ViewOrigin;
-			Distance = FVector::DotProduct(CameraToObject, TranslucentSortAxis);
+			Histograms[Digit][GetDigit(Command, Digit)]++;
+		}
+	}
+
+	TempVisibleMeshCommands.SetNumUninitialized(NumCommands, false);
+	FVisibleMeshDrawCommand* RESTRICT Src = VisibleMeshCommands.GetData();
+	FVisibleMeshDrawCommand* RESTRICT Dst = TempVisibleMeshCommands.GetData();
+
+	for (int32 Digit = 0; Digit < NumDigits; ++Digit)
+	{
+		uint32* RESTRICT Offsets = Histograms[Digit];
+		if (Offsets[GetDigit(Src[0], Digit)] == (uint32)NumCommands)
+		{
+			continue;
+		}
+
+		uint32 Offset = 0;
+		for (int32 Bucket = 0; Bucket < 256; ++Bucket)
+		{
+			const uint32 Count = Offsets[Bucket];
+			Offsets[Bucket] = Offset;
+			Offset += Count;
+		}
+
+		for (int32 CommandIndex = 0; CommandIndex < NumCommands; ++CommandIndex)
+		{
+			Dst[Offsets[GetDigit(Src[CommandIndex], Digit)]++] = Src[CommandIndex];
+		}
+		Swap(Src, Dst);
+	}
+
+	if (Src != VisibleMeshCommands.GetData())
+	{
+		FMemory::Memcpy(VisibleMeshCommands.GetData(), Src, NumCommands * sizeof(FVisibleMeshDrawCommand));
+	}
+	TempVisibleMeshCommands.Reset();
+}
+
+/** Whether a translucent pass is radix sorted, see r.MeshDrawCommands.TranslucentRadixSortThreshold. */
+static bool ShouldRadixSortMeshDrawCommands(const FMeshCommandOneFrameArray& VisibleMeshCommands, const FMeshCommandOneFrameArray& TempVisibleMeshCommands)
+{
+	const int32 Threshold = CVarMeshDrawCommandsTranslucentRadixSortThreshold.GetValueOnAnyThread();
+	return Threshold > 0
+		&& VisibleMeshCommands.Num() >= Threshold
+		// The scratch array can't grow on a task thread, it is presized for the pass's MaxNumDraws
+		&& TempVisibleMeshCommands.Num() == 0
+		&& TempVisibleMeshCommands.Max() >= VisibleMeshCommands.Num();
+}
+
+/** Per view state and pass draw order of the previous frame, seeds the translucent sort of the next one. */
+class FTranslucentSortHistory
+{
+public:
+	/** Position of the first command of a primitive in the sorted commands of a frame. */
+	struct FPrimitiveRank
+	{
+		/** The frame this rank seeds, the one after it was recorded. */
+		uint32 NextFrameNumber;
+		int32 Rank;
+	};
+
+	struct FPassHistory
+	{
+		/**
+		 * Indexed by the dense FVisibleMeshDrawCommand::ScenePrimitiveId and only written for the primitives drawn, so neither rebuilt nor hashed
+		 * every frame. Keyed by primitive as the sort keys don't tell commands apart, the additive off-screen particles all have MeshIdInPrimitive 0.
+		 */
+		TArray<FPrimitiveRank> PrimitiveRanks;
+		/** Number of commands sorted by the previous frame, 0 when it can't seed this one. */
+		int32 NumPreviousCommands = 0;
+		/** Scratch of the seeding, kept to reuse the allocations. */
+		TArray<int32> CommandRanks;
+		TArray<int32> RankOffsets;
+		uint32 FrameNumber = 0;
+	};
+
+	/** Returns the history of the view's pass, nullptr for views without persistent state or when the pass was already sorted this frame. */
+	FPassHistory* Acquire(const FViewInfo& View, EMeshPass::Type PassType)
+	{
+		if (!View.ViewState)
+		{
+			return nullptr;
+		}
+
+		const uint32 FrameNumber = View.Family->FrameNumber;
+		const uint64 Key = (uint64(View.ViewState->GetViewKey()) << 32) | uint32(PassType);
+
+		FScopeLock Lock(&CriticalSection);
+		RemoveStale(FrameNumber);
+
+		TUniquePtr<FPassHistory>& PassHistory = PassHistories.FindOrAdd(Key);
+		if (!PassHistory.IsValid())
+		{
+			PassHistory = MakeUnique<FPassHistory>();
+		}
+		else if (PassHistory->FrameNumber == FrameNumber)
+		{
+			return nullptr;
+		}
+		else if (PassHistory->FrameNumber + 1 != FrameNumber)
+		{
+			PassHistory->NumPreviousCommands = 0;
+		}
+		PassHistory->FrameNumber = FrameNumber;
+		return PassHistory.Get();
+	}
+
+private:
+	/** Drops the histories of view states which have not been rendered for a while. */
+	void RemoveStale(uint32 FrameNumber)
+	{
+		const uint32 MaxUnusedFrames = 120;
+		for (auto It = PassHistories.CreateIterator(); It; ++It)
+		{
+			if (FrameNumber - It.Value()->FrameNumber > MaxUnusedFrames)
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+
+	FCriticalSection CriticalSection;
+	TMap<uint64, TUniquePtr<FPassHistory>> PassHistories;
+};
+
+static FTranslucentSortHistory GTranslucentSortHistory;
+
+/** The previous frame's order says little about this one after a cut or a large camera move. */
+static bool HasLargeTranslucentSortViewChange(const FViewInfo& View)
+{
+	const float CameraRotationThreshold = 30.0f;
+	const float CameraTranslationThreshold = 1000.0f;
+	return View.bCameraCut
+		|| View.bPrevTransformsReset
+		|| IsLargeCameraMovement(View, View.PrevViewInfo.ViewMatrices.GetViewMatrix(), View.PrevViewInfo.ViewMatrices.GetViewOrigin(), CameraRotationThreshold, CameraTranslationThreshold);
+}
+
+/**
+ * Sorts translucent commands into the order of FCompareFMeshDrawCommands by placing them at the rank of their primitive in the previous frame,
+ * new commands last, and finishing with an insertion sort which is near linear on the almost sorted result. The commands of a primitive are
+ * placed together in their generation order, the insertion sort orders them among themselves.
+ * Returns false when the order changed too much, the commands are then a permutation of their input which still needs a full sort.
+ */
+static bool IncrementalSortTranslucentMeshDrawCommands(
+	FTranslucentSortHistory::FPassHistory& History,
+	float MaxMovesPerCommand,
+	FMeshCommandOneFrameArray& VisibleMeshCommands,
+	FMeshCommandOneFrameArray& TempVisibleMeshCommands)
+{
+	const int32 NumCommands = VisibleMeshCommands.Num();
+	const int32 NumRanks = History.NumPreviousCommands;
+	if (NumRanks == 0 || TempVisibleMeshCommands.Num() != 0 || TempVisibleMeshCommands.Max() < NumCommands)
+	{
+		return false;
+	}
+
+	// Counting sort on the previous ranks, rank NumRanks holding the new commands
+	History.CommandRanks.SetNumUninitialized(NumCommands, false);
+	History.RankOffsets.Reset();
+	History.RankOffsets.SetNumZeroed(NumRanks + 2, false);
+
+	for (int32 CommandIndex = 0; CommandIndex < NumCommands; ++CommandIndex)
+	{
+		const int32 PrimitiveId = VisibleMeshCommands[CommandIndex].ScenePrimitiveId;
+		int32 Rank = NumRanks;
+		if (PrimitiveId >= 0 && PrimitiveId < History.PrimitiveRanks.Num() && History.PrimitiveRanks[PrimitiveId].NextFrameNumber == History.FrameNumber)
+		{
+			Rank = History.PrimitiveRanks[PrimitiveId].Rank;
+		}
+		History.CommandRanks[CommandIndex] = Rank;
+		History.RankOffsets[Rank + 1]++;
+	}
+
+	for (int32 Rank = 1; Rank < History.RankOffsets.Num(); ++Rank)
+	{
+		History.RankOffsets[Rank] += History.RankOffsets[Rank - 1];
+	}
+
+	// TempVisibleMeshCommands is presized, this never reallocates
+	TempVisibleMeshCommands.AddUninitialized(NumCommands);
+	for (int32 CommandIndex = 0; CommandIndex < NumCommands; ++CommandIndex)
+	{
+		TempVisibleMeshCommands[History.RankOffsets[History.CommandRanks[CommandIndex]]++] = VisibleMeshCommands[CommandIndex];
+	}
+	FMemory::Memswap(&VisibleMeshCommands, &TempVisibleMeshCommands, sizeof(TempVisibleMeshCommands));
+	TempVisibleMeshCommands.Reset();
+
+	const int64 MaxMoves = int64(MaxMovesPerCommand * NumCommands);
+	int64 NumMoves = 0;
+	const FCompareFMeshDrawCommands Less;
+	FVisibleMeshDrawCommand* RESTRICT Commands = VisibleMeshCommands.GetData();
+
+	for (int32 CommandIndex = 1; CommandIndex < NumCommands; ++CommandIndex)
+	{
+		if (!Less(Commands[CommandIndex], Commands[CommandIndex - 1]))
+		{
+			continue;
+		}
+
+		const FVisibleMeshDrawCommand Command = Commands[CommandIndex];
+		int32 InsertIndex = CommandIndex;
+		do
+		{
+			Commands[InsertIndex] = Commands[InsertIndex - 1];
+			--InsertIndex;
+		}
+		while (InsertIndex > 0 && Less(Command, Commands[InsertIndex - 1]));
+		Commands[InsertIndex] = Command;
+
+		NumMoves += CommandIndex - InsertIndex;
+		if (NumMoves > MaxMoves)
+		{
+			INC_DWORD_STAT(STAT_TranslucentMeshDrawCommandsIncrementalSortFallbacks);
+			return false;
+		}
+	}
+
+	INC_DWORD_STAT(STAT_TranslucentMeshDrawCommandsIncrementalSorts);
+	INC_DWORD_STAT_BY(STAT_TranslucentMeshDrawCommandsIncrementalSortMoves, NumMoves);
+	return true;
+}
+
+/** Sorts the commands of a translucent pass, incrementally from the previous frame's order when possible. */
+static void SortTranslucentMeshDrawCommands(
+	const FViewInfo& View,
+	EMeshPass::Type PassType,
+	FMeshCommandOneFrameArray& VisibleMeshCommands,
+	FMeshCommandOneFrameArray& TempVisibleMeshCommands)
+{
+	const float MaxMovesPerCommand = CVarMeshDrawCommandsTranslucentIncrementalSort.GetValueOnAnyThread();
+	FTranslucentSortHistory::FPassHistory* History = MaxMovesPerCommand > 0.0f ? GTranslucentSortHistory.Acquire(View, PassType) : nullptr;
+
+	bool bSorted = false;
+	if (History && !HasLargeTranslucentSortViewChange(View))
+	{
+		SCOPE_CYCLE_COUNTER(STAT_TranslucentMeshDrawCommandsIncrementalSort);
+		bSorted = IncrementalSortTranslucentMeshDrawCommands(*History, MaxMovesPerCommand, VisibleMeshCommands, TempVisibleMeshCommands);
+	}
+
+	if (!bSorted)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_TranslucentMeshDrawCommandsFullSort);
+		if (ShouldRadixSortMeshDrawCommands(VisibleMeshCommands, TempVisibleMeshCommands))
+		{
+			RadixSortMeshDrawCommands(VisibleMeshCommands, TempVisibleMeshCommands);
 		}
 		else
 		{
-			// Sort based on projected Z distance
-			check(TranslucentSortPolicy == ETranslucentSortPolicy::SortByProjectedZ);
-			Distance = ViewMatrix.TransformPosition(BoundsOrigin).Z;
+			QUICK_SCOPE_CYCLE_COUNTER(STAT_SortVisibleMeshDrawCommands);
+			VisibleMeshCommands.Sort(FCompareFMeshDrawCommands());
 		}
+	}
+
+	if (History)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_TranslucentMeshDrawCommandsIncrementalSort);
+		const uint32 NextFrameNumber = History->FrameNumber + 1;
+		for (int32 CommandIndex = 0; CommandIndex < VisibleMeshCommands.Num(); ++CommandIndex)
+		{
+			const int32 PrimitiveId = VisibleMeshCommands[CommandIndex].ScenePrimitiveId;
+			if (PrimitiveId < 0)
+			{
+				continue;
+			}
+
+			if (PrimitiveId >= History->PrimitiveRanks.Num())
+			{
+				History->PrimitiveRanks.SetNumZeroed(PrimitiveId + 1, false);
+			}
 
-		// Patch distance inside translucent mesh sort key.
-		FMeshDrawCommandSortKey SortKey;
-		SortKey.PackedData = VisibleCommand.SortKey.PackedData;
-		SortKey.Translucent.Distance = (uint32)~BitInvertIfNegativeFloat(*((uint32*)&Distance));
-		VisibleCommand.SortKey.PackedData = SortKey.PackedData;
+			FTranslucentSortHistory::FPrimitiveRank& PrimitiveRank = History->PrimitiveRanks[PrimitiveId];
+			if (PrimitiveRank.NextFrameNumber != NextFrameNumber)
+			{
+				PrimitiveRank.NextFrameNumber = NextFrameNumber;
+				PrimitiveRank.Rank = CommandIndex;
+			}
+		}
+		History->NumPreviousCommands = VisibleMeshCommands.Num();
 	}
 }
 
+#if !UE_BUILD_SHIPPING
+/** Times the scalar and vectorized sort key updates, and the comparison and radix sorts, on synthetic translucent commands. */
+static void BenchmarkTranslucentMeshDrawCommandSort(const TArray<FString>& Args)
+{
+	const int32 NumCommands = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 5000;
+	const int32 NumIterations = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 20;
+
+	FMemMark Mark(FMemStack::Get());
+	FRandomStream RandomStream(0x7A5F);
+
+	TArray<FPrimitiveBounds> PrimitiveBounds;
+	PrimitiveBounds.SetNumZeroed(NumCommands);
+	for (FPrimitiveBounds& Bounds : PrimitiveBounds)
+	{
+		Bounds.BoxSphereBounds.Origin = RandomStream.GetUnitVector() * RandomStream.FRandRange(10.0f, 50000.0f);
+	}
+
+	// A few materials and meshes per primitive, as particle emitters produce
+	FMeshCommandOneFrameArray SourceCommands;
+	SourceCommands.Reserve(NumCommands);
+	for (int32 CommandIndex = 0; CommandIndex < NumCommands; ++CommandIndex)
+	{
+		FMeshDrawCommandSortKey SortKey = FMeshDrawCommandSortKey::Default;
+		SortKey.Translucent.MeshIdInPrimitive = RandomStream.RandHelper(4);
+		SortKey.Translucent.Priority = RandomStream.RandHelper(3);
+		FVisibleMeshDrawCommand& Command = SourceCommands.AddDefaulted_GetRef();
+		Command.Setup(nullptr, CommandIndex, CommandIndex, RandomStream.RandHelper(64) - 1, ERasterizerFillMode::FM_Solid, ERasterizerCullMode::CM_None, SortKey);
+	}
+
+	FMeshCommandOneFrameArray Commands;
+	FMeshCommandOneFrameArray ReferenceCommands;
+	FMeshCommandOneFrameArray TempCommands;
+	Commands.Reserve(NumCommands);
+	ReferenceCommands.Reserve(NumCommands);
+	TempCommands.Reserve(NumCommands);
+
+	const FVector ViewOrigin(120.0f, -340.0f, 180.0f);
+	const FMatrix ViewMatrix = FLookAtMatrix(ViewOrigin, FVector::ZeroVector, FVector::UpVector);
+	const FVector SortAxis(0.0f, 0.0f, 1.0f);
+
+	const ETranslucentSortPolicy::Type SortPolicies[] = { ETranslucentSortPolicy::SortByDistance, ETranslucentSortPolicy::SortByProjectedZ, ETranslucentSortPolicy::SortAlongAxis };
+	const TCHAR* SortPolicyNames[] = { TEXT("SortByDistance"), TEXT("SortByProjectedZ"), TEXT("SortAlongAxis") };
+
+	UE_LOG(LogRenderer, Display, TEXT("Translucent mesh draw command sort, %d commands, %d iterations, milliseconds per iteration:"), NumCommands, NumIterations);
+
+	for (int32 PolicyIndex = 0; PolicyIndex < UE_ARRAY_COUNT(SortPolicies); ++PolicyIndex)
+	{
+		const ETranslucentSortPolicy::Type SortPolicy = SortPolicies[PolicyIndex];
+		double ScalarKeySeconds = 0.0;
+		double VectorKeySeconds = 0.0;
+		double ComparisonSortSeconds = 0.0;
+		double RadixSortSeconds = 0.0;
+		bool bMatch = true;
+
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			ReferenceCommands = SourceCommands;
+			double StartTime = FPlatformTime::Seconds();
+			UpdateTranslucentMeshSortKeysScalar(SortPolicy, SortAxis, ViewOrigin, ViewMatrix, PrimitiveBounds, ReferenceCommands);
+			ScalarKeySeconds += FPlatformTime::Seconds() - StartTime;
+
+			Commands = SourceCommands;
+			StartTime = FPlatformTime::Seconds();
+			UpdateTranslucentMeshSortKeys(SortPolicy, SortAxis, ViewOrigin, ViewMatrix, PrimitiveBounds, TArrayView<const float>(), ETranslucencyPass::TPT_AllTranslucency, Commands);
+			VectorKeySeconds += FPlatformTime::Seconds() - StartTime;
+
+			StartTime = FPlatformTime::Seconds();
+			ReferenceCommands.Sort(FCompareFMeshDrawCommands());
+			ComparisonSortSeconds += FPlatformTime::Seconds() - StartTime;
+
+			StartTime = FPlatformTime::Seconds();
+			RadixSortMeshDrawCommands(Commands, TempCommands);
+			RadixSortSeconds += FPlatformTime::Seconds() - StartTime;
+
+			// Equal keys may be ordered differently by the unstable comparison sort, only the key sequences have to match
+			for (int32 CommandIndex = 0; CommandIndex < NumCommands && bMatch; ++CommandIndex)
+			{
+				bMatch = !(Commands[CommandIndex].SortKey != ReferenceCommands[CommandIndex].SortKey)
+					&& Commands[CommandIndex].StateBucketId == ReferenceCommands[CommandIndex].StateBucketId;
+			}
+		}
+
+		const double MillisecondsPerIteration = 1000.0 / NumIterations;
+		UE_LOG(LogRenderer, Display, TEXT("  %-16s keys scalar %.3f vector %.3f, sort comparison %.3f radix %.3f%s"),
+			SortPolicyNames[PolicyIndex],
+			ScalarKeySeconds * MillisecondsPerIteration,
+			VectorKeySeconds * MillisecondsPerIteration,
+			ComparisonSortSeconds * MillisecondsPerIteration,
+			RadixSortSeconds * MillisecondsPerIteration,
+			bMatch ? TEXT("") : TEXT(", MISMATCH"));
+	}
+}
+
+static FAutoConsoleCommand GBenchmarkTranslucentMeshDrawCommandSortCmd(
+	TEXT("r.MeshDrawCommands.BenchmarkTranslucentSort"),
+	TEXT("Compares the scalar and vectorized translucent sort key updates, and the comparison and radix sorts, on synthetic mesh draw commands.\n")
+	TEXT("Arguments: [NumCommands=5000] [Iterations=20]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkTranslucentMeshDrawCommandSort));
+
+/** Times per pass sort distances against distances computed once per primitive and shared by the passes, as r.SharedTranslucentSortDistances does. */
+static void BenchmarkSharedTranslucentSortDistances(const TArray<FString>& Args)
+{
+	const int32 NumPrimitives = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 100000;
+	const int32 NumPasses = Args.Num() > 1 ? FMath::Clamp(FCString::Atoi(*Args[1]), 1, 8) : 3;
+	const int32 NumIterations = 10;
+
+	FMemMark Mark(FMemStack::Get());
+	FRandomStream RandomStream(0x5D15);
+
+	TArray<FPrimitiveBounds> PrimitiveBounds;
+	PrimitiveBounds.SetNumZeroed(NumPrimitives);
+	TArray<int32> PrimitiveIndices;
+	PrimitiveIndices.SetNumUninitialized(NumPrimitives);
+	for (int32 PrimitiveIndex = 0; PrimitiveIndex < NumPrimitives; ++PrimitiveIndex)
+	{
+		PrimitiveBounds[PrimitiveIndex].BoxSphereBounds.Origin = RandomStream.GetUnitVector() * RandomStream.FRandRange(10.0f, 50000.0f);
+		PrimitiveIndices[PrimitiveIndex] = PrimitiveIndex;
+	}
+
+	// Every primitive draws one mesh in each pass, as emitters mixing standard, off-screen and after DOF materials would
+	FMeshCommandOneFrameArray PassCommands[8];
+	for (int32 PassIndex = 0; PassIndex < NumPasses; ++PassIndex)
+	{
+		PassCommands[PassIndex].Reserve(NumPrimitives);
+		for (int32 PrimitiveIndex = 0; PrimitiveIndex < NumPrimitives; ++PrimitiveIndex)
+		{
+			PassCommands[PassIndex].AddDefaulted_GetRef().Setup(nullptr, PrimitiveIndex, PrimitiveIndex, -1, ERasterizerFillMode::FM_Solid, ERasterizerCullMode::CM_None, FMeshDrawCommandSortKey::Default);
+		}
+	}
+
+	const FVector ViewOrigin(120.0f, -340.0f, 180.0f);
+	const FMatrix ViewMatrix = FLookAtMatrix(ViewOrigin, FVector::ZeroVector, FVector::UpVector);
+	const ETranslucentSortPolicy::Type SortPolicy = ETranslucentSortPolicy::SortByDistance;
+
+	TArray<float> SharedDistances;
+	SharedDistances.SetNumUninitialized(NumPrimitives);
+	TArray<uint64> ReferenceKeys;
+	ReferenceKeys.SetNumUninitialized(NumPrimitives);
+
+	double PerPassSeconds = 0.0;
+	double SharedComputeSeconds = 0.0;
+	double SharedPassSeconds = 0.0;
+	bool bMatch = true;
+
+	for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+	{
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 PassIndex = 0; PassIndex < NumPasses; ++PassIndex)
+		{
+			UpdateTranslucentMeshSortKeys(SortPolicy, FVector::ZeroVector, ViewOrigin, ViewMatrix, PrimitiveBounds, TArrayView<const float>(), ETranslucencyPass::TPT_AllTranslucency, PassCommands[PassIndex]);
+		}
+		PerPassSeconds += FPlatformTime::Seconds() - StartTime;
+
+		for (int32 PrimitiveIndex = 0; PrimitiveIndex < NumPrimitives; ++PrimitiveIndex)
+		{
+			ReferenceKeys[PrimitiveIndex] = PassCommands[NumPasses - 1][PrimitiveIndex].SortKey.PackedData;
+		}
+
+		StartTime = FPlatformTime::Seconds();
+		ComputeTranslucentSortDistances(SortPolicy, FVector::ZeroVector, ViewOrigin, ViewMatrix, PrimitiveBounds, PrimitiveIndices.GetData(), NumPrimitives, SharedDistances.GetData());
+		SharedComputeSeconds += FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		for (int32 PassIndex = 0; PassIndex < NumPasses; ++PassIndex)
+		{
+			UpdateTranslucentMeshSortKeys(SortPolicy, FVector::ZeroVector, ViewOrigin, ViewMatrix, PrimitiveBounds, SharedDistances, ETranslucencyPass::TPT_AllTranslucency, PassCommands[PassIndex]);
+		}
+		SharedPassSeconds += FPlatformTime::Seconds() - StartTime;
+
+		for (int32 PrimitiveIndex = 0; PrimitiveIndex < NumPrimitives && bMatch; ++PrimitiveIndex)
+		{
+			bMatch = ReferenceKeys[PrimitiveIndex] == PassCommands[NumPasses - 1][PrimitiveIndex].SortKey.PackedData;
+		}
+	}
+
+	const double MillisecondsPerIteration = 1000.0 / NumIterations;
+	UE_LOG(LogRenderer, Display, TEXT("Translucent sort distances, %d primitives in %d passes, milliseconds per frame: per pass %.3f, shared %.3f (compute %.3f + passes %.3f)%s"),
+		NumPrimitives,
+		NumPasses,
+		PerPassSeconds * MillisecondsPerIteration,
+		(SharedComputeSeconds + SharedPassSeconds) * MillisecondsPerIteration,
+		SharedComputeSeconds * MillisecondsPerIteration,
+		SharedPassSeconds * MillisecondsPerIteration,
+		bMatch ? TEXT("") : TEXT(", MISMATCH"));
+}
+
+static FAutoConsoleCommand GBenchmarkSharedTranslucentSortDistancesCmd(
+	TEXT("r.MeshDrawCommands.BenchmarkSharedTranslucentSortDistances"),
+	TEXT("Compares translucent sort distances computed by every pass with distances computed once per primitive and shared by the passes.\n")
+	TEXT("Arguments: [NumPrimitives=100000] [NumPasses=3]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkSharedTranslucentSortDistances));
+#endif // !UE_BUILD_SHIPPING
+
+/** Number of pipeline state changes when drawing the commands in order. */
+static int32 CountPipelineSwitches(const FMeshCommandOneFrameArray& VisibleMeshCommands)
+{
+	int32 NumSwitches = 0;
+	for (int32 CommandIndex = 1; CommandIndex < VisibleMeshCommands.Num(); ++CommandIndex)
+	{
+		NumSwitches += VisibleMeshCommands[CommandIndex].MeshDrawCommand->CachedPipelineId.GetId() != VisibleMeshCommands[CommandIndex - 1].MeshDrawCommand->CachedPipelineId.GetId() ? 1 : 0;
+	}
+	return NumSwitches;
+}
+
+/**
+ * Replaces the distance of the additive mobile off-screen particles, tagged with MobileOrderFreeTranslucencySortPriority, by their pipeline state.
+ * The sort then groups them by pipeline state and state bucket, which lets them be dynamically instanced, ahead of the distance sorted draws.
+ * Must run after UpdateTranslucentMeshSortKeys, the distances it wrote are used to count the pipeline switches saved.
+ */
+static void UpdateMobileOrderFreeTranslucentMeshSortKeys(FMeshCommandOneFrameArray& VisibleMeshCommands)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_UpdateMobileOrderFreeTranslucentMeshSortKeys);
+
+	int32 NumOrderFreeCommands = 0;
+#if STATS
+	struct FDistanceSortedCommand
+	{
+		uint64 SortKey;
+		uint32 PipelineId;
+	};
+	TArray<FDistanceSortedCommand, TInlineAllocator<64>> DistanceSortedCommands;
+#endif
+
+	for (FVisibleMeshDrawCommand& VisibleCommand : VisibleMeshCommands)
+	{
+		if (VisibleCommand.SortKey.Translucent.Priority != MobileOrderFreeTranslucencySortPriority)
+		{
+			continue;
+		}
+
+		const uint32 PipelineId = VisibleCommand.MeshDrawCommand->CachedPipelineId.GetId();
+#if STATS
+		DistanceSortedCommands.Add({ VisibleCommand.SortKey.PackedData, PipelineId });
+#endif
+		VisibleCommand.SortKey.Translucent.Distance = PipelineId;
+		VisibleCommand.SortKey.Translucent.MeshIdInPrimitive = 0;
+		NumOrderFreeCommands++;
+	}
+
+#if STATS
+	DistanceSortedCommands.Sort([](const FDistanceSortedCommand& A, const FDistanceSortedCommand& B) { return A.SortKey < B.SortKey; });
+	int32 NumDistanceSortedSwitches = 0;
+	TSet<uint32, DefaultKeyFuncs<uint32>, TInlineSetAllocator<16>> Pipelines;
+	for (int32 CommandIndex = 0; CommandIndex < DistanceSortedCommands.Num(); ++CommandIndex)
+	{
+		NumDistanceSortedSwitches += CommandIndex > 0 && DistanceSortedCommands[CommandIndex].PipelineId != DistanceSortedCommands[CommandIndex - 1].PipelineId ? 1 : 0;
+		Pipelines.Add(DistanceSortedCommands[CommandIndex].PipelineId);
+	}
+	// Grouped, the sub-bucket only switches once per distinct pipeline state
+	INC_DWORD_STAT_BY(STAT_MobileDownsampleTranslucencyPipelineSwitchesSaved, NumDistanceSortedSwitches - FMath::Max(Pipelines.Num() - 1, 0));
+#endif
+	INC_DWORD_STAT_BY(STAT_MobileDownsampleTranslucencyOrderFreeDraws, NumOrderFreeCommands);
+}
+
 static uint64 GetMobileBasePassSortKey_FrontToBack(bool bMasked, bool bBackground, uint32 PipelineId, int32 StateBucketId, float PrimitiveDistance)
 {
 	union
@@ -859,11 +1649,22 @@ public:
 					Context.ViewOrigin,
 					Context.ViewMatrix,
 					*Context.PrimitiveBounds,
+					GetSharedTranslucentSortDistances(*Context.View, Context.ViewOrigin, Context.ViewMatrix, *Context.PrimitiveBounds),
 					Context.TranslucencyPass,
 					Context.MeshDrawCommands
 				);
+
+				if (IsMobileDownsampleTranslucencyPass(Context.TranslucencyPass))
+				{
+					UpdateMobileOrderFreeTranslucentMeshSortKeys(Context.MeshDrawCommands);
+				}
 			}
 
+			if (Context.TranslucencyPass != ETranslucencyPass::TPT_MAX)
+			{
+				SortTranslucentMeshDrawCommands(*Context.View, Context.PassType, Context.MeshDrawCommands, Context.TempVisibleMeshDrawCommands);
+			}
+			else
 			{
 				QUICK_SCOPE_CYCLE_COUNTER(STAT_SortVisibleMeshDrawCommands);
 				Context.MeshDrawCommands.Sort(FCompareFMeshDrawCommands());
@@ -885,6 +1686,15 @@ public:
 					Context.InstanceFactor
 				);
 			}
+
+			if (IsMobileDownsampleTranslucencyPass(Context.TranslucencyPass))
+			{
+				INC_DWORD_STAT_BY(STAT_MobileDownsampleTranslucencyPipelineSwitches, CountPipelineSwitches(Context.MeshDrawCommands));
+				if (Context.bUseGPUScene && Context.bDynamicInstancing)
+				{
+					INC_DWORD_STAT_BY(STAT_MobileDownsampleTranslucencyInstancedDrawsSaved, Context.VisibleMeshDrawCommandsNum - Context.NewPassVisibleMeshDrawCommandsNum);
+				}
+			}
 		}
 	}
 
@@ -1060,6 +1870,9 @@ void FParallelMeshDrawCommandPass::DispatchPassSetup(
 		//YJH Created By 2020-7-25
 		case EMeshPass::TranslucencyDownSampleSeparate: TaskContext.TranslucencyPass = ETranslucencyPass::TPT_TranslucencyDownSampleSeparate; break;
 		//End
+		case EMeshPass::TranslucencyDownSampleSeparateFull: TaskContext.TranslucencyPass = ETranslucencyPass::TPT_TranslucencyDownSampleSeparateFull; break;
+		case EMeshPass::TranslucencyDownSampleSeparateHalf: TaskContext.TranslucencyPass = ETranslucencyPass::TPT_TranslucencyDownSampleSeparateHalf; break;
+		case EMeshPass::TranslucencyDownSampleSeparateQuarter: TaskContext.TranslucencyPass = ETranslucencyPass::TPT_TranslucencyDownSampleSeparateQuarter; break;
 		case EMeshPass::TranslucencyAfterDOF: TaskContext.TranslucencyPass = ETranslucencyPass::TPT_TranslucencyAfterDOF; break;
 		case EMeshPass::TranslucencyAfterDOFModulate: TaskContext.TranslucencyPass = ETranslucencyPass::TPT_TranslucencyAfterDOFModulate; break;
 		case EMeshPass::TranslucencyAll: TaskContext.TranslucencyPass = ETranslucencyPass::TPT_AllTranslucency; break;
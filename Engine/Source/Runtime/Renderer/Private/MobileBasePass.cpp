@@ -12,6 +12,36 @@
 #include "MaterialShaderQualitySettings.h"
 #include "PrimitiveSceneInfo.h"
 #include "MeshPassProcessor.inl"
+#include "RendererModule.h"
+#include "ComponentRecreateRenderStateContext.h"
+
+static TAutoConsoleVariable<int32> CVarMobileSeparateTranslucencyAdditiveOrderFree(
+	TEXT("r.Mobile.SeparateTranslucencyAdditiveOrderFree"),
+	1,
+	TEXT("Whether the additive mobile off-screen particles skip the distance sort. They are drawn first, sorted by pipeline state and\n")
+	TEXT("dynamically instanced, then the alpha blended ones are drawn back to front over them.\n")
+	TEXT(" 0 = Off, additive and alpha blended particles are sorted together by distance\n")
+	TEXT(" 1 = On [default]"),
+	FConsoleVariableDelegate::CreateLambda([](IConsoleVariable*)
+	{
+		// Baked into the sort keys of the cached mesh draw commands
+		FGlobalComponentRecreateRenderStateContext Context;
+	}),
+	ECVF_Scalability | ECVF_RenderThreadSafe);
+
+/**
+ * Counted in AddMeshBatch, so when the mesh draw commands are built: once when the cached commands of static meshes are (re)created,
+ * every frame for dynamic meshes. Not a per frame count of the static mesh batches drawn.
+ */
+DECLARE_DWORD_COUNTER_STAT(TEXT("Mobile Off-Screen Particle Mesh Batches Built"), STAT_MobileDownsampleTranslucencyMeshBatchesBuilt, STATGROUP_SceneRendering);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Mobile Translucent Mesh Batches Built For Another Pass"), STAT_MobileTranslucencyMeshBatchesBuiltRoutedAway, STATGROUP_SceneRendering);
+
+/** Whether a mobile translucency pass draws the mesh batches of a material, see GetMobileTranslucencyPass. */
+static bool ShouldDrawInMobileTranslucencyPass(ETranslucencyPass::Type TranslucencyPassType, bool bMobileSeparateTranslucency, EMobileDownsampleTranslucencyResolution DownsampleResolution)
+{
+	return TranslucencyPassType == ETranslucencyPass::TPT_AllTranslucency
+		|| TranslucencyPassType == GetMobileTranslucencyPass(bMobileSeparateTranslucency, DownsampleResolution);
+}
 
 template <ELightMapPolicyType Policy, int32 NumMovablePointLights>
 void GetUniformMobileBasePassShaders(
@@ -606,11 +636,19 @@ void FMobileBasePassMeshProcessor::AddMeshBatch(const FMeshBatch& RESTRICT MeshB
 	if (bTranslucentBasePass)
 	{
 		// Skipping TPT_TranslucencyAfterDOFModulate. That pass is only needed for Dual Blending, which is not supported on Mobile.
-		bool bShouldDraw = (bIsTranslucent || bUsesWaterMaterial) &&
-		(TranslucencyPassType == ETranslucencyPass::TPT_AllTranslucency
-		|| (TranslucencyPassType == ETranslucencyPass::TPT_StandardTranslucency && !Material.IsMobileSeparateTranslucencyEnabled())
-		|| (TranslucencyPassType == ETranslucencyPass::TPT_TranslucencyDownSampleSeparate)
-		|| (TranslucencyPassType == ETranslucencyPass::TPT_TranslucencyAfterDOF && Material.IsMobileSeparateTranslucencyEnabled()));
+		// The primitive may be relevant to several passes through its other materials, the batch is only drawn by the one of its own.
+		const EMobileDownsampleTranslucencyResolution DownsampleResolution = Material.GetMobileDownsampleTranslucencyResolution();
+		bool bShouldDraw = (bIsTranslucent || bUsesWaterMaterial)
+			&& ShouldDrawInMobileTranslucencyPass(TranslucencyPassType, Material.IsMobileSeparateTranslucencyEnabled(), DownsampleResolution);
+
+		if (!bShouldDraw && (bIsTranslucent || bUsesWaterMaterial))
+		{
+			INC_DWORD_STAT(STAT_MobileTranslucencyMeshBatchesBuiltRoutedAway);
+		}
+		else if (bShouldDraw && TranslucencyPassType != ETranslucencyPass::TPT_AllTranslucency && DownsampleResolution != EMobileDownsampleTranslucencyResolution::Disabled)
+		{
+			INC_DWORD_STAT(STAT_MobileDownsampleTranslucencyMeshBatchesBuilt);
+		}
 
 		if (bShouldDraw)
 		{
@@ -684,8 +722,16 @@ void FMobileBasePassMeshProcessor::Process(
 	if (bTranslucentBasePass)
 	{
 		SortKey = CalculateTranslucentMeshStaticSortKey(PrimitiveSceneProxy, MeshBatch.MeshIdInPrimitive);
-		// We always want water to be rendered first on mobile in order to mimic other renderers where it is opaque. We shift the other priorities by 1.
-		SortKey.Translucent.Priority = ShadingModels.HasShadingModel(MSM_SingleLayerWater) ? uint16(0) : uint16(FMath::Clamp(uint32(SortKey.Translucent.Priority) + 1, 0u, uint32(USHRT_MAX)));
+		if (BlendMode == BLEND_Additive && IsMobileDownsampleTranslucencyPass(TranslucencyPassType) && CVarMobileSeparateTranslucencyAdditiveOrderFree.GetValueOnAnyThread() != 0)
+		{
+			// Additive blending commutes, these draws are sorted by state instead of distance, see UpdateMobileOrderFreeTranslucentMeshSortKeys
+			SortKey.Translucent.Priority = MobileOrderFreeTranslucencySortPriority;
+		}
+		else
+		{
+			// We always want water to be rendered first on mobile in order to mimic other renderers where it is opaque. We shift the other priorities by 1.
+			SortKey.Translucent.Priority = ShadingModels.HasShadingModel(MSM_SingleLayerWater) ? uint16(0) : uint16(FMath::Clamp(uint32(SortKey.Translucent.Priority) + 1, 0u, uint32(USHRT_MAX)));
+		}
 	}
 	else
 	{
@@ -757,16 +803,19 @@ FMeshPassProcessor* CreateMobileTranslucencyStandardPassProcessor(const FScene*
 	return new(FMemStack::Get()) FMobileBasePassMeshProcessor(Scene, Scene->GetFeatureLevel(), InViewIfDynamicMeshCommand, PassDrawRenderState, InDrawListContext, Flags, ETranslucencyPass::TPT_StandardTranslucency);
 }
 
+template<ETranslucencyPass::Type TranslucencyPassType>
 FMeshPassProcessor* CreateMobileTranslucencyDownSampleSeparatePassProcessor(const FScene* Scene, const FSceneView* InViewIfDynamicMeshCommand, FMeshPassDrawListContext* InDrawListContext)
 {
-	FMeshPassProcessorRenderState PassDrawRenderState(Scene->UniformBuffers.ViewUniformBuffer, Scene->UniformBuffers.MobileTranslucentBasePassUniformBuffer);
-	PassDrawRenderState.SetInstancedViewUniformBuffer(Scene->UniformBuffers.InstancedViewUniformBuffer);
+	// Low res view and base pass parameters of the tier, the scene's uniform buffers are never switched to them
+	const EMobileDownsampleTranslucencyResolution Resolution = GetMobileDownsampleTranslucencyResolution(TranslucencyPassType);
+	FMeshPassProcessorRenderState PassDrawRenderState(GMobileDownsampledViewUniformBuffers.Get(Resolution), GMobileDownsampledViewUniformBuffers.GetBasePass(Resolution));
+	PassDrawRenderState.SetInstancedViewUniformBuffer(GMobileDownsampledViewUniformBuffers.GetInstanced(Resolution));
 	PassDrawRenderState.SetDepthStencilState(TStaticDepthStencilState<false, CF_DepthNearOrEqual>::GetRHI());
 	PassDrawRenderState.SetDepthStencilAccess(FExclusiveDepthStencil::DepthRead_StencilRead);
 
 	const FMobileBasePassMeshProcessor::EFlags Flags = FMobileBasePassMeshProcessor::EFlags::CanUseDepthStencil;
 
-	return new(FMemStack::Get()) FMobileBasePassMeshProcessor(Scene, Scene->GetFeatureLevel(), InViewIfDynamicMeshCommand, PassDrawRenderState, InDrawListContext, Flags, ETranslucencyPass::TPT_TranslucencyDownSampleSeparate);
+	return new(FMemStack::Get()) FMobileBasePassMeshProcessor(Scene, Scene->GetFeatureLevel(), InViewIfDynamicMeshCommand, PassDrawRenderState, InDrawListContext, Flags, TranslucencyPassType);
 }
 
 
@@ -802,7 +851,85 @@ FRegisterPassProcessorCreateFunction RegisterMobileBasePassCSM(&CreateMobileBase
 FRegisterPassProcessorCreateFunction RegisterMobileTranslucencyAllPass(&CreateMobileTranslucencyAllPassProcessor, EShadingPath::Mobile, EMeshPass::TranslucencyAll, EMeshPassFlags::CachedMeshCommands | EMeshPassFlags::MainView);
 FRegisterPassProcessorCreateFunction RegisterMobileTranslucencyStandardPass(&CreateMobileTranslucencyStandardPassProcessor, EShadingPath::Mobile, EMeshPass::TranslucencyStandard, EMeshPassFlags::CachedMeshCommands | EMeshPassFlags::MainView);
 //YJH Created By 2020-7-25
-FRegisterPassProcessorCreateFunction RegisterMobileTranslucencyDownSampleSeparatePass(&CreateMobileTranslucencyDownSampleSeparatePassProcessor, EShadingPath::Mobile, EMeshPass::TranslucencyDownSampleSeparate, EMeshPassFlags::CachedMeshCommands | EMeshPassFlags::MainView);
+FRegisterPassProcessorCreateFunction RegisterMobileTranslucencyDownSampleSeparatePass(&CreateMobileTranslucencyDownSampleSeparatePassProcessor<ETranslucencyPass::TPT_TranslucencyDownSampleSeparate>, EShadingPath::Mobile, EMeshPass::TranslucencyDownSampleSeparate, EMeshPassFlags::CachedMeshCommands | EMeshPassFlags::MainView);
 //End
+FRegisterPassProcessorCreateFunction RegisterMobileTranslucencyDownSampleSeparateFullPass(&CreateMobileTranslucencyDownSampleSeparatePassProcessor<ETranslucencyPass::TPT_TranslucencyDownSampleSeparateFull>, EShadingPath::Mobile, EMeshPass::TranslucencyDownSampleSeparateFull, EMeshPassFlags::CachedMeshCommands | EMeshPassFlags::MainView);
+FRegisterPassProcessorCreateFunction RegisterMobileTranslucencyDownSampleSeparateHalfPass(&CreateMobileTranslucencyDownSampleSeparatePassProcessor<ETranslucencyPass::TPT_TranslucencyDownSampleSeparateHalf>, EShadingPath::Mobile, EMeshPass::TranslucencyDownSampleSeparateHalf, EMeshPassFlags::CachedMeshCommands | EMeshPassFlags::MainView);
+FRegisterPassProcessorCreateFunction RegisterMobileTranslucencyDownSampleSeparateQuarterPass(&CreateMobileTranslucencyDownSampleSeparatePassProcessor<ETranslucencyPass::TPT_TranslucencyDownSampleSeparateQuarter>, EShadingPath::Mobile, EMeshPass::TranslucencyDownSampleSeparateQuarter, EMeshPassFlags::CachedMeshCommands | EMeshPassFlags::MainView);
 FRegisterPassProcessorCreateFunction RegisterMobileTranslucencyAfterDOFPass(&CreateMobileTranslucencyAfterDOFProcessor, EShadingPath::Mobile, EMeshPass::TranslucencyAfterDOF, EMeshPassFlags::CachedMeshCommands | EMeshPassFlags::MainView);
 // Skipping EMeshPass::TranslucencyAfterDOFModulate because dual blending is not supported on mobile
+
+#if !UE_BUILD_SHIPPING
+
+/**
+ * Builds a synthetic primitive with one mesh batch per mobile translucent material setting, combines their material relevance,
+ * looks the translucency passes up in FTranslucencyRelevancePassTable as the relevance packets do and checks every batch is then
+ * accepted by exactly one of those passes.
+ */
+static void ValidateMobileTranslucencyRouting()
+{
+	struct FSyntheticMeshBatch
+	{
+		bool bMobileSeparateTranslucency;
+		EMobileDownsampleTranslucencyResolution DownsampleResolution;
+	};
+
+	TArray<FSyntheticMeshBatch> MeshBatches;
+	FMaterialRelevance CombinedRelevance;
+	for (int32 SeparateIndex = 0; SeparateIndex < 2; SeparateIndex++)
+	{
+		for (int32 ResolutionIndex = 0; ResolutionIndex < (int32)EMobileDownsampleTranslucencyResolution::Num; ResolutionIndex++)
+		{
+			const FSyntheticMeshBatch MeshBatch = { SeparateIndex != 0, (EMobileDownsampleTranslucencyResolution)ResolutionIndex };
+			MeshBatches.Add(MeshBatch);
+
+			// Alpha blended, as set by UMaterialInterface::GetRelevance_Internal, no dual blending on mobile
+			FMaterialRelevance MaterialRelevance;
+			MaterialRelevance.SetTranslucencyPassRelevance(true, MeshBatch.bMobileSeparateTranslucency, false, MeshBatch.DownsampleResolution);
+			CombinedRelevance |= MaterialRelevance;
+		}
+	}
+
+	FPrimitiveViewRelevance ViewRelevance;
+	CombinedRelevance.SetPrimitiveViewRelevance(ViewRelevance);
+
+	int32 NumFailedMeshBatches = 0;
+	for (int32 ConfigIndex = 0; ConfigIndex < 2; ConfigIndex++)
+	{
+		const bool bAllowTranslucencyAfterDOF = ConfigIndex == 0;
+
+		FTranslucencyRelevancePassTable Table;
+		Table.Init(bAllowTranslucencyAfterDOF, false);
+
+		const uint32 TranslucencyPassBits = Table.TranslucencyPasses[FTranslucencyRelevancePassTable::GetIndex(ViewRelevance)];
+		for (const FSyntheticMeshBatch& MeshBatch : MeshBatches)
+		{
+			int32 NumDrawingPasses = 0;
+			for (uint32 TranslucencyPasses = TranslucencyPassBits; TranslucencyPasses; TranslucencyPasses &= TranslucencyPasses - 1)
+			{
+				const ETranslucencyPass::Type TranslucencyPass = (ETranslucencyPass::Type)FMath::CountTrailingZeros(TranslucencyPasses);
+				NumDrawingPasses += ShouldDrawInMobileTranslucencyPass(TranslucencyPass, MeshBatch.bMobileSeparateTranslucency, MeshBatch.DownsampleResolution) ? 1 : 0;
+			}
+
+			if (NumDrawingPasses != 1)
+			{
+				NumFailedMeshBatches++;
+				UE_LOG(LogRenderer, Error, TEXT("Mobile translucency routing: mesh batch with separate translucency %d and off-screen resolution %d is drawn by %d passes, translucency after DOF %d."),
+					MeshBatch.bMobileSeparateTranslucency ? 1 : 0, (int32)MeshBatch.DownsampleResolution, NumDrawingPasses, bAllowTranslucencyAfterDOF ? 1 : 0);
+			}
+		}
+
+		UE_LOG(LogRenderer, Display, TEXT("Mobile translucency routing: %d mesh batches over %d relevant passes, translucency after DOF %d."),
+			MeshBatches.Num(), FMath::CountBits(TranslucencyPassBits), bAllowTranslucencyAfterDOF ? 1 : 0);
+	}
+
+	UE_LOG(LogRenderer, Display, TEXT("Mobile translucency routing %s, %d mesh batches not drawn by exactly one pass."),
+		NumFailedMeshBatches == 0 ? TEXT("PASSED") : TEXT("FAILED"), NumFailedMeshBatches);
+}
+
+static FAutoConsoleCommand GValidateMobileTranslucencyRouting(
+	TEXT("r.Mobile.OffScreenParticles.ValidateRouting"),
+	TEXT("Routes a synthetic primitive mixing every mobile translucent material setting and checks each of its mesh batches is drawn by exactly one translucency pass."),
+	FConsoleCommandDelegate::CreateStatic(&ValidateMobileTranslucencyRouting));
+
+#endif // !UE_BUILD_SHIPPING
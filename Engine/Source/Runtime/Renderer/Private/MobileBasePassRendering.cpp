@@ -36,6 +36,15 @@ static TAutoConsoleVariable<int32> CVarMobileEnableMovableSpotLights(
 	TEXT("If 1 then enable movable spotlight support"),
 	ECVF_ReadOnly | ECVF_RenderThreadSafe);
 
+static TAutoConsoleVariable<int32> CVarMobileSeparateTranslucencyColorFormat(
+	TEXT("r.Mobile.SeparateTranslucencyColorFormat"),
+	0,
+	TEXT("Storage of the low res color of the mobile off-screen particles.\n")
+	TEXT("The format must be renderable and blendable on the target devices, set it per platform.\n")
+	TEXT(" 0 = FloatRGBA, 8 bytes per texel [default]\n")
+	TEXT(" 1 = RGBA8, 4 bytes per texel, color clamped to 1"),
+	ECVF_ReadOnly | ECVF_RenderThreadSafe);
+
 
 IMPLEMENT_GLOBAL_SHADER_PARAMETER_STRUCT(FMobileBasePassUniformParameters, "MobileBasePass");
 
@@ -110,10 +119,20 @@ bool TMobileBasePassPSPolicyParamType<LightMapPolicyType>::ModifyCompilationEnvi
 template<typename LightMapPolicyType>
 bool TMobileBasePassPSPolicyParamType<LightMapPolicyType>::ModifyComplilationEnviromentForDownSampleTranslucency(const FMaterialShaderParameters& MaterialParameters, FShaderCompilerEnvironment& OutEnvironment) {
 
-	OutEnvironment.SetDefine(TEXT("MOBILE_DOWNSAMPLE_TRANSLUCENCY"), MaterialParameters.bIsDownSampleSeparateTranslucency ? 1u : 0u);
+	// Left undefined otherwise, so materials which are never drawn off-screen keep the exact environment, and shader code, of the stock base pass
+	if (MaterialParameters.bIsDownSampleSeparateTranslucency)
+	{
+		OutEnvironment.SetDefine(TEXT("MOBILE_DOWNSAMPLE_TRANSLUCENCY"), 1u);
+	}
 	return true;
 }
 
+EMobileDownsampleTranslucencyColorFormat GetMobileDownsampleTranslucencyColorFormat()
+{
+	const int32 Format = CVarMobileSeparateTranslucencyColorFormat.GetValueOnAnyThread();
+	return (EMobileDownsampleTranslucencyColorFormat)FMath::Clamp(Format, 0, (int32)EMobileDownsampleTranslucencyColorFormat::Num - 1);
+}
+
 
 FMobileBasePassMovableLightInfo::FMobileBasePassMovableLightInfo(const FPrimitiveSceneProxy* InSceneProxy)
 : NumMovablePointLights(0)
@@ -181,6 +200,87 @@ void SetupMobileBasePassUniformParameters(
 
 	BasePassParameters.PreIntegratedGFTexture = GSystemTextures.PreintegratedGF->GetRenderTargetItem().ShaderResourceTexture;
 	BasePassParameters.PreIntegratedGFSampler = TStaticSamplerState<SF_Bilinear, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
+
+	// Full res passes, the off-screen particle ones override them in FMobileDownsampledViewUniformBuffers::Update
+	BasePassParameters.DownsampledTranslucencyFactor = FVector2D(1.0f, 1.0f);
+	BasePassParameters.DownsampledTranslucencyLowResViewMin = FVector2D(View.ViewRect.Min);
+	BasePassParameters.DownsampledTranslucencyFullResViewMin = FVector2D(View.ViewRect.Min);
+}
+
+TGlobalResource<FMobileDownsampledViewUniformBuffers> GMobileDownsampledViewUniformBuffers;
+
+void FMobileDownsampledViewUniformBuffers::Update(FRHICommandListImmediate& RHICmdList, const FViewInfo& View, EMobileDownsampleTranslucencyResolution Resolution, FIntPoint BufferSize, const FIntRect& DownsampledViewRect)
+{
+	check(IsInRenderingThread());
+
+	FViewUniformShaderParameters DownsampledViewParameters = *View.CachedViewUniformShaderParameters;
+	View.SetupViewRectUniformBufferParameters(
+		DownsampledViewParameters,
+		BufferSize,
+		DownsampledViewRect,
+		View.ViewMatrices,
+		View.PrevViewInfo.ViewMatrices);
+
+	ViewUniformBuffers[(int32)Resolution].UpdateUniformBufferImmediate(DownsampledViewParameters);
+
+	if (View.bIsMobileMultiViewEnabled && View.Family->Views.Num() > 1)
+	{
+		const FViewInfo& InstancedView = static_cast<const FViewInfo&>(View.Family->GetStereoEyeView(eSSP_RIGHT_EYE));
+		FViewUniformShaderParameters DownsampledInstancedViewParameters = *InstancedView.CachedViewUniformShaderParameters;
+		InstancedView.SetupViewRectUniformBufferParameters(
+			DownsampledInstancedViewParameters,
+			BufferSize,
+			DownsampledViewRect,
+			InstancedView.ViewMatrices,
+			InstancedView.PrevViewInfo.ViewMatrices);
+
+		InstancedViewUniformBuffers[(int32)Resolution].UpdateUniformBufferImmediate(reinterpret_cast<FInstancedViewUniformShaderParameters&>(DownsampledInstancedViewParameters));
+	}
+
+	// View.BufferSizeAndInvSize is now the low res target, CalcSceneDepth maps back to the full res depth as MobileDownSampleDepth does
+	FMobileBasePassUniformParameters BasePassParameters;
+	SetupMobileBasePassUniformParameters(RHICmdList, View, true, BasePassParameters);
+	BasePassParameters.DownsampledTranslucencyFactor = FVector2D(float(View.ViewRect.Width()) / DownsampledViewRect.Width(), float(View.ViewRect.Height()) / DownsampledViewRect.Height());
+	BasePassParameters.DownsampledTranslucencyLowResViewMin = FVector2D(DownsampledViewRect.Min);
+	BasePassParameters.DownsampledTranslucencyFullResViewMin = FVector2D(View.ViewRect.Min);
+	BasePassUniformBuffers[(int32)Resolution].UpdateUniformBufferImmediate(BasePassParameters);
+}
+
+void FMobileDownsampledViewUniformBuffers::InitRHI()
+{
+	FViewUniformShaderParameters ViewUniformBufferParameters;
+	for (TUniformBufferRef<FViewUniformShaderParameters>& ViewUniformBuffer : ViewUniformBuffers)
+	{
+		ViewUniformBuffer = TUniformBufferRef<FViewUniformShaderParameters>::CreateUniformBufferImmediate(ViewUniformBufferParameters, UniformBuffer_MultiFrame, EUniformBufferValidation::None);
+	}
+
+	FInstancedViewUniformShaderParameters InstancedViewUniformBufferParameters;
+	for (TUniformBufferRef<FInstancedViewUniformShaderParameters>& InstancedViewUniformBuffer : InstancedViewUniformBuffers)
+	{
+		InstancedViewUniformBuffer = TUniformBufferRef<FInstancedViewUniformShaderParameters>::CreateUniformBufferImmediate(InstancedViewUniformBufferParameters, UniformBuffer_MultiFrame, EUniformBufferValidation::None);
+	}
+
+	FMobileBasePassUniformParameters BasePassUniformBufferParameters;
+	for (TUniformBufferRef<FMobileBasePassUniformParameters>& BasePassUniformBuffer : BasePassUniformBuffers)
+	{
+		BasePassUniformBuffer = TUniformBufferRef<FMobileBasePassUniformParameters>::CreateUniformBufferImmediate(BasePassUniformBufferParameters, UniformBuffer_MultiFrame, EUniformBufferValidation::None);
+	}
+}
+
+void FMobileDownsampledViewUniformBuffers::ReleaseRHI()
+{
+	for (TUniformBufferRef<FViewUniformShaderParameters>& ViewUniformBuffer : ViewUniformBuffers)
+	{
+		ViewUniformBuffer.SafeRelease();
+	}
+	for (TUniformBufferRef<FInstancedViewUniformShaderParameters>& InstancedViewUniformBuffer : InstancedViewUniformBuffers)
+	{
+		InstancedViewUniformBuffer.SafeRelease();
+	}
+	for (TUniformBufferRef<FMobileBasePassUniformParameters>& BasePassUniformBuffer : BasePassUniformBuffers)
+	{
+		BasePassUniformBuffer.SafeRelease();
+	}
 }
 
 void CreateMobileBasePassUniformBuffer(
@@ -23,6 +23,7 @@
 #include "PlanarReflectionRendering.h"
 #include "BasePassRendering.h"
 #include "SkyAtmosphereRendering.h"
+#include "TranslucencyPass.h"
 
 BEGIN_GLOBAL_SHADER_PARAMETER_STRUCT(FMobileBasePassUniformParameters, )
 	SHADER_PARAMETER_STRUCT(FFogUniformParameters, Fog)
@@ -30,6 +31,9 @@ BEGIN_GLOBAL_SHADER_PARAMETER_STRUCT(FMobileBasePassUniformParameters, )
 	SHADER_PARAMETER_STRUCT(FMobileSceneTextureUniformParameters, SceneTextures)
 	SHADER_PARAMETER_TEXTURE(Texture2D, PreIntegratedGFTexture)
 	SHADER_PARAMETER_SAMPLER(SamplerState, PreIntegratedGFSampler)
+	SHADER_PARAMETER(FVector2D, DownsampledTranslucencyFactor) // Full res texels per low res texel of the off-screen particle passes, see MobileDownSampleDepth.
+	SHADER_PARAMETER(FVector2D, DownsampledTranslucencyLowResViewMin)
+	SHADER_PARAMETER(FVector2D, DownsampledTranslucencyFullResViewMin)
 END_GLOBAL_SHADER_PARAMETER_STRUCT()
 
 extern void SetupMobileBasePassUniformParameters(
@@ -56,6 +60,48 @@ extern void SetupMobileSkyReflectionUniformParameters(
 	class FSkyLightSceneProxy* SkyLight,
 	FMobileReflectionCaptureShaderParameters& Parameters);
 
+/** Low res color storage of the mobile off-screen particles, r.Mobile.SeparateTranslucencyColorFormat. */
+extern EMobileDownsampleTranslucencyColorFormat GetMobileDownsampleTranslucencyColorFormat();
+
+/**
+ * View uniform buffers of the mobile off-screen particle passes, one per EMobileDownsampleTranslucencyResolution. The cached and dynamic
+ * mesh draw commands of those passes bind them instead of the scene's persistent view uniform buffer, which keeps the full res view.
+ * Like it, they are shared by all views and updated before each view's pass.
+ */
+class FMobileDownsampledViewUniformBuffers : public FRenderResource
+{
+public:
+	const TUniformBufferRef<FViewUniformShaderParameters>& Get(EMobileDownsampleTranslucencyResolution Resolution) const
+	{
+		return ViewUniformBuffers[(int32)Resolution];
+	}
+
+	/** Right eye of mobile multi-view, drawn by the same draws as the left eye one. */
+	const TUniformBufferRef<FInstancedViewUniformShaderParameters>& GetInstanced(EMobileDownsampleTranslucencyResolution Resolution) const
+	{
+		return InstancedViewUniformBuffers[(int32)Resolution];
+	}
+
+	/** Translucent base pass parameters of the tier, mapping its low res pixels to the full res scene depth read by the materials. */
+	const TUniformBufferRef<FMobileBasePassUniformParameters>& GetBasePass(EMobileDownsampleTranslucencyResolution Resolution) const
+	{
+		return BasePassUniformBuffers[(int32)Resolution];
+	}
+
+	/** Uploads the low res view of View, drawn at DownsampledViewRect of a target of BufferSize, its right eye with mobile multi-view and its base pass parameters. */
+	void Update(FRHICommandListImmediate& RHICmdList, const FViewInfo& View, EMobileDownsampleTranslucencyResolution Resolution, FIntPoint BufferSize, const FIntRect& DownsampledViewRect);
+
+	virtual void InitRHI() override;
+	virtual void ReleaseRHI() override;
+
+private:
+	TUniformBufferRef<FViewUniformShaderParameters> ViewUniformBuffers[(int32)EMobileDownsampleTranslucencyResolution::Num];
+	TUniformBufferRef<FInstancedViewUniformShaderParameters> InstancedViewUniformBuffers[(int32)EMobileDownsampleTranslucencyResolution::Num];
+	TUniformBufferRef<FMobileBasePassUniformParameters> BasePassUniformBuffers[(int32)EMobileDownsampleTranslucencyResolution::Num];
+};
+
+extern TGlobalResource<FMobileDownsampledViewUniformBuffers> GMobileDownsampledViewUniformBuffers;
+
 
 
 class FPlanarReflectionSceneProxy;
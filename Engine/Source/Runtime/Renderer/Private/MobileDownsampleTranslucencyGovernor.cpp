@@ -0,0 +1,178 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	MobileDownsampleTranslucencyGovernor.cpp: GPU time driven resolution selection
+	for the mobile off-screen particle pass.
+=============================================================================*/
+
+#include "MobileDownsampleTranslucencyGovernor.h"
+#include "HAL/IConsoleManager.h"
+#include "RendererModule.h"
+
+FMobileDownsampleTranslucencyGovernor::FMobileDownsampleTranslucencyGovernor(EResolution InitialResolution)
+	: Resolution(InitialResolution)
+	, SmoothedDurationMS(0.0f)
+	, LastChangeTime(-DBL_MAX)
+{
+}
+
+bool FMobileDownsampleTranslucencyGovernor::Update(float GPUDurationMS, double CurrentTime, const FSettings& Settings)
+{
+	check(Settings.MaxResolution <= Settings.MinResolution);
+
+	const EResolution OriginalResolution = Resolution;
+	Resolution = FMath::Clamp(Resolution, Settings.MaxResolution, Settings.MinResolution);
+
+	// Samples taken at the previous resolution are meaningless after a change, so the average restarts from the first new sample
+	const float LerpAlpha = SmoothedDurationMS == 0.0f ? 1.0f : Settings.SmoothingAlpha;
+	SmoothedDurationMS = FMath::Lerp(SmoothedDurationMS, GPUDurationMS, LerpAlpha);
+
+	// Don't re-asses switching for some time after the last switch
+	if (Resolution == OriginalResolution && CurrentTime - LastChangeTime > Settings.MinChangeTimeSeconds)
+	{
+		if (SmoothedDurationMS > Settings.DownsampleThresholdMS && Resolution < Settings.MinResolution)
+		{
+			Resolution = EResolution(uint8(Resolution) + 1);
+			UE_LOG(LogRenderer, Verbose, TEXT("Mobile off-screen particles downsample: %.2fms > %.2fms"), SmoothedDurationMS, Settings.DownsampleThresholdMS);
+		}
+		else if (SmoothedDurationMS < Settings.UpsampleThresholdMS && Resolution > Settings.MaxResolution)
+		{
+			Resolution = EResolution(uint8(Resolution) - 1);
+			UE_LOG(LogRenderer, Verbose, TEXT("Mobile off-screen particles upsample: %.2fms < %.2fms"), SmoothedDurationMS, Settings.UpsampleThresholdMS);
+		}
+	}
+
+	if (Resolution != OriginalResolution)
+	{
+		SmoothedDurationMS = 0.0f;
+		LastChangeTime = CurrentTime;
+		return true;
+	}
+	return false;
+}
+
+float FMobileDownsampleTranslucencyGovernor::GetResolutionScale(EResolution InResolution)
+{
+	switch (InResolution)
+	{
+	case EResolution::Full: return 1.0f;
+	case EResolution::Half: return 0.5f;
+	case EResolution::Quarter: return 0.25f;
+	}
+
+	checkNoEntry();
+	return 0.5f;
+}
+
+#if !UE_BUILD_SHIPPING
+
+/**
+ * Feeds recorded GPU time traces to the governor at 64 frames per second, a frame time exact in binary so the MinChangeTimeSeconds
+ * comparisons are exact, and checks the frames at which it changes resolution. Works headless (-nullrhi).
+ */
+static void TestMobileDownsampleTranslucencyGovernor(const TArray<FString>& Args)
+{
+	typedef FMobileDownsampleTranslucencyGovernor::EResolution EResolution;
+
+	struct FSegment
+	{
+		int32 NumFrames;
+		float GPUDurationMS;
+	};
+
+	struct FChange
+	{
+		int32 Frame;
+		EResolution Resolution;
+
+		bool operator==(const FChange& Other) const { return Frame == Other.Frame && Resolution == Other.Resolution; }
+	};
+
+	struct FCase
+	{
+		const TCHAR* Name;
+		EResolution InitialResolution;
+		EResolution MaxResolution;
+		EResolution MinResolution;
+		TArray<FSegment> Trace;
+		TArray<FChange> ExpectedChanges;
+	};
+
+	// Default settings: down above 2ms, up below 0.5ms, 1s between changes, 0.1 smoothing.
+	// The smoothed duration after n samples of D following a steady S is D + (S - D) * 0.9^n.
+	const FCase Cases[] =
+	{
+		// 1ms stays between the thresholds
+		{ TEXT("Dead band"), EResolution::Half, EResolution::Full, EResolution::Quarter,
+			{ { 256, 1.0f } },
+			{} },
+		// 1 + 0.1 * (8 - 1) = 1.7ms after each spike, never above 2ms
+		{ TEXT("Single frame spikes"), EResolution::Half, EResolution::Full, EResolution::Quarter,
+			{ { 31, 1.0f }, { 1, 8.0f }, { 31, 1.0f }, { 1, 8.0f }, { 31, 1.0f }, { 1, 8.0f } },
+			{} },
+		// 6 - 5 * 0.9^3 = 2.36ms on the third 6ms frame (66), clamped at Quarter while overloaded.
+		// Restarts at 6ms, 0.1 + 5.9 * 0.9^26 = 0.48ms on the 26th 0.1ms frame (217), then Full once a second has passed (282).
+		{ TEXT("Explosion"), EResolution::Half, EResolution::Full, EResolution::Quarter,
+			{ { 64, 1.0f }, { 128, 6.0f }, { 256, 0.1f } },
+			{ { 66, EResolution::Quarter }, { 217, EResolution::Half }, { 282, EResolution::Full } } },
+		// The first sample is taken as is, then one step per MinChangeTimeSeconds: 64 frames later
+		{ TEXT("Sustained overload"), EResolution::Full, EResolution::Full, EResolution::Quarter,
+			{ { 256, 6.0f } },
+			{ { 0, EResolution::Half }, { 65, EResolution::Quarter } } },
+		// Clamped into [Half, Half] by the first update, neither load moves it
+		{ TEXT("Clamps"), EResolution::Full, EResolution::Half, EResolution::Half,
+			{ { 128, 0.1f }, { 128, 6.0f } },
+			{ { 0, EResolution::Half } } },
+	};
+
+	auto FormatChanges = [](const TArray<FChange>& Changes)
+	{
+		FString Result;
+		for (const FChange& Change : Changes)
+		{
+			Result += FString::Printf(TEXT("%s%d:%.2f"), Result.IsEmpty() ? TEXT("") : TEXT(" "), Change.Frame, FMobileDownsampleTranslucencyGovernor::GetResolutionScale(Change.Resolution));
+		}
+		return Result.IsEmpty() ? FString(TEXT("none")) : Result;
+	};
+
+	bool bAllPassed = true;
+	for (const FCase& Case : Cases)
+	{
+		FMobileDownsampleTranslucencyGovernor::FSettings Settings;
+		Settings.MaxResolution = Case.MaxResolution;
+		Settings.MinResolution = Case.MinResolution;
+
+		FMobileDownsampleTranslucencyGovernor Governor(Case.InitialResolution);
+		TArray<FChange> Changes;
+		int32 Frame = 0;
+		for (const FSegment& Segment : Case.Trace)
+		{
+			for (int32 Index = 0; Index < Segment.NumFrames; Index++, Frame++)
+			{
+				if (Governor.Update(Segment.GPUDurationMS, Frame / 64.0, Settings))
+				{
+					Changes.Add({ Frame, Governor.GetResolution() });
+				}
+			}
+		}
+
+		const bool bPassed = Changes == Case.ExpectedChanges;
+		bAllPassed &= bPassed;
+
+		UE_LOG(LogRenderer, Display, TEXT("Off-screen particle governor %s %s: scale changes (frame:scale) %s, expected %s"),
+			Case.Name,
+			bPassed ? TEXT("PASSED") : TEXT("FAILED"),
+			*FormatChanges(Changes),
+			*FormatChanges(Case.ExpectedChanges));
+	}
+
+	UE_LOG(LogRenderer, Display, TEXT("Off-screen particle governor %s"), bAllPassed ? TEXT("PASSED") : TEXT("FAILED"));
+}
+
+static FAutoConsoleCommand GTestMobileDownsampleTranslucencyGovernor(
+	TEXT("r.Mobile.OffScreenParticles.TestGovernor"),
+	TEXT("Feeds synthetic GPU time traces to the mobile off-screen particle resolution governor and checks the resolution scale sequence,\n")
+	TEXT("covering the dead band, smoothing, MinChangeTimeSeconds hysteresis and the resolution clamps."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&TestMobileDownsampleTranslucencyGovernor));
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,62 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	MobileDownsampleTranslucencyGovernor.h: GPU time driven resolution selection
+	for the mobile off-screen particle pass.
+=============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Picks the resolution of the mobile off-screen particle pass (TranslucencyDownSampleSeparate) from its measured GPU time.
+ * Mirrors r.SeparateTranslucencyAutoDownsample of the deferred renderer with three steps instead of two.
+ * Has no RHI dependency so it can be driven by synthetic timing traces.
+ */
+class FMobileDownsampleTranslucencyGovernor
+{
+public:
+	enum class EResolution : uint8
+	{
+		Full,
+		Half,
+		Quarter,
+		Num
+	};
+
+	struct FSettings
+	{
+		/** Step down one resolution when the smoothed duration is above this (ms). */
+		float DownsampleThresholdMS = 2.0f;
+		/** Step up one resolution when the smoothed duration is below this (ms). Should be ~1/4 of DownsampleThresholdMS since each step changes the pixel count by 4. */
+		float UpsampleThresholdMS = 0.5f;
+		/** Minimum time between two resolution changes (s), prevents toggling while the latent timer still reports the old resolution. */
+		float MinChangeTimeSeconds = 1.0f;
+		/** Exponential smoothing factor applied to each new sample. */
+		float SmoothingAlpha = 0.1f;
+		/** Highest and lowest resolution the governor may pick. */
+		EResolution MaxResolution = EResolution::Full;
+		EResolution MinResolution = EResolution::Quarter;
+	};
+
+	explicit FMobileDownsampleTranslucencyGovernor(EResolution InitialResolution = EResolution::Half);
+
+	/**
+	 * Feeds the GPU duration of the last measured frame. CurrentTime is in seconds and must be monotonic.
+	 * Returns true if the resolution changed.
+	 */
+	bool Update(float GPUDurationMS, double CurrentTime, const FSettings& Settings);
+
+	EResolution GetResolution() const { return Resolution; }
+
+	float GetSmoothedDurationMS() const { return SmoothedDurationMS; }
+
+	/** Resolution scale to apply to the view rect for a resolution step. */
+	static float GetResolutionScale(EResolution InResolution);
+
+private:
+	EResolution Resolution;
+	float SmoothedDurationMS;
+	double LastChangeTime;
+};
@@ -0,0 +1,259 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	MobileDownsampleTranslucencyGraph.cpp: Passes and low res textures of the
+	render graph of the mobile off-screen particles.
+=============================================================================*/
+
+#include "MobileDownsampleTranslucencyGraph.h"
+#include "HAL/IConsoleManager.h"
+#include "RenderingThread.h"
+#include "RendererModule.h"
+
+namespace MobileDownsampleTranslucencyGraph
+{
+	/** Views sharing passes: all views with draws in an atlas, one view per group otherwise. */
+	static TArray<TArray<int32, TInlineAllocator<2>>, TInlineAllocator<2>> GetViewGroups(TArrayView<const FViewDesc> Views, bool bAtlas)
+	{
+		TArray<TArray<int32, TInlineAllocator<2>>, TInlineAllocator<2>> Groups;
+		for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ViewIndex++)
+		{
+			if (Views[ViewIndex].ResolutionMask != 0)
+			{
+				if (!bAtlas || Groups.Num() == 0)
+				{
+					Groups.AddDefaulted();
+				}
+				Groups.Last().Add(ViewIndex);
+			}
+		}
+		return Groups;
+	}
+
+	FPlan BuildPlan(TArrayView<const FViewDesc> Views, bool bAtlas)
+	{
+		FPlan Plan;
+		for (const TArray<int32, TInlineAllocator<2>>& GroupViews : GetViewGroups(Views, bAtlas))
+		{
+			TArray<int32, TInlineAllocator<8>> GroupTextures;
+			for (int32 ResolutionIndex = (int32)EMobileDownsampleTranslucencyResolution::Full; ResolutionIndex <= (int32)EMobileDownsampleTranslucencyResolution::Auto; ResolutionIndex++)
+			{
+				const EMobileDownsampleTranslucencyResolution Resolution = (EMobileDownsampleTranslucencyResolution)ResolutionIndex;
+
+				FPass Pass;
+				Pass.Type = EPassType::DownsampleAndParticles;
+				Pass.Resolution = Resolution;
+				for (int32 ViewIndex : GroupViews)
+				{
+					if (Views[ViewIndex].HasDraws(Resolution))
+					{
+						Pass.Views.Add(ViewIndex);
+					}
+				}
+				if (Pass.Views.Num() == 0)
+				{
+					continue;
+				}
+
+				for (ETextureType Type : { ETextureType::Color, ETextureType::Depth })
+				{
+					FTexture Texture;
+					Texture.Type = Type;
+					Texture.Resolution = Resolution;
+					Texture.ProducerPass = Plan.Passes.Num();
+					Pass.Writes.Add(Plan.Textures.Add(Texture));
+					GroupTextures.Add(Pass.Writes.Last());
+				}
+				Plan.Passes.Add(MoveTemp(Pass));
+			}
+
+			FPass Upsample;
+			Upsample.Type = EPassType::Upsample;
+			Upsample.Views = GroupViews;
+			Upsample.Reads = GroupTextures;
+			for (int32 TextureIndex : GroupTextures)
+			{
+				Plan.Textures[TextureIndex].LastConsumerPass = Plan.Passes.Num();
+			}
+			Plan.Passes.Add(MoveTemp(Upsample));
+		}
+		return Plan;
+	}
+
+	int32 GetPeakLiveTextures(const FPlan& Plan)
+	{
+		int32 PeakLiveTextures = 0;
+		for (int32 PassIndex = 0; PassIndex < Plan.Passes.Num(); PassIndex++)
+		{
+			int32 LiveTextures = 0;
+			for (const FTexture& Texture : Plan.Textures)
+			{
+				LiveTextures += Texture.ProducerPass <= PassIndex && PassIndex <= Texture.LastConsumerPass ? 1 : 0;
+			}
+			PeakLiveTextures = FMath::Max(PeakLiveTextures, LiveTextures);
+		}
+		return PeakLiveTextures;
+	}
+
+	bool ValidatePlan(const FPlan& Plan, TArrayView<const FViewDesc> Views, bool bAtlas, FString& OutError)
+	{
+		const int32 NumTexturesPerTier = 2;
+
+		// Expected from the views alone: the atlas draws each tier of any view once and composites all views in one pass, all its textures
+		// alive at once. Otherwise every view with draws gets a pass per tier and its own upsample, only its own textures alive.
+		uint32 AtlasMask = 0;
+		int32 NumPasses = 0;
+		int32 NumTextures = 0;
+		int32 MaxLiveTextures = 0;
+		for (const FViewDesc& View : Views)
+		{
+			const int32 NumViewTiers = FMath::CountBits(View.ResolutionMask);
+			AtlasMask |= View.ResolutionMask;
+			NumPasses += NumViewTiers > 0 ? NumViewTiers + 1 : 0;
+			NumTextures += NumViewTiers * NumTexturesPerTier;
+			MaxLiveTextures = FMath::Max(MaxLiveTextures, NumViewTiers * NumTexturesPerTier);
+		}
+		if (bAtlas)
+		{
+			const int32 NumTiers = FMath::CountBits(AtlasMask);
+			NumPasses = NumTiers > 0 ? NumTiers + 1 : 0;
+			NumTextures = NumTiers * NumTexturesPerTier;
+			MaxLiveTextures = NumTextures;
+		}
+
+		if (Plan.Passes.Num() != NumPasses)
+		{
+			OutError = FString::Printf(TEXT("%d passes, %d expected"), Plan.Passes.Num(), NumPasses);
+			return false;
+		}
+		if (Plan.Textures.Num() != NumTextures)
+		{
+			OutError = FString::Printf(TEXT("%d textures, %d expected"), Plan.Textures.Num(), NumTextures);
+			return false;
+		}
+
+		for (int32 TextureIndex = 0; TextureIndex < Plan.Textures.Num(); TextureIndex++)
+		{
+			const FTexture& Texture = Plan.Textures[TextureIndex];
+
+			int32 NumWriters = 0;
+			int32 NumReaders = 0;
+			for (int32 PassIndex = 0; PassIndex < Plan.Passes.Num(); PassIndex++)
+			{
+				const FPass& Pass = Plan.Passes[PassIndex];
+				if (Pass.Writes.Contains(TextureIndex))
+				{
+					NumWriters++;
+					if (PassIndex != Texture.ProducerPass || Pass.Type != EPassType::DownsampleAndParticles || Pass.Resolution != Texture.Resolution)
+					{
+						OutError = FString::Printf(TEXT("texture %d is written by pass %d, which is not its producer"), TextureIndex, PassIndex);
+						return false;
+					}
+				}
+				if (Pass.Reads.Contains(TextureIndex))
+				{
+					NumReaders++;
+					if (PassIndex != Texture.LastConsumerPass || Pass.Type != EPassType::Upsample || PassIndex <= Texture.ProducerPass)
+					{
+						OutError = FString::Printf(TEXT("texture %d is read by pass %d, which is not the upsample after its producer"), TextureIndex, PassIndex);
+						return false;
+					}
+				}
+			}
+
+			if (NumWriters != 1 || NumReaders != 1)
+			{
+				OutError = FString::Printf(TEXT("texture %d has %d writers and %d readers, one of each expected"), TextureIndex, NumWriters, NumReaders);
+				return false;
+			}
+
+			for (int32 ViewIndex : Plan.Passes[Texture.ProducerPass].Views)
+			{
+				if (!Plan.Passes[Texture.LastConsumerPass].Views.Contains(ViewIndex))
+				{
+					OutError = FString::Printf(TEXT("texture %d is drawn for view %d and not composited onto it"), TextureIndex, ViewIndex);
+					return false;
+				}
+			}
+		}
+
+		// The textures of a view are dead once the next view's passes begin
+		const int32 PeakLiveTextures = GetPeakLiveTextures(Plan);
+		if (PeakLiveTextures != MaxLiveTextures)
+		{
+			OutError = FString::Printf(TEXT("%d textures alive at once, %d expected"), PeakLiveTextures, MaxLiveTextures);
+			return false;
+		}
+
+		return true;
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+
+/** Plans the graph of synthetic views with every tier combination, checks the plans and the render graphs built from them. Works headless (-nullrhi). */
+static void ValidateMobileDownsampleTranslucencyGraph(const TArray<FString>& Args)
+{
+	using namespace MobileDownsampleTranslucencyGraph;
+
+	const uint32 AutoMask = 1u << (uint32)EMobileDownsampleTranslucencyResolution::Auto;
+	const uint32 HalfMask = 1u << (uint32)EMobileDownsampleTranslucencyResolution::Half;
+	const uint32 AllMask = AutoMask | HalfMask
+		| (1u << (uint32)EMobileDownsampleTranslucencyResolution::Full)
+		| (1u << (uint32)EMobileDownsampleTranslucencyResolution::Quarter);
+
+	struct FCase
+	{
+		const TCHAR* Name;
+		TArray<FViewDesc> Views;
+	};
+	const FCase Cases[] =
+	{
+		{ TEXT("No draws"), { FViewDesc{ 0 } } },
+		{ TEXT("Auto"), { FViewDesc{ AutoMask } } },
+		{ TEXT("All tiers"), { FViewDesc{ AllMask } } },
+		{ TEXT("Split screen"), { FViewDesc{ AutoMask | HalfMask }, FViewDesc{ AutoMask } } },
+		{ TEXT("Split screen, one view without draws"), { FViewDesc{ HalfMask }, FViewDesc{ 0 }, FViewDesc{ AllMask } } },
+	};
+
+	bool bAllPassed = true;
+	for (const FCase& Case : Cases)
+	{
+		for (bool bAtlas : { false, true })
+		{
+			const FPlan Plan = BuildPlan(Case.Views, bAtlas);
+			FString Error;
+			bool bPassed = ValidatePlan(Plan, Case.Views, bAtlas, Error);
+			if (bPassed)
+			{
+				ENQUEUE_RENDER_COMMAND(ValidateMobileDownsampleTranslucencyGraph)(
+					[&Plan, &Case, bAtlas, &bPassed, &Error](FRHICommandListImmediate& RHICmdList)
+				{
+					bPassed = ValidateGraph(RHICmdList, Plan, Case.Views, bAtlas, Error);
+				});
+				FlushRenderingCommands();
+			}
+			bAllPassed &= bPassed;
+
+			UE_LOG(LogRenderer, Display, TEXT("Off-screen particle graph %s%s %s: %d passes, %d textures, %d alive at once%s%s"),
+				Case.Name,
+				bAtlas ? TEXT(", atlas") : TEXT(""),
+				bPassed ? TEXT("PASSED") : TEXT("FAILED"),
+				Plan.Passes.Num(),
+				Plan.Textures.Num(),
+				GetPeakLiveTextures(Plan),
+				bPassed ? TEXT("") : TEXT(", "),
+				*Error);
+		}
+	}
+
+	UE_LOG(LogRenderer, Display, TEXT("Off-screen particle graph %s"), bAllPassed ? TEXT("PASSED") : TEXT("FAILED"));
+}
+
+static FAutoConsoleCommand GValidateMobileDownsampleTranslucencyGraph(
+	TEXT("r.Mobile.OffScreenParticles.ValidateGraph"),
+	TEXT("Plans and executes the render graph of the mobile off-screen particles for synthetic views and checks its pass count and texture lifetimes,\n")
+	TEXT("see r.Mobile.SeparateTranslucencyRenderGraph."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&ValidateMobileDownsampleTranslucencyGraph));
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,97 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	MobileDownsampleTranslucencyGraph.h: Passes and low res textures of the
+	render graph of the mobile off-screen particles.
+=============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Materials/MobileDownsampleTranslucencyResolution.h"
+
+class FRHICommandListImmediate;
+
+/**
+ * Plan of the render graph of the mobile off-screen particles, see r.Mobile.SeparateTranslucencyRenderGraph. Doesn't depend on the renderer:
+ * FMobileSceneRenderer adds a graph pass and creates a transient texture for each entry, r.Mobile.OffScreenParticles.ValidateGraph checks
+ * plans of synthetic views and the graphs built from them.
+ */
+namespace MobileDownsampleTranslucencyGraph
+{
+	/** Off-screen particles of a view. */
+	struct FViewDesc
+	{
+		/** Bit per EMobileDownsampleTranslucencyResolution with draws, 0 for a view rendering none. */
+		uint32 ResolutionMask = 0;
+
+		bool HasDraws(EMobileDownsampleTranslucencyResolution Resolution) const
+		{
+			return (ResolutionMask & (1u << (uint32)Resolution)) != 0;
+		}
+	};
+
+	enum class ETextureType : uint8
+	{
+		Color,
+		Depth,
+	};
+
+	/** A transient low res texture of a tier, shared by the views of an atlas. */
+	struct FTexture
+	{
+		ETextureType Type = ETextureType::Color;
+		EMobileDownsampleTranslucencyResolution Resolution = EMobileDownsampleTranslucencyResolution::Disabled;
+		/** Pass clearing and writing it. */
+		int32 ProducerPass = INDEX_NONE;
+		/** Last pass reading it, the texture can be reused by the passes after it. */
+		int32 LastConsumerPass = INDEX_NONE;
+	};
+
+	enum class EPassType : uint8
+	{
+		/** Downsamples the depth and draws the particles of a tier into its textures, as a single render pass. */
+		DownsampleAndParticles,
+		/** Composites every tier of its views onto scene color, as a single render pass. */
+		Upsample,
+	};
+
+	struct FPass
+	{
+		EPassType Type = EPassType::DownsampleAndParticles;
+		/** Tier drawn by a DownsampleAndParticles pass. */
+		EMobileDownsampleTranslucencyResolution Resolution = EMobileDownsampleTranslucencyResolution::Disabled;
+		/** Indices of the views given to BuildPlan, those of the atlas or a single one. */
+		TArray<int32, TInlineAllocator<2>> Views;
+		/** Indices into FPlan::Textures. */
+		TArray<int32, TInlineAllocator<8>> Reads;
+		TArray<int32, TInlineAllocator<2>> Writes;
+	};
+
+	struct FPlan
+	{
+		TArray<FPass> Passes;
+		TArray<FTexture> Textures;
+	};
+
+	/**
+	 * Plans the passes of Views, tiers in the order of the immediate path. The views of an atlas share a pass per tier and a single upsample,
+	 * otherwise every view gets its own passes and textures, and its upsample ends their lifetimes before the next view's passes begin.
+	 * Tiers and views without draws get no pass.
+	 */
+	FPlan BuildPlan(TArrayView<const FViewDesc> Views, bool bAtlas);
+
+	/** Most textures alive at once over the passes of Plan, what the transient allocations of the graph peak at. */
+	int32 GetPeakLiveTextures(const FPlan& Plan);
+
+	/** Checks the pass count and the texture lifetimes BuildPlan must give Views, OutError describes the first mismatch. */
+	bool ValidatePlan(const FPlan& Plan, TArrayView<const FViewDesc> Views, bool bAtlas, FString& OutError);
+
+#if !UE_BUILD_SHIPPING
+	/**
+	 * Builds the render graph of Plan with the textures and bindings of FMobileSceneRenderer and passes which draw nothing, executes it and checks
+	 * the passes it runs and the allocations of its textures against Views. Flushes the free targets of the pool. Render thread, works headless (-nullrhi).
+	 */
+	bool ValidateGraph(FRHICommandListImmediate& RHICmdList, const FPlan& Plan, TArrayView<const FViewDesc> Views, bool bAtlas, FString& OutError);
+#endif
+}
@@ -0,0 +1,217 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	MobileDownsampleTranslucencyScissor.cpp: Screen space bounds of the mobile
+	off-screen particles, used to scissor the downsample and the composite.
+=============================================================================*/
+
+#include "MobileDownsampleTranslucencyScissor.h"
+#include "ScenePrivate.h"
+#include "HAL/IConsoleManager.h"
+#include "RendererModule.h"
+
+namespace MobileDownsampleTranslucencyScissor
+{
+	/** Grows InOutMin / InOutMax by the projection of Bounds, returns false if the box crosses the near plane. */
+	static bool AccumulateProjectedBox(const FBoxSphereBounds& Bounds, const FMatrix& TranslatedViewProjectionMatrix, const FVector& PreViewTranslation, FIntPoint ViewSize, FVector2D& InOutMin, FVector2D& InOutMax)
+	{
+		const FVector TranslatedOrigin = Bounds.Origin + PreViewTranslation;
+
+		for (int32 CornerIndex = 0; CornerIndex < 8; CornerIndex++)
+		{
+			const FVector Corner = TranslatedOrigin + FVector(
+				CornerIndex & 1 ? Bounds.BoxExtent.X : -Bounds.BoxExtent.X,
+				CornerIndex & 2 ? Bounds.BoxExtent.Y : -Bounds.BoxExtent.Y,
+				CornerIndex & 4 ? Bounds.BoxExtent.Z : -Bounds.BoxExtent.Z);
+
+			const FVector4 ClipPosition = TranslatedViewProjectionMatrix.TransformFVector4(FVector4(Corner, 1.0f));
+			if (ClipPosition.W <= KINDA_SMALL_NUMBER)
+			{
+				return false;
+			}
+
+			const FVector2D ScreenPosition(ClipPosition.X / ClipPosition.W, ClipPosition.Y / ClipPosition.W);
+			const FVector2D PixelPosition((ScreenPosition.X * 0.5f + 0.5f) * ViewSize.X, (0.5f - ScreenPosition.Y * 0.5f) * ViewSize.Y);
+
+			InOutMin.X = FMath::Min(InOutMin.X, PixelPosition.X);
+			InOutMin.Y = FMath::Min(InOutMin.Y, PixelPosition.Y);
+			InOutMax.X = FMath::Max(InOutMax.X, PixelPosition.X);
+			InOutMax.Y = FMath::Max(InOutMax.Y, PixelPosition.Y);
+		}
+		return true;
+	}
+
+	static FIntRect MakePaddedRect(const FVector2D& Min, const FVector2D& Max, FIntPoint ViewSize, int32 Padding)
+	{
+		FIntRect Rect(
+			FMath::FloorToInt(Min.X) - Padding,
+			FMath::FloorToInt(Min.Y) - Padding,
+			FMath::CeilToInt(Max.X) + Padding,
+			FMath::CeilToInt(Max.Y) + Padding);
+		Rect.Clip(FIntRect(FIntPoint::ZeroValue, ViewSize));
+		return Rect;
+	}
+
+	FIntRect ComputeViewRect(
+		const TArray<FPrimitiveBounds>& PrimitiveBounds,
+		TArrayView<const int32> PrimitiveIndices,
+		const FMatrix& TranslatedViewProjectionMatrix,
+		const FVector& PreViewTranslation,
+		FIntPoint ViewSize,
+		int32 Padding)
+	{
+		FVector2D Min(FLT_MAX, FLT_MAX);
+		FVector2D Max(-FLT_MAX, -FLT_MAX);
+
+		for (int32 PrimitiveIndex : PrimitiveIndices)
+		{
+			if (!AccumulateProjectedBox(PrimitiveBounds[PrimitiveIndex].BoxSphereBounds, TranslatedViewProjectionMatrix, PreViewTranslation, ViewSize, Min, Max))
+			{
+				return FIntRect(FIntPoint::ZeroValue, ViewSize);
+			}
+		}
+
+		return PrimitiveIndices.Num() > 0 ? MakePaddedRect(Min, Max, ViewSize, Padding) : FIntRect();
+	}
+
+	FIntRect ComputeViewRect(
+		TArrayView<const FBoxSphereBounds> Bounds,
+		const FMatrix& TranslatedViewProjectionMatrix,
+		const FVector& PreViewTranslation,
+		FIntPoint ViewSize,
+		int32 Padding)
+	{
+		FVector2D Min(FLT_MAX, FLT_MAX);
+		FVector2D Max(-FLT_MAX, -FLT_MAX);
+
+		for (const FBoxSphereBounds& Box : Bounds)
+		{
+			if (!AccumulateProjectedBox(Box, TranslatedViewProjectionMatrix, PreViewTranslation, ViewSize, Min, Max))
+			{
+				return FIntRect(FIntPoint::ZeroValue, ViewSize);
+			}
+		}
+
+		return Bounds.Num() > 0 ? MakePaddedRect(Min, Max, ViewSize, Padding) : FIntRect();
+	}
+
+	FIntRect GetDownsampledRect(const FIntRect& FullResRect, FIntPoint FullResViewSize, FIntPoint DownsampledViewSize)
+	{
+		if (FullResRect.Area() == 0)
+		{
+			return FIntRect();
+		}
+
+		const FVector2D Scale(float(DownsampledViewSize.X) / FullResViewSize.X, float(DownsampledViewSize.Y) / FullResViewSize.Y);
+		FIntRect Rect(
+			FMath::FloorToInt(FullResRect.Min.X * Scale.X) - 1,
+			FMath::FloorToInt(FullResRect.Min.Y * Scale.Y) - 1,
+			FMath::CeilToInt(FullResRect.Max.X * Scale.X) + 1,
+			FMath::CeilToInt(FullResRect.Max.Y * Scale.Y) + 1);
+		Rect.Clip(FIntRect(FIntPoint::ZeroValue, DownsampledViewSize));
+		return Rect;
+	}
+
+	int32 GetUpsamplePadding(FIntPoint FullResViewSize, FIntPoint DownsampledViewSize)
+	{
+		return FMath::Max(
+			FMath::DivideAndRoundUp(FullResViewSize.X, DownsampledViewSize.X),
+			FMath::DivideAndRoundUp(FullResViewSize.Y, DownsampledViewSize.Y));
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+
+/** Checks the scissor of synthetic boxes, in the view space of a 90 degree perspective over a 200x100 view, against hand computed rects. */
+static void ValidateMobileDownsampleTranslucencyScissor(const TArray<FString>& Args)
+{
+	using namespace MobileDownsampleTranslucencyScissor;
+
+	// The boxes are given in view space, X right, Y up and Z forward
+	const FIntPoint ViewSize(200, 100);
+	const FMatrix ViewProjectionMatrix = FReversedZPerspectiveMatrix(PI / 4.0f, ViewSize.X, ViewSize.Y, 10.0f);
+	const FVector Extent(10.0f, 10.0f, 10.0f);
+	const FBoxSphereBounds Centered(FVector(0.0f, 0.0f, 100.0f), Extent, Extent.Size());
+
+	struct FCase
+	{
+		const TCHAR* Name;
+		TArray<FBoxSphereBounds> Bounds;
+		int32 Padding;
+		FIntRect Expected;
+	};
+	const FCase Cases[] =
+	{
+		{ TEXT("No primitive"), {}, 4, FIntRect() },
+		{ TEXT("Centered box"), { Centered }, 0, FIntRect(88, 38, 112, 62) },
+		{ TEXT("Centered box, padded"), { Centered }, 4, FIntRect(84, 34, 116, 66) },
+		{ TEXT("Crossing the near plane"), { Centered, FBoxSphereBounds(FVector(0.0f, 0.0f, 5.0f), Extent, Extent.Size()) }, 4, FIntRect(FIntPoint::ZeroValue, ViewSize) },
+		{ TEXT("Left edge, padded and clamped"), { FBoxSphereBounds(FVector(-100.0f, 0.0f, 100.0f), Extent, Extent.Size()) }, 4, FIntRect(0, 34, 23, 66) },
+		{ TEXT("Top edge, padded and clamped"), { FBoxSphereBounds(FVector(0.0f, 40.0f, 100.0f), Extent, Extent.Size()) }, 4, FIntRect(84, 0, 116, 27) },
+		{ TEXT("Bottom right corner, padded and clamped"), { FBoxSphereBounds(FVector(100.0f, -40.0f, 100.0f), Extent, Extent.Size()) }, 4, FIntRect(177, 73, 200, 100) },
+	};
+
+	bool bAllPassed = true;
+	for (const FCase& Case : Cases)
+	{
+		const FIntRect Rect = ComputeViewRect(Case.Bounds, ViewProjectionMatrix, FVector::ZeroVector, ViewSize, Case.Padding);
+		const bool bPassed = Rect == Case.Expected;
+		bAllPassed &= bPassed;
+
+		UE_LOG(LogRenderer, Display, TEXT("Off-screen particle scissor %s %s: (%d, %d) - (%d, %d), expected (%d, %d) - (%d, %d)"),
+			Case.Name, bPassed ? TEXT("PASSED") : TEXT("FAILED"),
+			Rect.Min.X, Rect.Min.Y, Rect.Max.X, Rect.Max.Y,
+			Case.Expected.Min.X, Case.Expected.Min.Y, Case.Expected.Max.X, Case.Expected.Max.Y);
+	}
+
+	// Off screen boxes clip to an empty rect, wherever its corner lands
+	{
+		const FBoxSphereBounds OffScreen(FVector(1000.0f, 0.0f, 100.0f), Extent, Extent.Size());
+		const FIntRect Rect = ComputeViewRect(MakeArrayView(&OffScreen, 1), ViewProjectionMatrix, FVector::ZeroVector, ViewSize, 4);
+		const bool bPassed = Rect.Area() == 0;
+		bAllPassed &= bPassed;
+
+		UE_LOG(LogRenderer, Display, TEXT("Off-screen particle scissor Off screen box %s: area %d"), bPassed ? TEXT("PASSED") : TEXT("FAILED"), Rect.Area());
+	}
+
+	struct FDownsampledCase
+	{
+		const TCHAR* Name;
+		FIntRect FullResRect;
+		FIntPoint DownsampledViewSize;
+		FIntRect Expected;
+		int32 ExpectedPadding;
+	};
+	const FDownsampledCase DownsampledCases[] =
+	{
+		{ TEXT("Empty"), FIntRect(), FIntPoint(100, 50), FIntRect(), 2 },
+		{ TEXT("Half scale"), FIntRect(88, 38, 112, 62), FIntPoint(100, 50), FIntRect(43, 18, 57, 32), 2 },
+		// 0.375 maps 88 and 112 exactly to 33 and 42, 0.38 maps 38 and 62 to 14.44 and 23.56, which are floored and ceiled, then grown by one texel
+		{ TEXT("Fractional scale"), FIntRect(88, 38, 112, 62), FIntPoint(75, 38), FIntRect(32, 13, 43, 25), 3 },
+		{ TEXT("Whole view, clamped"), FIntRect(FIntPoint::ZeroValue, ViewSize), FIntPoint(75, 38), FIntRect(0, 0, 75, 38), 3 },
+		{ TEXT("Full scale"), FIntRect(88, 38, 112, 62), ViewSize, FIntRect(87, 37, 113, 63), 1 },
+	};
+
+	for (const FDownsampledCase& Case : DownsampledCases)
+	{
+		const FIntRect Rect = GetDownsampledRect(Case.FullResRect, ViewSize, Case.DownsampledViewSize);
+		const int32 Padding = GetUpsamplePadding(ViewSize, Case.DownsampledViewSize);
+		const bool bPassed = Rect == Case.Expected && Padding == Case.ExpectedPadding;
+		bAllPassed &= bPassed;
+
+		UE_LOG(LogRenderer, Display, TEXT("Off-screen particle downsampled scissor %s %s: (%d, %d) - (%d, %d) padding %d, expected (%d, %d) - (%d, %d) padding %d"),
+			Case.Name, bPassed ? TEXT("PASSED") : TEXT("FAILED"),
+			Rect.Min.X, Rect.Min.Y, Rect.Max.X, Rect.Max.Y, Padding,
+			Case.Expected.Min.X, Case.Expected.Min.Y, Case.Expected.Max.X, Case.Expected.Max.Y, Case.ExpectedPadding);
+	}
+
+	UE_LOG(LogRenderer, Display, TEXT("Off-screen particle scissor %s"), bAllPassed ? TEXT("PASSED") : TEXT("FAILED"));
+}
+
+static FAutoConsoleCommand GValidateMobileDownsampleTranslucencyScissor(
+	TEXT("r.Mobile.OffScreenParticles.ValidateScissor"),
+	TEXT("Checks the scissor rects of the mobile off-screen particles for synthetic boxes: near plane fallback, empty and off screen input,\n")
+	TEXT("padding and clamping at the view edges, and the low res rect and upsample padding at integer and fractional scales."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&ValidateMobileDownsampleTranslucencyScissor));
+
+#endif // !UE_BUILD_SHIPPING
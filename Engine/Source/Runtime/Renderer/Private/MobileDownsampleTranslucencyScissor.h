@@ -0,0 +1,45 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	MobileDownsampleTranslucencyScissor.h: Screen space bounds of the mobile
+	off-screen particles, used to scissor the downsample and the composite.
+=============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FPrimitiveBounds;
+
+namespace MobileDownsampleTranslucencyScissor
+{
+	/**
+	 * Union of the projected bounding boxes of PrimitiveIndices, in pixels of a view of ViewSize with the origin at its top left.
+	 * The result is grown by Padding pixels and clipped to the view, it is empty if no primitive is given or all of them are off screen.
+	 * A box crossing the near plane has no meaningful projection, the whole view is returned for it.
+	 */
+	FIntRect ComputeViewRect(
+		const TArray<FPrimitiveBounds>& PrimitiveBounds,
+		TArrayView<const int32> PrimitiveIndices,
+		const FMatrix& TranslatedViewProjectionMatrix,
+		const FVector& PreViewTranslation,
+		FIntPoint ViewSize,
+		int32 Padding);
+
+	/** Same as ComputeViewRect for a set of world space boxes, doesn't need a scene. */
+	FIntRect ComputeViewRect(
+		TArrayView<const FBoxSphereBounds> Bounds,
+		const FMatrix& TranslatedViewProjectionMatrix,
+		const FVector& PreViewTranslation,
+		FIntPoint ViewSize,
+		int32 Padding);
+
+	/**
+	 * Low res texels covering FullResRect, grown by one texel so the bilinear footprint of every full res pixel in FullResRect lies inside it.
+	 * Both rects are relative to their view.
+	 */
+	FIntRect GetDownsampledRect(const FIntRect& FullResRect, FIntPoint FullResViewSize, FIntPoint DownsampledViewSize);
+
+	/** Full res pixels the bilinear upsample spreads one low res texel over, the padding to apply to ComputeViewRect. */
+	int32 GetUpsamplePadding(FIntPoint FullResViewSize, FIntPoint DownsampledViewSize);
+}
@@ -322,6 +322,8 @@ void FMobileSceneRenderer::InitViews(FRHICommandListImmediate& RHICmdList)
 
 	SetupMobileBasePassAfterShadowInit(BasePassDepthStencilAccess, ViewCommandsPerView);
 
+	InitDownsampleTranslucencyScales(RHICmdList);
+
 	// if we kicked off ILC update via task, wait and finalize.
 	if (ILCTaskData.TaskRef.IsValid())
 	{
@@ -558,9 +560,24 @@ void FMobileSceneRenderer::Render(FRHICommandListImmediate& RHICmdList)
 		
 	//YJH Created 2020-7-19
 	//Whether to RenderDownSample Translucency
-	bool bShouldRenderDownSampleTranslucency = CVarMobileSeparateTranslucency.GetValueOnAnyThread() > 0 && !bKeepDepthContent && View.ParallelMeshDrawCommandPasses[EMeshPass::TranslucencyDownSampleSeparate].HasAnyDraw();
+	bool bShouldRenderDownSampleTranslucency = CVarMobileSeparateTranslucency.GetValueOnAnyThread() > 0 && !bKeepDepthContent && HasDownsampledTranslucencyDraws(View);
 	//YJH End
 
+	// Scene color can only be stored after opaque and reloaded when it is not the back buffer.
+	// The reprojection history is downsampled from scene depth, which must then be stored single sampled.
+	const bool bCanSplitSceneColorPass = !bGammaSpace || bRenderToSceneColor;
+	const bool bCanStoreSceneDepth = bCanSplitSceneColorPass && SceneContext.GetSceneColorSurface()->GetNumSamples() == 1;
+	// The Adreno occlusion queries and the on chip MSAA pre-tonemap are drawn in the scene color pass after translucency
+	const bool bAdrenoOcclusionMode = CVarMobileAdrenoOcclusionMode.GetValueOnRenderThread() != 0;
+	const bool bCanEndSceneColorPass = !bAdrenoOcclusionMode && (bGammaSpace || SceneContext.GetSceneColorSurface()->GetNumSamples() == 1);
+	const EDownSampleTranslucencyMode DownSampleTranslucencyMode = bShouldRenderDownSampleTranslucency && ViewFamily.EngineShowFlags.Translucency
+		? GetDownSampleTranslucencyMode(bCanSplitSceneColorPass, bRequiresTranslucencyPass, bCanStoreSceneDepth, bCanEndSceneColorPass)
+		: EDownSampleTranslucencyMode::None;
+	const bool bUpdateDownsampledTranslucencyDepthHistory = bShouldRenderDownSampleTranslucency && ShouldUpdateDownsampledTranslucencyDepthHistory(bCanStoreSceneDepth);
+
+	// The off-screen particles only take the break between opaque and translucency when the platform already has it, see GetDownSampleTranslucencyMode
+	const bool bSplitTranslucencyPass = bRequiresTranslucencyPass;
+
 	FRHITexture* SceneColor = nullptr;
 	FRHITexture* SceneColorResolve = nullptr;
 	FRHITexture* SceneDepth = nullptr;
@@ -585,6 +602,12 @@ void FMobileSceneRenderer::Render(FRHICommandListImmediate& RHICmdList)
 			RHICmdList.TransitionResource(EResourceTransitionAccess::EWritable, SceneColor);
 		}
 		SceneDepth = (View.bIsMobileMultiViewEnabled) ? SceneContext.MobileMultiViewSceneDepthZ->GetRenderTargetItem().TargetableTexture : static_cast<FTextureRHIRef>(SceneContext.GetSceneDepthSurface());
+
+		if (DownSampleTranslucencyMode == EDownSampleTranslucencyMode::MultiView)
+		{
+			// Both eyes' depth is downsampled and read by the composite once the pass is ended after translucency
+			DepthTargetAction = EDepthStencilTargetActions::ClearDepthStencil_StoreDepthStencil;
+		}
 	}
 	else
 	{
@@ -593,16 +616,16 @@ void FMobileSceneRenderer::Render(FRHICommandListImmediate& RHICmdList)
 		ColorTargetAction = bMobileMSAA ? ERenderTargetActions::Clear_Resolve : ERenderTargetActions::Clear_Store;
 		SceneDepth = SceneContext.GetSceneDepthSurface();
 				
-		if (bRequiresTranslucencyPass)
+		if (bSplitTranslucencyPass)
 		{	
 			// store targets after opaque so translucency render pass can be restarted
 			ColorTargetAction = ERenderTargetActions::Clear_Store;
 			DepthTargetAction = EDepthStencilTargetActions::ClearDepthStencil_StoreDepthStencil;
 		}
 						
-		if (bKeepDepthContent && !bMobileMSAA)
+		if ((bKeepDepthContent || bUpdateDownsampledTranslucencyDepthHistory) && !bMobileMSAA)
 		{
-			// store depth if post-processing/capture needs it
+			// store depth if post-processing/capture or the off-screen particle depth history needs it
 			DepthTargetAction = EDepthStencilTargetActions::ClearDepthStencil_StoreDepthStencil;
 		}
 	}
@@ -635,6 +658,15 @@ void FMobileSceneRenderer::Render(FRHICommandListImmediate& RHICmdList)
 		SceneContext.BindVirtualTextureFeedbackUAV(SceneColorRenderPassInfo);
 	}
 	
+	if (DownSampleTranslucencyMode == EDownSampleTranslucencyMode::ReprojectedDepth)
+	{
+		// Nothing of this frame is needed, so the low res pass goes first and the scene color pass is never broken
+		CSV_SCOPED_TIMING_STAT_EXCLUSIVE(RenderTranslucency);
+		SCOPE_CYCLE_COUNTER(STAT_TranslucencyDrawTime);
+		RenderTranslucency_DownSampleSeparate(RHICmdList, ViewList, true);
+	}
+
+	AccountRenderPassBandwidth(SceneColorRenderPassInfo);
 	RHICmdList.BeginRenderPass(SceneColorRenderPassInfo, TEXT("SceneColorRendering"));
 
 	RHICmdList.SetCurrentStat(GET_STATID(STAT_CLM_MobilePrePass));
@@ -661,7 +693,6 @@ void FMobileSceneRenderer::Render(FRHICommandListImmediate& RHICmdList)
 	}
 #endif // !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
 
-	const bool bAdrenoOcclusionMode = CVarMobileAdrenoOcclusionMode.GetValueOnRenderThread() != 0;
 	if (!bAdrenoOcclusionMode)
 	{
 	    // Issue occlusion queries
@@ -686,16 +717,23 @@ void FMobileSceneRenderer::Render(FRHICommandListImmediate& RHICmdList)
 	RHICmdList.NextSubpass();
 				
 	// Split if we need to render translucency in a separate render pass
-	if (bRequiresTranslucencyPass)
+	if (bSplitTranslucencyPass)
 	{
 		RHICmdList.EndRenderPass();
 	}
 
+	if (DownSampleTranslucencyMode == EDownSampleTranslucencyMode::CompositeInPass)
+	{
+		CSV_SCOPED_TIMING_STAT_EXCLUSIVE(RenderTranslucency);
+		SCOPE_CYCLE_COUNTER(STAT_TranslucencyDrawTime);
+		RenderTranslucency_DownSampleSeparate(RHICmdList, ViewList, false);
+	}
+
 	RHICmdList.SetCurrentStat(GET_STATID(STAT_CLMM_Translucency));
 
 		
 	// Restart translucency render pass if needed
-	if (bRequiresTranslucencyPass)
+	if (bSplitTranslucencyPass)
 	{
 		check(RHICmdList.IsOutsideRenderPass());
 
@@ -710,7 +748,7 @@ void FMobileSceneRenderer::Render(FRHICommandListImmediate& RHICmdList)
 			ExclusiveDepthStencil = FExclusiveDepthStencil::DepthRead_StencilWrite;
 		}
 		
-		if (bKeepDepthContent && !bMobileMSAA)
+		if ((bKeepDepthContent || bUpdateDownsampledTranslucencyDepthHistory) && !bMobileMSAA)
 		{
 			DepthTargetAction = EDepthStencilTargetActions::LoadDepthStencil_StoreDepthStencil;
 		}
@@ -727,6 +765,7 @@ void FMobileSceneRenderer::Render(FRHICommandListImmediate& RHICmdList)
 		);
 		TranslucentRenderPassInfo.NumOcclusionQueries = 0;
 		TranslucentRenderPassInfo.bOcclusionQueries = false;
+		AccountRenderPassBandwidth(TranslucentRenderPassInfo);
 		RHICmdList.BeginRenderPass(TranslucentRenderPassInfo, TEXT("SceneColorTranslucencyRendering"));
 	}
 
@@ -751,7 +790,7 @@ void FMobileSceneRenderer::Render(FRHICommandListImmediate& RHICmdList)
 	{
 		CSV_SCOPED_TIMING_STAT_EXCLUSIVE(RenderTranslucency);
 		SCOPE_CYCLE_COUNTER(STAT_TranslucencyDrawTime);
-		RenderTranslucency(RHICmdList, ViewList, !bGammaSpace || bRenderToSceneColor, bShouldRenderDownSampleTranslucency);
+		RenderTranslucency(RHICmdList, ViewList, !bGammaSpace || bRenderToSceneColor, DownSampleTranslucencyMode);
 		FRHICommandListExecutor::GetImmediateCommandList().PollOcclusionQueries();
 		RHICmdList.ImmediateFlush(EImmediateFlushType::DispatchToRHIThread);
 	}
@@ -767,14 +806,23 @@ void FMobileSceneRenderer::Render(FRHICommandListImmediate& RHICmdList)
 	    RHICmdList.ImmediateFlush(EImmediateFlushType::DispatchToRHIThread);
 	}
 
-	// Pre-tonemap before MSAA resolve (iOS only)
-	if (!bGammaSpace)
+	// The off-screen particle render graph already ended scene color rendering, it is single sampled
+	if (DownSampleTranslucencyMode != EDownSampleTranslucencyMode::RenderGraph)
+	{
+		// Pre-tonemap before MSAA resolve (iOS only)
+		if (!bGammaSpace)
+		{
+			PreTonemapMSAA(RHICmdList);
+		}
+
+		// End of scene color rendering
+		RHICmdList.EndRenderPass();
+	}
+
+	if (bUpdateDownsampledTranslucencyDepthHistory)
 	{
-		PreTonemapMSAA(RHICmdList);
+		UpdateDownsampledTranslucencyDepthHistory(RHICmdList);
 	}
-	
-	// End of scene color rendering
-	RHICmdList.EndRenderPass();
 
 	if (Scene->FXSystem && Views.IsValidIndex(0))
 	{
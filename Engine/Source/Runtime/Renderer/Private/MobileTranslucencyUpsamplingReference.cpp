@@ -0,0 +1,812 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	MobileTranslucencyUpsamplingReference.cpp: CPU reference of the mobile
+	off-screen particle depth downsample and nearest-depth upsample.
+=============================================================================*/
+
+#include "MobileTranslucencyUpsamplingReference.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Math/RandomStream.h"
+#include "Misc/Paths.h"
+#include "RendererModule.h"
+#include "RHI.h"
+
+namespace MobileTranslucencyUpsampling
+{
+
+float ConvertFromDeviceZ(float DeviceZ, const FVector4& InvDeviceZToWorldZTransform)
+{
+	return FMath::Min(1.0f / (DeviceZ * InvDeviceZToWorldZTransform[2] - InvDeviceZToWorldZTransform[3]), MaxOperationDepth);
+}
+
+float ConvertToDeviceZ(float SceneDepth, const FVector4& InvDeviceZToWorldZTransform)
+{
+	return 1.f / ((SceneDepth + InvDeviceZToWorldZTransform[3]) * InvDeviceZToWorldZTransform[2]);
+}
+
+void DownsampleDepth(const FColorImage& FullResSceneColor, const FVector4& InvDeviceZToWorldZTransform, FIntPoint LowResViewSize, FDepthImage& OutLowResDepth)
+{
+	OutLowResDepth.Init(LowResViewSize);
+
+	const float DownsampleFactorX = float(FullResSceneColor.Size.X) / LowResViewSize.X;
+	const float DownsampleFactorY = float(FullResSceneColor.Size.Y) / LowResViewSize.Y;
+
+	for (int32 Y = 0; Y < LowResViewSize.Y; ++Y)
+	{
+		for (int32 X = 0; X < LowResViewSize.X; ++X)
+		{
+			// const uint2 PixelCoord = GetFullResPixelCoord(Position.xy, 0), with both view mins at the origin
+			const float SceneDepth = FullResSceneColor.Load(FMath::FloorToInt(X * DownsampleFactorX), FMath::FloorToInt(Y * DownsampleFactorY)).A;
+			OutLowResDepth.Texels[Y * LowResViewSize.X + X] = ConvertToDeviceZ(SceneDepth, InvDeviceZToWorldZTransform);
+		}
+	}
+}
+
+void DownsampleDepthMinMax(const FColorImage& FullResSceneColor, const FVector4& InvDeviceZToWorldZTransform, FIntPoint LowResViewSize, FDepthImage& OutClosestDepth, FDepthImage& OutFarthestDepth, FDepthImage& OutLowResDepth)
+{
+	OutClosestDepth.Init(LowResViewSize);
+	OutFarthestDepth.Init(LowResViewSize);
+	OutLowResDepth.Init(LowResViewSize);
+
+	const float DownsampleFactorX = float(FullResSceneColor.Size.X) / LowResViewSize.X;
+	const float DownsampleFactorY = float(FullResSceneColor.Size.Y) / LowResViewSize.Y;
+
+	for (int32 Y = 0; Y < LowResViewSize.Y; ++Y)
+	{
+		for (int32 X = 0; X < LowResViewSize.X; ++X)
+		{
+			const FIntPoint BlockStart(FMath::FloorToInt(X * DownsampleFactorX), FMath::FloorToInt(Y * DownsampleFactorY));
+			const FIntPoint BlockEnd(
+				FMath::Max(FMath::FloorToInt((X + 1) * DownsampleFactorX), BlockStart.X + 1),
+				FMath::Max(FMath::FloorToInt((Y + 1) * DownsampleFactorY), BlockStart.Y + 1));
+
+			// Blocks of the 3x3 texels around this one, clamped to the view
+			const FIntPoint DilatedStart(
+				FMath::Min(FMath::Max(FMath::FloorToInt((X - 1) * DownsampleFactorX), 0), BlockStart.X),
+				FMath::Min(FMath::Max(FMath::FloorToInt((Y - 1) * DownsampleFactorY), 0), BlockStart.Y));
+			const FIntPoint DilatedEnd(
+				FMath::Max(FMath::Min(FMath::FloorToInt((X + 2) * DownsampleFactorX), FullResSceneColor.Size.X), BlockEnd.X),
+				FMath::Max(FMath::Min(FMath::FloorToInt((Y + 2) * DownsampleFactorY), FullResSceneColor.Size.Y), BlockEnd.Y));
+
+			float ClosestDepth = MaxOperationDepth;
+			float FarthestDepth = 0.f;
+			float DilatedClosestDepth = MaxOperationDepth;
+			float DilatedFarthestDepth = 0.f;
+			for (int32 BlockY = DilatedStart.Y; BlockY < DilatedEnd.Y; ++BlockY)
+			{
+				for (int32 BlockX = DilatedStart.X; BlockX < DilatedEnd.X; ++BlockX)
+				{
+					const float SceneDepth = FMath::Min(FullResSceneColor.Load(BlockX, BlockY).A, MaxOperationDepth);
+					DilatedClosestDepth = FMath::Min(DilatedClosestDepth, SceneDepth);
+					DilatedFarthestDepth = FMath::Max(DilatedFarthestDepth, SceneDepth);
+
+					if (BlockX >= BlockStart.X && BlockY >= BlockStart.Y && BlockX < BlockEnd.X && BlockY < BlockEnd.Y)
+					{
+						ClosestDepth = FMath::Min(ClosestDepth, SceneDepth);
+						FarthestDepth = FMath::Max(FarthestDepth, SceneDepth);
+					}
+				}
+			}
+
+			// Edge texels keep their farthest depth negated
+			const bool bInterior = DilatedFarthestDepth - DilatedClosestDepth < RelativeDepthThreshold * DilatedClosestDepth;
+
+			const int32 Index = Y * LowResViewSize.X + X;
+			OutClosestDepth.Texels[Index] = ClosestDepth;
+			OutFarthestDepth.Texels[Index] = bInterior ? FarthestDepth : -FarthestDepth;
+			OutLowResDepth.Texels[Index] = ConvertToDeviceZ(ClosestDepth, InvDeviceZToWorldZTransform);
+		}
+	}
+}
+
+/** Maps float4(ScreenPos * SceneDepth, SceneDepth, 1) to clip space of the same projection, see ScreenToWorld in the view uniform buffer. */
+static FMatrix MakeScreenToClip(const FMatrix& ProjectionMatrix)
+{
+	return FMatrix(
+		FPlane(1, 0, 0, 0),
+		FPlane(0, 1, 0, 0),
+		FPlane(0, 0, ProjectionMatrix.M[2][2], 1),
+		FPlane(0, 0, ProjectionMatrix.M[3][2], 0));
+}
+
+FReprojectionMatrices MakeReprojectionMatrices(
+	const FMatrix& ProjectionMatrix, const FMatrix& InvProjectionMatrix, const FMatrix& TranslatedViewMatrix, const FVector& PreViewTranslation,
+	const FMatrix& PrevProjectionMatrix, const FMatrix& PrevInvProjectionMatrix, const FMatrix& PrevTranslatedViewMatrix, const FVector& PrevPreViewTranslation)
+{
+	// Translated view matrices are pure rotations, their transpose is their inverse
+	const FVector DeltaTranslation = PrevPreViewTranslation - PreViewTranslation;
+	const FMatrix InvViewProj = InvProjectionMatrix * TranslatedViewMatrix.GetTransposed();
+	const FMatrix PrevInvViewProj = PrevInvProjectionMatrix * PrevTranslatedViewMatrix.GetTransposed();
+	const FMatrix ViewProjFromPrev = FTranslationMatrix(-DeltaTranslation) * TranslatedViewMatrix * ProjectionMatrix;
+	const FMatrix PrevViewProj = FTranslationMatrix(DeltaTranslation) * PrevTranslatedViewMatrix * PrevProjectionMatrix;
+
+	FReprojectionMatrices Matrices;
+	Matrices.CurrentScreenToPrevClip = MakeScreenToClip(ProjectionMatrix) * InvViewProj * PrevViewProj;
+	Matrices.PrevScreenToCurrentClip = MakeScreenToClip(PrevProjectionMatrix) * PrevInvViewProj * ViewProjFromPrev;
+	return Matrices;
+}
+
+void DownsampleDepthHistory(const FDepthImage& FullResDepth, const FVector4& InvDeviceZToWorldZTransform, FIntPoint LowResViewSize, FDepthImage& OutLowResLinearDepth)
+{
+	OutLowResLinearDepth.Init(LowResViewSize);
+
+	const float DownsampleFactorX = float(FullResDepth.Size.X) / LowResViewSize.X;
+	const float DownsampleFactorY = float(FullResDepth.Size.Y) / LowResViewSize.Y;
+
+	for (int32 Y = 0; Y < LowResViewSize.Y; ++Y)
+	{
+		for (int32 X = 0; X < LowResViewSize.X; ++X)
+		{
+			const float DeviceZ = FullResDepth.Load(FMath::FloorToInt(X * DownsampleFactorX), FMath::FloorToInt(Y * DownsampleFactorY));
+			OutLowResLinearDepth.Texels[Y * LowResViewSize.X + X] = ConvertFromDeviceZ(DeviceZ, InvDeviceZToWorldZTransform);
+		}
+	}
+}
+
+void ReprojectDepth(const FDepthImage& PrevLowResLinearDepth, const FReprojectionMatrices& Matrices, const FVector4& InvDeviceZToWorldZTransform, FIntPoint LowResViewSize, FDepthImage& OutLowResDepth, TArray<bool>* OutIsDisoccluded)
+{
+	const int32 NumIterations = 2;
+
+	// SLPrevScreenPosToTexel
+	const FVector2D PrevViewSize(PrevLowResLinearDepth.Size.X, PrevLowResLinearDepth.Size.Y);
+	const FVector2D PrevScreenPosToTexelScale(0.5f * PrevViewSize.X, -0.5f * PrevViewSize.Y);
+	const FVector2D PrevScreenPosToTexelBias(0.5f * PrevViewSize.X, 0.5f * PrevViewSize.Y);
+
+	const auto LoadPrevLowResDepth = [&](FVector2D PrevTexel)
+	{
+		return PrevLowResLinearDepth.Load(FMath::FloorToInt(PrevTexel.X), FMath::FloorToInt(PrevTexel.Y));
+	};
+
+	OutLowResDepth.Init(LowResViewSize);
+	if (OutIsDisoccluded)
+	{
+		OutIsDisoccluded->Init(false, LowResViewSize.X * LowResViewSize.Y);
+	}
+
+	for (int32 Y = 0; Y < LowResViewSize.Y; ++Y)
+	{
+		for (int32 X = 0; X < LowResViewSize.X; ++X)
+		{
+			const FVector2D ScreenPos((X + 0.5f) / LowResViewSize.X * 2.f - 1.f, (Y + 0.5f) / LowResViewSize.Y * -2.f + 1.f);
+
+			float SceneDepth = LoadPrevLowResDepth(ScreenPos * PrevScreenPosToTexelScale + PrevScreenPosToTexelBias);
+			FVector2D PrevScreenPos = ScreenPos;
+			FVector2D RoundTripScreenPos = ScreenPos;
+
+			for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+			{
+				const FVector4 PrevClip = Matrices.CurrentScreenToPrevClip.TransformFVector4(FVector4(ScreenPos.X * SceneDepth, ScreenPos.Y * SceneDepth, SceneDepth, 1.f));
+				PrevScreenPos = FVector2D(PrevClip.X / PrevClip.W, PrevClip.Y / PrevClip.W);
+
+				const float PrevSceneDepth = LoadPrevLowResDepth(PrevScreenPos * PrevScreenPosToTexelScale + PrevScreenPosToTexelBias);
+				const FVector4 CurrentClip = Matrices.PrevScreenToCurrentClip.TransformFVector4(FVector4(PrevScreenPos.X * PrevSceneDepth, PrevScreenPos.Y * PrevSceneDepth, PrevSceneDepth, 1.f));
+				RoundTripScreenPos = FVector2D(CurrentClip.X / CurrentClip.W, CurrentClip.Y / CurrentClip.W);
+				SceneDepth = CurrentClip.W;
+			}
+
+			// Disocclusion fallback, see ReprojectMain
+			const FVector2D RoundTripTexelError(
+				FMath::Abs(RoundTripScreenPos.X - ScreenPos.X) * LowResViewSize.X * 0.5f,
+				FMath::Abs(RoundTripScreenPos.Y - ScreenPos.Y) * LowResViewSize.Y * 0.5f);
+			const bool bDisoccluded = FMath::Abs(PrevScreenPos.X) > 1.f || FMath::Abs(PrevScreenPos.Y) > 1.f
+				|| RoundTripTexelError.X > 1.f || RoundTripTexelError.Y > 1.f || SceneDepth <= 0.f;
+			if (bDisoccluded)
+			{
+				const FVector2D Texel = PrevScreenPos * PrevScreenPosToTexelScale + PrevScreenPosToTexelBias - FVector2D(0.5f, 0.5f);
+				SceneDepth = FMath::Max(
+					FMath::Max(LoadPrevLowResDepth(Texel), LoadPrevLowResDepth(Texel + FVector2D(1.f, 0.f))),
+					FMath::Max(LoadPrevLowResDepth(Texel + FVector2D(0.f, 1.f)), LoadPrevLowResDepth(Texel + FVector2D(1.f, 1.f))));
+			}
+
+			const int32 Index = Y * LowResViewSize.X + X;
+			OutLowResDepth.Texels[Index] = ConvertToDeviceZ(FMath::Min(SceneDepth, MaxOperationDepth), InvDeviceZToWorldZTransform);
+			if (OutIsDisoccluded)
+			{
+				(*OutIsDisoccluded)[Index] = bDisoccluded;
+			}
+		}
+	}
+}
+
+void NearestDepthNeighborUpsample(const FUpsampleInputs& Inputs, FColorImage& OutColor, TArray<bool>* OutIsEdgePixel)
+{
+	check(Inputs.LowResColor && Inputs.LowResDepth && Inputs.FullResDepth);
+	check(Inputs.LowResColor->Size == Inputs.LowResDepth->Size);
+
+	const FColorImage& LowResColor = *Inputs.LowResColor;
+	const FDepthImage& LowResDepth = *Inputs.LowResDepth;
+	const FDepthImage& FullResDepth = *Inputs.FullResDepth;
+	const FIntPoint FullResViewSize = Inputs.FullResViewSize;
+	const FVector2D LowResTextureSize(LowResColor.Size.X, LowResColor.Size.Y);
+
+	// Matches the DrawRectangle UV setup in FMobileSceneRenderer::UpsampleTranslucency.
+	const FVector2D UVScale(
+		float(Inputs.LowResViewSize.X) / (float(FullResViewSize.X) * LowResTextureSize.X),
+		float(Inputs.LowResViewSize.Y) / (float(FullResViewSize.Y) * LowResTextureSize.Y));
+
+	const VectorRegister DeviceZScale = VectorSetFloat1(Inputs.InvDeviceZToWorldZTransform[2]);
+	const VectorRegister DeviceZBias = VectorSetFloat1(Inputs.InvDeviceZToWorldZTransform[3]);
+	const VectorRegister MaxDepth = VectorSetFloat1(MaxOperationDepth);
+	const VectorRegister Threshold = VectorSetFloat1(RelativeDepthThreshold);
+
+	OutColor.Init(FullResViewSize);
+	if (OutIsEdgePixel)
+	{
+		OutIsEdgePixel->Init(false, FullResViewSize.X * FullResViewSize.Y);
+	}
+
+	for (int32 Y = 0; Y < FullResViewSize.Y; ++Y)
+	{
+		for (int32 X = 0; X < FullResViewSize.X; ++X)
+		{
+			const FVector2D UV((X + 0.5f) * UVScale.X, (Y + 0.5f) * UVScale.Y);
+
+			// Footprint of GatherRed / bilinear filtering, clamped addressing.
+			const float TexelX = UV.X * LowResTextureSize.X - 0.5f;
+			const float TexelY = UV.Y * LowResTextureSize.Y - 0.5f;
+			const int32 X0 = FMath::FloorToInt(TexelX);
+			const int32 Y0 = FMath::FloorToInt(TexelY);
+			const float FracX = TexelX - X0;
+			const float FracY = TexelY - Y0;
+
+			FLinearColor& Result = OutColor.Texels[Y * FullResViewSize.X + X];
+
+			const auto BilinearSample = [&]()
+			{
+				const VectorRegister C00 = VectorLoad(&LowResColor.Load(X0, Y0).R);
+				const VectorRegister C10 = VectorLoad(&LowResColor.Load(X0 + 1, Y0).R);
+				const VectorRegister C01 = VectorLoad(&LowResColor.Load(X0, Y0 + 1).R);
+				const VectorRegister C11 = VectorLoad(&LowResColor.Load(X0 + 1, Y0 + 1).R);
+
+				const VectorRegister WeightX = VectorSetFloat1(FracX);
+				const VectorRegister Top = VectorMultiplyAdd(VectorSubtract(C10, C00), WeightX, C00);
+				const VectorRegister Bottom = VectorMultiplyAdd(VectorSubtract(C11, C01), WeightX, C01);
+				VectorStore(VectorMultiplyAdd(VectorSubtract(Bottom, Top), VectorSetFloat1(FracY), Top), &Result.R);
+			};
+
+			// MOBILE_TRANSLUCENCY_UPSAMPLE_MINMAX: the texel under UV was classified by the min/max downsample, see IsInteriorPixel
+			if (Inputs.LowResFarthestDepth)
+			{
+				if (Inputs.LowResFarthestDepth->Load(FMath::FloorToInt(UV.X * LowResTextureSize.X), FMath::FloorToInt(UV.Y * LowResTextureSize.Y)) > 0.f)
+				{
+					BilinearSample();
+					continue;
+				}
+			}
+
+			// GatherRed component order: x = (0, 1), y = (1, 1), z = (1, 0), w = (0, 0)
+			const VectorRegister LowResDeviceZ = MakeVectorRegister(
+				LowResDepth.Load(X0, Y0 + 1),
+				LowResDepth.Load(X0 + 1, Y0 + 1),
+				LowResDepth.Load(X0 + 1, Y0),
+				LowResDepth.Load(X0, Y0));
+
+			const VectorRegister LowResSceneDepth = VectorMin(VectorReciprocalAccurate(VectorSubtract(VectorMultiply(LowResDeviceZ, DeviceZScale), DeviceZBias)), MaxDepth);
+
+			const float FullResSceneDepth = ConvertFromDeviceZ(FullResDepth.Load(X, Y), Inputs.InvDeviceZToWorldZTransform);
+			const VectorRegister FullResSceneDepthVec = VectorSetFloat1(FullResSceneDepth);
+			const VectorRegister DepthDelta = VectorAbs(VectorSubtract(LowResSceneDepth, FullResSceneDepthVec));
+
+			// Search for the low res neighbor whose depth is closest to the full res depth, same visiting order as the shader
+			MS_ALIGN(16) float DepthDeltas[4] GCC_ALIGN(16);
+			VectorStoreAligned(DepthDelta, DepthDeltas);
+
+			float MinDist = 1.e8f;
+			FIntPoint NearestTexel(X0, Y0);
+			const FIntPoint Candidates[4] = { FIntPoint(X0, Y0), FIntPoint(X0 + 1, Y0), FIntPoint(X0, Y0 + 1), FIntPoint(X0 + 1, Y0 + 1) };
+			const int32 CandidateComponents[4] = { 3, 2, 0, 1 };
+			for (int32 CandidateIndex = 0; CandidateIndex < 4; ++CandidateIndex)
+			{
+				const float Delta = DepthDeltas[CandidateComponents[CandidateIndex]];
+				if (Delta < MinDist)
+				{
+					MinDist = Delta;
+					NearestTexel = Candidates[CandidateIndex];
+				}
+			}
+
+			const VectorRegister RelativeDelta = VectorMultiply(DepthDelta, VectorSetFloat1(1.0f / FullResSceneDepth));
+			const bool bAllNeighborsClose = VectorMaskBits(VectorCompareGT(Threshold, RelativeDelta)) == 0xF;
+
+			if (bAllNeighborsClose)
+			{
+				BilinearSample();
+			}
+			else
+			{
+				Result = LowResColor.Load(NearestTexel.X, NearestTexel.Y);
+				if (OutIsEdgePixel)
+				{
+					(*OutIsEdgePixel)[Y * FullResViewSize.X + X] = true;
+				}
+			}
+		}
+	}
+}
+
+void Composite(const FColorImage& UpsampledColor, FColorImage& InOutSceneColor)
+{
+	check(UpsampledColor.Size == InOutSceneColor.Size);
+
+	for (int32 Index = 0; Index < InOutSceneColor.Texels.Num(); ++Index)
+	{
+		const FLinearColor& Src = UpsampledColor.Texels[Index];
+		FLinearColor& Dest = InOutSceneColor.Texels[Index];
+
+		// CW_RGB: alpha keeps the scene depth
+		Dest.R = Src.R + Dest.R * Src.A;
+		Dest.G = Src.G + Dest.G * Src.A;
+		Dest.B = Src.B + Dest.B * Src.A;
+	}
+}
+
+bool HasParticleContribution(const FLinearColor& LowResColor)
+{
+	return LowResColor.R > 0.f || LowResColor.G > 0.f || LowResColor.B > 0.f || LowResColor.A < 1.f;
+}
+
+void ClassifyUpsampleTiles(const FColorImage& LowResColor, const FIntRect& LowResRect, TArray<FIntPoint>& OutTiles)
+{
+	OutTiles.Reset();
+
+	for (int32 TileY = LowResRect.Min.Y; TileY < LowResRect.Max.Y; TileY += UpsampleTileSize)
+	{
+		for (int32 TileX = LowResRect.Min.X; TileX < LowResRect.Max.X; TileX += UpsampleTileSize)
+		{
+			// The bilinear footprint of the tile's full res pixels reaches one texel into the neighbor tiles
+			const FIntRect DilatedTile(
+				FMath::Max(TileX - 1, LowResRect.Min.X),
+				FMath::Max(TileY - 1, LowResRect.Min.Y),
+				FMath::Min(TileX + UpsampleTileSize + 1, LowResRect.Max.X),
+				FMath::Min(TileY + UpsampleTileSize + 1, LowResRect.Max.Y));
+
+			bool bHasContribution = false;
+			for (int32 Y = DilatedTile.Min.Y; Y < DilatedTile.Max.Y && !bHasContribution; ++Y)
+			{
+				for (int32 X = DilatedTile.Min.X; X < DilatedTile.Max.X && !bHasContribution; ++X)
+				{
+					bHasContribution = HasParticleContribution(LowResColor.Load(X, Y));
+				}
+			}
+
+			if (bHasContribution)
+			{
+				OutTiles.Add(FIntPoint(TileX, TileY));
+			}
+		}
+	}
+}
+
+void RasterizeUpsampleTiles(TArrayView<const FIntPoint> Tiles, FIntPoint LowResViewSize, FIntPoint FullResViewSize, TArray<bool>& OutIsCovered)
+{
+	OutIsCovered.Init(false, FullResViewSize.X * FullResViewSize.Y);
+
+	const FVector2D FullResPerLowRes(float(FullResViewSize.X) / LowResViewSize.X, float(FullResViewSize.Y) / LowResViewSize.Y);
+	for (const FIntPoint& Tile : Tiles)
+	{
+		const FIntPoint TileMax = FIntPoint(Tile.X + UpsampleTileSize, Tile.Y + UpsampleTileSize).ComponentMin(LowResViewSize);
+
+		// Covered pixel centers: Min <= X + 0.5 < Max
+		const int32 MinX = FMath::CeilToInt(Tile.X * FullResPerLowRes.X - 0.5f);
+		const int32 MinY = FMath::CeilToInt(Tile.Y * FullResPerLowRes.Y - 0.5f);
+		const int32 MaxX = FMath::Min(FMath::CeilToInt(TileMax.X * FullResPerLowRes.X - 0.5f), FullResViewSize.X);
+		const int32 MaxY = FMath::Min(FMath::CeilToInt(TileMax.Y * FullResPerLowRes.Y - 0.5f), FullResViewSize.Y);
+
+		for (int32 Y = FMath::Max(MinY, 0); Y < MaxY; ++Y)
+		{
+			for (int32 X = FMath::Max(MinX, 0); X < MaxX; ++X)
+			{
+				OutIsCovered[Y * FullResViewSize.X + X] = true;
+			}
+		}
+	}
+}
+
+static float StoreUNorm8(float Value)
+{
+	return FMath::RoundToFloat(FMath::Clamp(Value, 0.f, 1.f) * 255.f) / 255.f;
+}
+
+/** Positive half float: 5 bit exponent and HalfMantissaBits bits of mantissa. */
+static constexpr int32 HalfMantissaBits = 10;
+
+static float StoreHalf(float Value)
+{
+	const float MaxValue = (2.f - FMath::Pow(2.f, -float(HalfMantissaBits))) * 32768.f;
+	Value = FMath::Clamp(Value, 0.f, MaxValue);
+	if (Value == 0.f)
+	{
+		return 0.f;
+	}
+
+	// Denormals below 2^-14 keep the step of the smallest exponent
+	const int32 Exponent = FMath::Max(FMath::FloorToInt(FMath::Log2(Value)), -14);
+	const float Step = FMath::Pow(2.f, float(Exponent - HalfMantissaBits));
+	return FMath::Min(FMath::RoundToFloat(Value / Step) * Step, MaxValue);
+}
+
+FLinearColor StoreColor(const FLinearColor& Texel, EMobileDownsampleTranslucencyColorFormat Format)
+{
+	if (Format == EMobileDownsampleTranslucencyColorFormat::RGBA8)
+	{
+		return FLinearColor(StoreUNorm8(Texel.R), StoreUNorm8(Texel.G), StoreUNorm8(Texel.B), StoreUNorm8(Texel.A));
+	}
+
+	return FLinearColor(StoreHalf(Texel.R), StoreHalf(Texel.G), StoreHalf(Texel.B), StoreHalf(Texel.A));
+}
+
+FLinearColor BlendTranslucentLayer(const FLinearColor& StoredColor, const FLinearColor& LayerColor, EMobileDownsampleTranslucencyColorFormat Format)
+{
+	const float InvOpacity = 1.f - LayerColor.A;
+
+	// The blending happens at full precision, only its result is stored
+	return StoreColor(FLinearColor(
+		LayerColor.R * LayerColor.A + StoredColor.R * InvOpacity,
+		LayerColor.G * LayerColor.A + StoredColor.G * InvOpacity,
+		LayerColor.B * LayerColor.A + StoredColor.B * InvOpacity,
+		StoredColor.A * InvOpacity), Format);
+}
+
+FCompareResult Compare(const FColorImage& Result, const FColorImage& Golden, const FDepthImage& FullResDepth, const FVector4& InvDeviceZToWorldZTransform)
+{
+	check(Result.Size == Golden.Size);
+	check(Result.Size == FullResDepth.Size);
+
+	FCompareResult Compare;
+	double SumSquaredError = 0.0;
+	double SumAbsError = 0.0;
+	double SumEdgeAbsError = 0.0;
+
+	for (int32 Y = 0; Y < Result.Size.Y; ++Y)
+	{
+		for (int32 X = 0; X < Result.Size.X; ++X)
+		{
+			const FLinearColor& A = Result.Texels[Y * Result.Size.X + X];
+			const FLinearColor& B = Golden.Texels[Y * Golden.Size.X + X];
+
+			double PixelAbsError = 0.0;
+			for (int32 Channel = 0; Channel < 3; ++Channel)
+			{
+				const double Error = FMath::Clamp((&A.R)[Channel], 0.f, 1.f) - FMath::Clamp((&B.R)[Channel], 0.f, 1.f);
+				SumSquaredError += Error * Error;
+				PixelAbsError += FMath::Abs(Error);
+				Compare.MaxAbsError = FMath::Max(Compare.MaxAbsError, FMath::Abs(Error));
+			}
+			PixelAbsError /= 3.0;
+			SumAbsError += PixelAbsError;
+
+			const float Depth = ConvertFromDeviceZ(FullResDepth.Load(X, Y), InvDeviceZToWorldZTransform);
+			const float InvDepth = 1.0f / Depth;
+			const bool bIsEdge =
+				FMath::Abs(ConvertFromDeviceZ(FullResDepth.Load(X - 1, Y), InvDeviceZToWorldZTransform) - Depth) * InvDepth > RelativeDepthThreshold ||
+				FMath::Abs(ConvertFromDeviceZ(FullResDepth.Load(X + 1, Y), InvDeviceZToWorldZTransform) - Depth) * InvDepth > RelativeDepthThreshold ||
+				FMath::Abs(ConvertFromDeviceZ(FullResDepth.Load(X, Y - 1), InvDeviceZToWorldZTransform) - Depth) * InvDepth > RelativeDepthThreshold ||
+				FMath::Abs(ConvertFromDeviceZ(FullResDepth.Load(X, Y + 1), InvDeviceZToWorldZTransform) - Depth) * InvDepth > RelativeDepthThreshold;
+
+			if (bIsEdge)
+			{
+				SumEdgeAbsError += PixelAbsError;
+				Compare.NumEdgePixels++;
+			}
+		}
+	}
+
+	Compare.NumPixels = Result.Size.X * Result.Size.Y;
+	if (Compare.NumPixels > 0)
+	{
+		const double MeanSquaredError = SumSquaredError / (3.0 * Compare.NumPixels);
+		Compare.PSNR = MeanSquaredError > 0.0 ? 10.0 * FMath::LogX(10.0, 1.0 / MeanSquaredError) : TNumericLimits<double>::Max();
+		Compare.MeanAbsError = SumAbsError / Compare.NumPixels;
+	}
+	if (Compare.NumEdgePixels > 0)
+	{
+		Compare.EdgeMeanAbsError = SumEdgeAbsError / Compare.NumEdgePixels;
+	}
+	return Compare;
+}
+
+static bool LoadCaptureFloats(const TCHAR* Filename, uint32 ExpectedNumChannels, FIntPoint& OutSize, TArray<float>& OutFloats)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, Filename))
+	{
+		return false;
+	}
+
+	uint32 Header[4];
+	if (Bytes.Num() < sizeof(Header))
+	{
+		UE_LOG(LogRenderer, Warning, TEXT("%s is too small to be an off-screen particle capture."), Filename);
+		return false;
+	}
+	FMemory::Memcpy(Header, Bytes.GetData(), sizeof(Header));
+
+	const uint64 NumFloats = uint64(Header[1]) * Header[2] * Header[3];
+	if (Header[0] != CaptureFileMagic || Header[3] != ExpectedNumChannels || Bytes.Num() != sizeof(Header) + NumFloats * sizeof(float))
+	{
+		UE_LOG(LogRenderer, Warning, TEXT("%s is not a valid %u channel off-screen particle capture."), Filename, ExpectedNumChannels);
+		return false;
+	}
+
+	OutSize = FIntPoint(Header[1], Header[2]);
+	OutFloats.SetNumUninitialized(NumFloats);
+	FMemory::Memcpy(OutFloats.GetData(), Bytes.GetData() + sizeof(Header), NumFloats * sizeof(float));
+	return true;
+}
+
+static bool SaveCaptureFloats(const TCHAR* Filename, FIntPoint Size, uint32 NumChannels, const float* Floats)
+{
+	const uint32 Header[4] = { CaptureFileMagic, uint32(Size.X), uint32(Size.Y), NumChannels };
+	const uint64 NumFloatBytes = uint64(Size.X) * Size.Y * NumChannels * sizeof(float);
+
+	TArray<uint8> Bytes;
+	Bytes.SetNumUninitialized(sizeof(Header) + NumFloatBytes);
+	FMemory::Memcpy(Bytes.GetData(), Header, sizeof(Header));
+	FMemory::Memcpy(Bytes.GetData() + sizeof(Header), Floats, NumFloatBytes);
+	return FFileHelper::SaveArrayToFile(Bytes, Filename);
+}
+
+bool LoadCapture(const TCHAR* Filename, FColorImage& OutImage)
+{
+	TArray<float> Floats;
+	if (!LoadCaptureFloats(Filename, 4, OutImage.Size, Floats))
+	{
+		return false;
+	}
+	OutImage.Texels.SetNumUninitialized(OutImage.Size.X * OutImage.Size.Y);
+	FMemory::Memcpy(OutImage.Texels.GetData(), Floats.GetData(), Floats.Num() * sizeof(float));
+	return true;
+}
+
+bool LoadCapture(const TCHAR* Filename, FDepthImage& OutImage)
+{
+	return LoadCaptureFloats(Filename, 1, OutImage.Size, OutImage.Texels);
+}
+
+bool SaveCapture(const TCHAR* Filename, const FColorImage& Image)
+{
+	return SaveCaptureFloats(Filename, Image.Size, 4, &Image.Texels.GetData()->R);
+}
+
+bool SaveCapture(const TCHAR* Filename, const FDepthImage& Image)
+{
+	return SaveCaptureFloats(Filename, Image.Size, 1, Image.Texels.GetData());
+}
+
+} // namespace MobileTranslucencyUpsampling
+
+#if !UE_BUILD_SHIPPING
+
+/**
+ * Runs the CPU reference over a capture directory and diffs it against the golden image. Works headless (-nullrhi).
+ * Expected files: SceneColor.ospc (full res, scene depth in alpha), FullResDepth.ospc (device Z), LowResColor.ospc,
+ * Golden.ospc (expected upsample output) and View.txt holding InvDeviceZToWorldZTransform as written by FVector4::ToString.
+ * LowResDepth.ospc is optional, when missing it is rebuilt from SceneColor.ospc with the reference downsample.
+ * With r.Mobile.SeparateTranslucencyMinMaxDepth the low res depth is always rebuilt with the min/max downsample.
+ * With r.Mobile.SeparateTranslucencyTileComposite the pixels outside of the classified tiles are left uncomposited.
+ */
+static void CompareMobileTranslucencyUpsampleWithGolden(const TArray<FString>& Args)
+{
+	using namespace MobileTranslucencyUpsampling;
+
+	if (Args.Num() < 1)
+	{
+		UE_LOG(LogRenderer, Display, TEXT("Usage: r.Mobile.OffScreenParticles.CompareWithGolden <CaptureDir> [MinPSNR]"));
+		return;
+	}
+
+	const FString& CaptureDir = Args[0];
+	const double MinPSNR = Args.Num() > 1 ? FCString::Atod(*Args[1]) : 0.0;
+
+	FString ViewString;
+	FVector4 InvDeviceZToWorldZTransform;
+	if (!FFileHelper::LoadFileToString(ViewString, *FPaths::Combine(CaptureDir, TEXT("View.txt"))) || !InvDeviceZToWorldZTransform.InitFromString(ViewString))
+	{
+		UE_LOG(LogRenderer, Error, TEXT("Missing or invalid View.txt in %s"), *CaptureDir);
+		return;
+	}
+
+	FColorImage SceneColor;
+	FColorImage LowResColor;
+	FColorImage Golden;
+	FDepthImage FullResDepth;
+	if (!LoadCapture(*FPaths::Combine(CaptureDir, TEXT("SceneColor.ospc")), SceneColor)
+		|| !LoadCapture(*FPaths::Combine(CaptureDir, TEXT("LowResColor.ospc")), LowResColor)
+		|| !LoadCapture(*FPaths::Combine(CaptureDir, TEXT("Golden.ospc")), Golden)
+		|| !LoadCapture(*FPaths::Combine(CaptureDir, TEXT("FullResDepth.ospc")), FullResDepth))
+	{
+		UE_LOG(LogRenderer, Error, TEXT("Failed to load off-screen particle capture from %s"), *CaptureDir);
+		return;
+	}
+
+	// Follows r.Mobile.SeparateTranslucencyMinMaxDepth so the capture is compared against the path the renderer would take
+	static const auto CVarMinMaxDepth = IConsoleManager::Get().FindConsoleVariable(TEXT("r.Mobile.SeparateTranslucencyMinMaxDepth"));
+	const bool bMinMaxDepth = CVarMinMaxDepth && CVarMinMaxDepth->GetInt() != 0;
+
+	FDepthImage LowResDepth;
+	FDepthImage LowResClosestDepth;
+	FDepthImage LowResFarthestDepth;
+	if (bMinMaxDepth)
+	{
+		DownsampleDepthMinMax(SceneColor, InvDeviceZToWorldZTransform, LowResColor.Size, LowResClosestDepth, LowResFarthestDepth, LowResDepth);
+	}
+	else if (!LoadCapture(*FPaths::Combine(CaptureDir, TEXT("LowResDepth.ospc")), LowResDepth))
+	{
+		DownsampleDepth(SceneColor, InvDeviceZToWorldZTransform, LowResColor.Size, LowResDepth);
+	}
+
+	FUpsampleInputs Inputs;
+	Inputs.LowResColor = &LowResColor;
+	Inputs.LowResDepth = &LowResDepth;
+	Inputs.FullResDepth = &FullResDepth;
+	Inputs.InvDeviceZToWorldZTransform = InvDeviceZToWorldZTransform;
+	Inputs.FullResViewSize = FullResDepth.Size;
+	Inputs.LowResViewSize = LowResColor.Size;
+	if (bMinMaxDepth)
+	{
+		Inputs.LowResClosestDepth = &LowResClosestDepth;
+		Inputs.LowResFarthestDepth = &LowResFarthestDepth;
+	}
+
+	FColorImage Result;
+	TArray<bool> IsEdgePixel;
+	const double StartTime = FPlatformTime::Seconds();
+	NearestDepthNeighborUpsample(Inputs, Result, &IsEdgePixel);
+	const double UpsampleTime = FPlatformTime::Seconds() - StartTime;
+
+	static const auto CVarTileComposite = IConsoleManager::Get().FindConsoleVariable(TEXT("r.Mobile.SeparateTranslucencyTileComposite"));
+	const bool bTileComposite = CVarTileComposite && CVarTileComposite->GetInt() != 0;
+
+	TArray<FIntPoint> Tiles;
+	ClassifyUpsampleTiles(LowResColor, FIntRect(FIntPoint::ZeroValue, LowResColor.Size), Tiles);
+	const FIntPoint NumViewTiles = FIntPoint::DivideAndRoundUp(LowResColor.Size, UpsampleTileSize);
+	if (bTileComposite)
+	{
+		// Pixels the tile quads don't reach keep scene color, the identity of the composite blend
+		TArray<bool> IsCovered;
+		RasterizeUpsampleTiles(Tiles, LowResColor.Size, Result.Size, IsCovered);
+		for (int32 Index = 0; Index < Result.Texels.Num(); ++Index)
+		{
+			if (!IsCovered[Index])
+			{
+				Result.Texels[Index] = FLinearColor::Black;
+			}
+		}
+	}
+
+	SaveCapture(*FPaths::Combine(CaptureDir, TEXT("Result.ospc")), Result);
+
+	if (Result.Size != Golden.Size)
+	{
+		UE_LOG(LogRenderer, Error, TEXT("Golden image is %dx%d but the upsample produced %dx%d"), Golden.Size.X, Golden.Size.Y, Result.Size.X, Result.Size.Y);
+		return;
+	}
+
+	int32 NumNearestDepthPixels = 0;
+	for (bool bIsEdge : IsEdgePixel)
+	{
+		NumNearestDepthPixels += bIsEdge ? 1 : 0;
+	}
+
+	const FCompareResult Metrics = Compare(Result, Golden, FullResDepth, InvDeviceZToWorldZTransform);
+	const bool bPassed = Metrics.PSNR >= MinPSNR;
+	UE_LOG(LogRenderer, Display, TEXT("Off-screen particle upsample %s: PSNR %.2f dB, mean abs error %.5f, edge mean abs error %.5f (%d edge pixels), max abs error %.5f, nearest-depth pixels %.1f%%, covered tiles %.1f%%%s, %.2f ms"),
+		bPassed ? TEXT("PASSED") : TEXT("FAILED"),
+		Metrics.PSNR,
+		Metrics.MeanAbsError,
+		Metrics.EdgeMeanAbsError,
+		Metrics.NumEdgePixels,
+		Metrics.MaxAbsError,
+		Metrics.NumPixels > 0 ? 100.0 * NumNearestDepthPixels / Metrics.NumPixels : 0.0,
+		100.0 * Tiles.Num() / FMath::Max(NumViewTiles.X * NumViewTiles.Y, 1),
+		bTileComposite ? TEXT(" (applied)") : TEXT(""),
+		UpsampleTime * 1000.0);
+}
+
+static FAutoConsoleCommand GCompareMobileTranslucencyUpsampleWithGolden(
+	TEXT("r.Mobile.OffScreenParticles.CompareWithGolden"),
+	TEXT("Runs the CPU reference of the mobile off-screen particle upsample on a capture directory and compares it with Golden.ospc.\n")
+	TEXT("Usage: r.Mobile.OffScreenParticles.CompareWithGolden <CaptureDir> [MinPSNR]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&CompareMobileTranslucencyUpsampleWithGolden));
+
+/**
+ * Blends stacks of random Translucent layers into every low res color format and compares them with the same blend at full
+ * precision. LDR stacks have colors up to 1, HDR ones up to 4, RGBA8 is only expected to hold the former. The errors are absolute. Also reports the memory and the estimated traffic of the low res color of a view at each format. Works headless (-nullrhi).
+ */
+static void TestMobileTranslucencyColorFormats(const TArray<FString>& Args)
+{
+	using namespace MobileTranslucencyUpsampling;
+
+	const FIntPoint LowResSize = Args.Num() >= 2 ? FIntPoint(FCString::Atoi(*Args[0]), FCString::Atoi(*Args[1])) : FIntPoint(960, 540);
+	const int32 NumStacks = 4096;
+	const int32 MaxLayers = 8;
+
+	static const TCHAR* const FormatNames[] = { TEXT("FloatRGBA"), TEXT("RGBA8") };
+	static_assert(UE_ARRAY_COUNT(FormatNames) == (int32)EMobileDownsampleTranslucencyColorFormat::Num, "Missing color format name");
+
+	bool bAllPassed = true;
+	for (int32 FormatIndex = 0; FormatIndex < (int32)EMobileDownsampleTranslucencyColorFormat::Num; FormatIndex++)
+	{
+		const EMobileDownsampleTranslucencyColorFormat Format = (EMobileDownsampleTranslucencyColorFormat)FormatIndex;
+		const bool bHDR = Format == EMobileDownsampleTranslucencyColorFormat::FloatRGBA;
+
+		// Half a storage step per channel, the rounding of a stored layer. Float steps grow with the value, up to the largest color
+		const float TransmittanceHalfStep = bHDR ? FMath::Pow(2.f, -float(HalfMantissaBits + 1)) : 0.5f / 255.f;
+
+		float MaxError[2] = { 0.f, 0.f };
+		float MaxTransmittanceError = 0.f;
+		bool bPassed = true;
+		for (int32 RangeIndex = 0; RangeIndex < 2; RangeIndex++)
+		{
+			const float MaxLayerColor = RangeIndex == 0 ? 1.f : 4.f;
+			const float ColorHalfStep = bHDR ? MaxLayerColor * FMath::Pow(2.f, -float(HalfMantissaBits + 1)) : 0.5f / 255.f;
+			const bool bCountsForResult = RangeIndex == 0 || bHDR;
+
+			// Same stacks for every format
+			FRandomStream RandomStream(RangeIndex + 1);
+			for (int32 StackIndex = 0; StackIndex < NumStacks; StackIndex++)
+			{
+				// The clear value: no contribution
+				FLinearColor Stored = StoreColor(FLinearColor::Black, Format);
+				FLinearColor Expected = FLinearColor::Black;
+
+				const int32 NumLayers = RandomStream.RandRange(1, MaxLayers);
+				for (int32 LayerIndex = 0; LayerIndex < NumLayers; LayerIndex++)
+				{
+					const FLinearColor Layer(
+						RandomStream.GetFraction() * MaxLayerColor,
+						RandomStream.GetFraction() * MaxLayerColor,
+						RandomStream.GetFraction() * MaxLayerColor,
+						RandomStream.GetFraction());
+
+					Stored = BlendTranslucentLayer(Stored, Layer, Format);
+					Expected = FLinearColor(
+						Layer.R * Layer.A + Expected.R * (1.f - Layer.A),
+						Layer.G * Layer.A + Expected.G * (1.f - Layer.A),
+						Layer.B * Layer.A + Expected.B * (1.f - Layer.A),
+						Expected.A * (1.f - Layer.A));
+				}
+
+				// Every layer rounds once more
+				for (int32 Channel = 0; Channel < 3; ++Channel)
+				{
+					const float Error = FMath::Abs((&Stored.R)[Channel] - (&Expected.R)[Channel]);
+					MaxError[RangeIndex] = FMath::Max(MaxError[RangeIndex], Error);
+					bPassed &= !bCountsForResult || Error <= NumLayers * ColorHalfStep + KINDA_SMALL_NUMBER;
+				}
+				MaxTransmittanceError = FMath::Max(MaxTransmittanceError, FMath::Abs(Stored.A - Expected.A));
+				bPassed &= FMath::Abs(Stored.A - Expected.A) <= NumLayers * TransmittanceHalfStep + KINDA_SMALL_NUMBER;
+			}
+		}
+
+		bAllPassed &= bPassed;
+
+		const uint32 BytesPerTexel = GPixelFormats[GetMobileDownsampleTranslucencyColorPixelFormat(Format)].BlockBytes;
+		const double TargetMB = double(LowResSize.X) * LowResSize.Y * BytesPerTexel / (1024.0 * 1024.0);
+
+		UE_LOG(LogRenderer, Display, TEXT("Off-screen particle color format %s %s: max LDR error %.5f, max HDR error %.5f%s, max transmittance error %.5f, %u bytes per texel, %.2f MB, estimated traffic %.2f MB per frame at %dx%d"),
+			FormatNames[FormatIndex],
+			bPassed ? TEXT("PASSED") : TEXT("FAILED"),
+			MaxError[0],
+			MaxError[1],
+			bHDR ? TEXT("") : TEXT(" (clamped)"),
+			MaxTransmittanceError,
+			BytesPerTexel,
+			TargetMB,
+			// Stored by the low res pass, read by the upsample
+			2.0 * TargetMB,
+			LowResSize.X, LowResSize.Y);
+	}
+
+	UE_LOG(LogRenderer, Display, TEXT("Off-screen particle color formats %s, %d stacks of up to %d layers, tolerance of half a storage step per layer"), bAllPassed ? TEXT("PASSED") : TEXT("FAILED"), NumStacks, MaxLayers);
+}
+
+static FAutoConsoleCommand GTestMobileTranslucencyColorFormats(
+	TEXT("r.Mobile.OffScreenParticles.TestColorFormats"),
+	TEXT("Round trips blended off-screen particle colors through every r.Mobile.SeparateTranslucencyColorFormat and reports their error, memory and traffic.\n")
+	TEXT("Usage: r.Mobile.OffScreenParticles.TestColorFormats [LowResSizeX LowResSizeY]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&TestMobileTranslucencyColorFormats));
+
+#endif // !UE_BUILD_SHIPPING
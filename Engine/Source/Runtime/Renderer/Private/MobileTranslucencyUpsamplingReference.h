@@ -0,0 +1,195 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	MobileTranslucencyUpsamplingReference.h: CPU reference of the mobile
+	off-screen particle depth downsample and nearest-depth upsample.
+=============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TranslucencyPass.h"
+
+/**
+ * CPU mirror of MobileDownSampleDepthPixelShader.usf and MobileTranslucencyUpsampling.usf.
+ * Used to validate upsample variants against captured buffers and golden images without a GPU.
+ * Any change to the shaders must be reflected here, the math is kept line for line identical.
+ */
+namespace MobileTranslucencyUpsampling
+{
+	/** Depth is clamped to this value before the relative comparison, see MaxOperationDepth in the shader. */
+	static constexpr float MaxOperationDepth = 65500.f;
+
+	/** Relative depth delta below which the bilinear sample is used, see RelativeDepthThreshold in the shader. */
+	static constexpr float RelativeDepthThreshold = 0.1f;
+
+	/** A single channel float image, row major. */
+	struct FDepthImage
+	{
+		FIntPoint Size = FIntPoint::ZeroValue;
+		TArray<float> Texels;
+
+		void Init(FIntPoint InSize, float Value = 0.f)
+		{
+			Size = InSize;
+			Texels.Init(Value, InSize.X * InSize.Y);
+		}
+
+		float Load(int32 X, int32 Y) const
+		{
+			X = FMath::Clamp(X, 0, Size.X - 1);
+			Y = FMath::Clamp(Y, 0, Size.Y - 1);
+			return Texels[Y * Size.X + X];
+		}
+	};
+
+	/** A four channel float image, row major. */
+	struct FColorImage
+	{
+		FIntPoint Size = FIntPoint::ZeroValue;
+		TArray<FLinearColor> Texels;
+
+		void Init(FIntPoint InSize, const FLinearColor& Value = FLinearColor::Transparent)
+		{
+			Size = InSize;
+			Texels.Init(Value, InSize.X * InSize.Y);
+		}
+
+		const FLinearColor& Load(int32 X, int32 Y) const
+		{
+			X = FMath::Clamp(X, 0, Size.X - 1);
+			Y = FMath::Clamp(Y, 0, Size.Y - 1);
+			return Texels[Y * Size.X + X];
+		}
+	};
+
+	/** Inputs of the upsample, as bound by FMobileTranslucencyUpsamplingPS::SetParameters. */
+	struct FUpsampleInputs
+	{
+		/** SeparateTranslucencyRT content after the low res particle pass. */
+		const FColorImage* LowResColor = nullptr;
+		/** Low res depth of the tier, device Z. */
+		const FDepthImage* LowResDepth = nullptr;
+		/** Full res scene depth, device Z. */
+		const FDepthImage* FullResDepth = nullptr;
+		/** FViewInfo::InvDeviceZToWorldZTransform. */
+		FVector4 InvDeviceZToWorldZTransform = FVector4(0.f, 0.f, 1.f, 0.f);
+		/** Size of the full res view rect, the upsample writes one texel per pixel of it. */
+		FIntPoint FullResViewSize = FIntPoint::ZeroValue;
+		/** Size of the low res view rect inside LowResColor / LowResDepth. */
+		FIntPoint LowResViewSize = FIntPoint::ZeroValue;
+		/** Optional closest / farthest linear depth per low res texel, the farthest one enables the MOBILE_TRANSLUCENCY_UPSAMPLE_MINMAX classification. */
+		const FDepthImage* LowResClosestDepth = nullptr;
+		const FDepthImage* LowResFarthestDepth = nullptr;
+	};
+
+	/** Converts device Z to linear depth the same way the upsample shader does, including the clamp. */
+	float ConvertFromDeviceZ(float DeviceZ, const FVector4& InvDeviceZToWorldZTransform);
+
+	/** Converts linear depth back to device Z, inverse of ConvertFromDeviceZ without the clamp. */
+	float ConvertToDeviceZ(float SceneDepth, const FVector4& InvDeviceZToWorldZTransform);
+
+	/**
+	 * Reference of MobileDownSampleDepthPixelShader: reads linear depth from scene color alpha and writes device Z
+	 * of one full res texel per low res texel. FullResSceneColor is expected to cover the view rect exactly.
+	 */
+	void DownsampleDepth(const FColorImage& FullResSceneColor, const FVector4& InvDeviceZToWorldZTransform, FIntPoint LowResViewSize, FDepthImage& OutLowResDepth);
+
+	/**
+	 * Reference of MinMaxMain and FromMinMaxMain: the closest and farthest linear depth of all full res texels covered by each
+	 * low res texel, and the device Z of the closest one as written to the low res depth buffer.
+	 * The farthest depth is negated on edge texels, whose 3x3 neighborhood spans more than RelativeDepthThreshold.
+	 */
+	void DownsampleDepthMinMax(const FColorImage& FullResSceneColor, const FVector4& InvDeviceZToWorldZTransform, FIntPoint LowResViewSize, FDepthImage& OutClosestDepth, FDepthImage& OutFarthestDepth, FDepthImage& OutLowResDepth);
+
+	/** Matrices of the previous frame depth reprojection, both take float4(ScreenPos * SceneDepth, SceneDepth, 1). */
+	struct FReprojectionMatrices
+	{
+		/** Current frame screen position to previous frame clip space. */
+		FMatrix CurrentScreenToPrevClip;
+		/** Previous frame screen position to current frame clip space. */
+		FMatrix PrevScreenToCurrentClip;
+	};
+
+	/**
+	 * Builds the reprojection matrices from both frames' FViewMatrices. Goes through translated world space with the
+	 * pre-view translation delta folded in, like ClipToPrevClip, so large world coordinates don't cost precision.
+	 */
+	FReprojectionMatrices MakeReprojectionMatrices(
+		const FMatrix& ProjectionMatrix, const FMatrix& InvProjectionMatrix, const FMatrix& TranslatedViewMatrix, const FVector& PreViewTranslation,
+		const FMatrix& PrevProjectionMatrix, const FMatrix& PrevInvProjectionMatrix, const FMatrix& PrevTranslatedViewMatrix, const FVector& PrevPreViewTranslation);
+
+	/**
+	 * Reference of HistoryMain: the low res linear depth kept for the next frame, sampled from full res device Z the same way
+	 * as DownsampleDepth samples scene color alpha.
+	 */
+	void DownsampleDepthHistory(const FDepthImage& FullResDepth, const FVector4& InvDeviceZToWorldZTransform, FIntPoint LowResViewSize, FDepthImage& OutLowResLinearDepth);
+
+	/**
+	 * Reference of ReprojectMain: builds the current low res device Z from the previous frame's low res linear depth.
+	 * OutIsDisoccluded, when given, flags the pixels which took the disocclusion fallback.
+	 */
+	void ReprojectDepth(const FDepthImage& PrevLowResLinearDepth, const FReprojectionMatrices& Matrices, const FVector4& InvDeviceZToWorldZTransform, FIntPoint LowResViewSize, FDepthImage& OutLowResDepth, TArray<bool>* OutIsDisoccluded = nullptr);
+
+	/** Reference of MobileNearestDepthNeighborUpsamplingPS, writes the shader output (before blending) for every full res pixel. */
+	void NearestDepthNeighborUpsample(const FUpsampleInputs& Inputs, FColorImage& OutColor, TArray<bool>* OutIsEdgePixel = nullptr);
+
+	/** Side of the square low res tiles of the tile list composite, see MOBILE_UPSAMPLE_TILE_SIZE. */
+	static constexpr int32 UpsampleTileSize = 8;
+
+	/** Whether a low res texel changes scene color when composited, the off-screen target is cleared to (0, 0, 0, 1). */
+	bool HasParticleContribution(const FLinearColor& LowResColor);
+
+	/**
+	 * Reference of MobileUpsampleTileClassifyCS: origins of the tiles of LowResRect whose texels, or the texels of the one texel ring
+	 * around them, have any particle contribution. The GPU appends in no particular order, OutTiles is in row major order.
+	 */
+	void ClassifyUpsampleTiles(const FColorImage& LowResColor, const FIntRect& LowResRect, TArray<FIntPoint>& OutTiles);
+
+	/** Flags the full res pixels rasterized by the tile quads of MobileUpsampleTileVS, pixel centers inside a quad are covered. */
+	void RasterizeUpsampleTiles(TArrayView<const FIntPoint> Tiles, FIntPoint LowResViewSize, FIntPoint FullResViewSize, TArray<bool>& OutIsCovered);
+
+	/** Rounds a texel to the precision of the low res color target of a format, as a render target store does. */
+	FLinearColor StoreColor(const FLinearColor& Texel, EMobileDownsampleTranslucencyColorFormat Format);
+
+	/**
+	 * Reference of the Translucent blend of an off-screen particle onto a stored low res texel: Dst.rgb = Src.rgb * Src.a + Dst.rgb * (1 - Src.a)
+	 * and Dst.a = Dst.a * (1 - Src.a), Src being the base pass output. Returns the new stored texel.
+	 */
+	FLinearColor BlendTranslucentLayer(const FLinearColor& StoredColor, const FLinearColor& LayerColor, EMobileDownsampleTranslucencyColorFormat Format);
+
+	/** Applies the upsample blend state (CW_RGB, BO_Add, BF_One, BF_SourceAlpha) onto scene color. */
+	void Composite(const FColorImage& UpsampledColor, FColorImage& InOutSceneColor);
+
+	/** Quality metrics of an upsample result against a golden image. */
+	struct FCompareResult
+	{
+		/** PSNR over RGB in dB, clamped to [0, 1] range. Infinite for an exact match. */
+		double PSNR = 0.0;
+		/** Mean absolute RGB error over all pixels. */
+		double MeanAbsError = 0.0;
+		/** Mean absolute RGB error over pixels lying on a full res depth discontinuity. */
+		double EdgeMeanAbsError = 0.0;
+		/** Largest absolute per channel error. */
+		double MaxAbsError = 0.0;
+		int32 NumPixels = 0;
+		int32 NumEdgePixels = 0;
+	};
+
+	/**
+	 * Compares Result against Golden. Edge pixels are those whose full res depth differs from any 4-neighbour
+	 * by more than RelativeDepthThreshold, which is where halos from the downsample show up.
+	 */
+	FCompareResult Compare(const FColorImage& Result, const FColorImage& Golden, const FDepthImage& FullResDepth, const FVector4& InvDeviceZToWorldZTransform);
+
+	/**
+	 * Captured buffers are stored as a little endian header { uint32 Magic, uint32 SizeX, uint32 SizeY, uint32 NumChannels }
+	 * followed by SizeX * SizeY * NumChannels floats.
+	 */
+	static constexpr uint32 CaptureFileMagic = 0x4350534F; // 'OSPC'
+
+	bool LoadCapture(const TCHAR* Filename, FColorImage& OutImage);
+	bool LoadCapture(const TCHAR* Filename, FDepthImage& OutImage);
+	bool SaveCapture(const TCHAR* Filename, const FColorImage& Image);
+	bool SaveCapture(const TCHAR* Filename, const FDepthImage& Image);
+}
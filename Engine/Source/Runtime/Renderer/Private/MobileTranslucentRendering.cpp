@@ -28,7 +28,15 @@
 #include "ScreenRendering.h"
 #include "PostProcess/SceneFilterRendering.h"
 #include "PipelineStateCache.h"
+#include "ClearQuad.h"
+#include "CommonRenderResources.h"
+#include "RHIGPUReadback.h"
 #include "MeshPassProcessor.inl"
+#include "MobileDownsampleTranslucencyGovernor.h"
+#include "MobileTranslucencyUpsamplingReference.h"
+#include "MobileDownsampleTranslucencyScissor.h"
+#include "MobileDownsampleTranslucencyGraph.h"
+#include "RenderGraph.h"
 
 
 //YJH Created By 2020-8-14
@@ -40,624 +48,3231 @@
 //	TEXT(" 1 = On [default]"),
 //	ECVF_Scalability | ECVF_RenderThreadSafe);
 
+static TAutoConsoleVariable<float> CVarMobileSeparateTranslucencyScreenPercentage(
+	TEXT("r.Mobile.SeparateTranslucencyScreenPercentage"),
+	50.0f,
+	TEXT("Resolution of the mobile off-screen particle pass in percent of the view resolution, in (0, 100].\n")
+	TEXT("Any integer or fractional ratio is supported, e.g. 25 for heavy smoke on mid-tier devices or 75 on high-end ones.\n")
+	TEXT("Meant to be set per device profile."),
+	ECVF_Scalability | ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarMobileSeparateTranslucencyMinViewHeight(
+	TEXT("r.Mobile.SeparateTranslucencyMinViewHeight"),
+	180,
+	TEXT("Fewest rows of the Auto tier's low res view, raising the scale of small views such as split screen quarters and scene captures\n")
+	TEXT("above r.Mobile.SeparateTranslucencyScreenPercentage and the governor. 0 keeps the same scale for every view."),
+	ECVF_Scalability | ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarMobileSeparateTranslucencyAutoDownsample(
+	TEXT("r.Mobile.SeparateTranslucencyAutoDownsample"),
+	0,
+	TEXT("Whether to pick the resolution of the mobile off-screen particle pass from its GPU time, per view.\n")
+	TEXT("When enabled the pass switches between full, half and quarter resolution and r.Mobile.SeparateTranslucencyScreenPercentage is ignored.\n")
+	TEXT("Requires GPU timestamp queries."),
+	ECVF_Scalability | ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<float> CVarMobileSeparateTranslucencyDurationDownsampleThreshold(
+	TEXT("r.Mobile.SeparateTranslucencyDurationDownsampleThreshold"),
+	2.0f,
+	TEXT("When the smoothed GPU duration of the mobile off-screen particle pass is larger than this value (ms), its resolution is halved in each dimension."),
+	ECVF_Scalability | ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<float> CVarMobileSeparateTranslucencyDurationUpsampleThreshold(
+	TEXT("r.Mobile.SeparateTranslucencyDurationUpsampleThreshold"),
+	0.5f,
+	TEXT("When the smoothed GPU duration of the mobile off-screen particle pass is smaller than this value (ms), its resolution is doubled in each dimension.\n")
+	TEXT("This should be around 1/4 of r.Mobile.SeparateTranslucencyDurationDownsampleThreshold to avoid toggling constantly."),
+	ECVF_Scalability | ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<float> CVarMobileSeparateTranslucencyMinDownsampleChangeTime(
+	TEXT("r.Mobile.SeparateTranslucencyMinDownsampleChangeTime"),
+	1.0f,
+	TEXT("Minimum time in seconds between changes of the automatic mobile off-screen particle resolution."),
+	ECVF_Scalability | ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarMobileSeparateTranslucencyMinMaxDepth(
+	TEXT("r.Mobile.SeparateTranslucencyMinMaxDepth"),
+	0,
+	TEXT("Whether the mobile off-screen particle depth downsample keeps the closest and farthest depth of every low res texel.\n")
+	TEXT("The low res depth test then uses the closest depth, and the upsample uses the depth range to skip the nearest-depth search on interior pixels.\n")
+	TEXT("Costs a render pass and a 64 bit target at low res, ignored where PF_G32R32F can't be rendered to.\n")
+	TEXT(" 0 = Off, one full res texel per low res texel [default]\n")
+	TEXT(" 1 = On"),
+	ECVF_Scalability | ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarMobileSeparateTranslucencyUpsampleClassStats(
+	TEXT("r.Mobile.SeparateTranslucencyUpsampleClassStats"),
+	0,
+	TEXT("Whether the mobile off-screen particle upsample counts its bilinear and nearest-depth pixels for stat SceneRendering.\n")
+	TEXT("Requires r.Mobile.SeparateTranslucencyMinMaxDepth, costs occlusion queries and a draw of the nearest-depth pixels without color writes.\n")
+	TEXT(" 0 = Off [default]\n")
+	TEXT(" 1 = On"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarMobileSeparateTranslucencyReprojectDepth(
+	TEXT("r.Mobile.SeparateTranslucencyReprojectDepth"),
+	0,
+	TEXT("Whether the mobile off-screen particles are rendered before the scene color pass against the previous frame's depth, reprojected.\n")
+	TEXT("Trades one frame of depth latency for the scene color pass break, the composite stays an in-pass draw. Single view only.\n")
+	TEXT(" 0 = Off, low res depth downsampled from the current frame [default]\n")
+	TEXT(" 1 = On"),
+	ECVF_Scalability | ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarMobileSeparateTranslucencyScissor(
+	TEXT("r.Mobile.SeparateTranslucencyScissor"),
+	1,
+	TEXT("Whether the depth downsample, the clear and the composite of the mobile off-screen particles are scissored to the projected bounds of the particles.\n")
+	TEXT(" 0 = Off, the whole view\n")
+	TEXT(" 1 = On [default]"),
+	ECVF_Scalability | ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarMobileSeparateTranslucencyTileComposite(
+	TEXT("r.Mobile.SeparateTranslucencyTileComposite"),
+	0,
+	TEXT("Whether the mobile off-screen particles are composited only over the 8x8 low res tiles they cover.\n")
+	TEXT("A compute pass lists the covered tiles after the low res pass, the composite is an indirect instanced draw of one quad per tile.\n")
+	TEXT("Requires compute shaders, ignored on OpenGL ES.\n")
+	TEXT(" 0 = Off, the composite covers the whole view or its scissor rect [default]\n")
+	TEXT(" 1 = On"),
+	ECVF_Scalability | ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarMobileSeparateTranslucencyParallel(
+	TEXT("r.Mobile.SeparateTranslucencyParallel"),
+	0,
+	TEXT("Whether the draws of the mobile off-screen particles are recorded in parallel command lists.\n")
+	TEXT("Only used with parallel rendering and r.ParallelTranslucency, on RHIs executing parallel command lists inside a render pass\n")
+	TEXT("(GRHISupportsParallelRHIExecute). Elsewhere every command list would resume the low res pass, storing and loading it on tiled GPUs.\n")
+	TEXT(" 0 = Off, recorded on the render thread [default]\n")
+	TEXT(" 1 = On"),
+	ECVF_Scalability | ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarMobileSeparateTranslucencyMultiView(
+	TEXT("r.Mobile.SeparateTranslucencyMultiView"),
+	1,
+	TEXT("Whether the mobile off-screen particles of both eyes of mobile multi-view are rendered by single multi-view passes.\n")
+	TEXT("The depth downsample, the particles and the upsample each draw once into two slice array targets. Not used with MSAA.\n")
+	TEXT("Scissor, min/max depth and tile composite are not supported by it.\n")
+	TEXT(" 0 = Off, they are drawn at full res in the scene color pass, as when MSAA or r.Mobile.AdrenoOcclusionMode rule the multi-view passes out\n")
+	TEXT(" 1 = On [default]"),
+	ECVF_Scalability | ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarMobileSeparateTranslucencyViewAtlas(
+	TEXT("r.Mobile.SeparateTranslucencyViewAtlas"),
+	1,
+	TEXT("Whether the mobile off-screen particles of several views (split screen) share one atlas of their low res views.\n")
+	TEXT("Every tier then takes a single depth downsample and particle pass for all views, and all views are composited by a single pass.\n")
+	TEXT("Their draws are recorded on the render thread and the tile composite is not used.\n")
+	TEXT(" 0 = Off, a low res pass and a composite pass per view\n")
+	TEXT(" 1 = On [default]"),
+	ECVF_Scalability | ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarMobileSeparateTranslucencyRenderGraph(
+	TEXT("r.Mobile.SeparateTranslucencyRenderGraph"),
+	0,
+	TEXT("Whether the mobile off-screen particles are rendered by a render graph after translucency, when nothing follows them in the scene color pass.\n")
+	TEXT("Every tier of a view (or atlas) gets a pass downsampling the depth and drawing its particles into transient textures, then a single\n")
+	TEXT("pass composites them. The graph transitions the textures and reuses their memory once composited, see r.Mobile.OffScreenParticles.ValidateGraph.\n")
+	TEXT("The depth reprojection, min/max depth, tile composite and parallel recording are not used by it.\n")
+	TEXT(" 0 = Off, immediate passes [default]\n")
+	TEXT(" 1 = On"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarMobileSeparateTranslucencyTransientTargets(
+	TEXT("r.Mobile.SeparateTranslucencyTransientTargets"),
+	1,
+	TEXT("Whether the low res targets of the mobile off-screen particles only live from their pass to the composite.\n")
+	TEXT("They are then returned to the render target pool before the post processing, which reuses their memory, or aliases it on RHIs\n")
+	TEXT("supporting transient resources. They are in fast VRAM with r.FastVRam.SeparateTranslucency. See r.Mobile.OffScreenParticles.MemoryReport.\n")
+	TEXT(" 0 = Off, they are held until the next frame, as the scene render targets did\n")
+	TEXT(" 1 = On [default]"),
+	ECVF_RenderThreadSafe);
+
+DECLARE_CYCLE_STAT(TEXT("Mobile Off-Screen Particles Draw Dispatch"), STAT_MobileDownsampleTranslucencyDispatch, STATGROUP_SceneRendering);
+DECLARE_CYCLE_STAT(TEXT("Mobile Off-Screen Particles"), STAT_CLP_MobileDownsampleTranslucency, STATGROUP_ParallelCommandListMarkers);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Mobile Off-Screen Particles GPU Time (MS)"), STAT_MobileDownsampleTranslucencyGPU, STATGROUP_SceneRendering);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Mobile Scene Color Render Pass Breaks"), STAT_MobileSceneColorRenderPassBreaks, STATGROUP_SceneRendering);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Mobile Scene Color Estimated Load (MB)"), STAT_MobileSceneColorLoadMB, STATGROUP_SceneRendering);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Mobile Scene Color Estimated Store (MB)"), STAT_MobileSceneColorStoreMB, STATGROUP_SceneRendering);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Mobile Off-Screen Particles Bilinear Pixels"), STAT_MobileUpsampleInteriorPixels, STATGROUP_SceneRendering);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Mobile Off-Screen Particles Nearest-Depth Pixels"), STAT_MobileUpsampleEdgePixels, STATGROUP_SceneRendering);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Mobile Off-Screen Particles Nearest-Depth Pixels (%)"), STAT_MobileUpsampleEdgePixelPercent, STATGROUP_SceneRendering);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Mobile Off-Screen Particles Covered Tiles (%)"), STAT_MobileUpsampleCoveredTilePercent, STATGROUP_SceneRendering);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Mobile Off-Screen Particles Color Targets (MB)"), STAT_MobileDownsampleTranslucencyColorMB, STATGROUP_SceneRendering);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Mobile Off-Screen Particles Estimated Color Traffic (MB)"), STAT_MobileDownsampleTranslucencyColorTrafficMB, STATGROUP_SceneRendering);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Mobile Off-Screen Particles Low Res Targets (MB)"), STAT_MobileDownsampleTranslucencyTargetsMB, STATGROUP_SceneRendering);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Mobile Off-Screen Particles Held Low Res Targets (MB)"), STAT_MobileDownsampleTranslucencyHeldTargetsMB, STATGROUP_SceneRendering);
 
-/** Pixel shader used to copy scene color into another texture so that materials can read from scene color with a node. */
-class FMobileCopySceneAlphaPS : public FGlobalShader
+/**
+ * Lifetime of the low res targets of the mobile off-screen particles. Returned to the pool by the composite, or held until the next frame
+ * by r.Mobile.SeparateTranslucencyTransientTargets 0: then they go back to the pool as it begins, for its passes to find them again.
+ */
+class FMobileDownsampleTranslucencyTargetLifetime : public FRenderResource
 {
-	DECLARE_SHADER_TYPE(FMobileCopySceneAlphaPS, Global);
 public:
+	/** Whether the targets of the current frame are returned to the pool by the composite. */
+	bool IsTransient() const
+	{
+#if !UE_BUILD_SHIPPING
+		if (Report.IsActive())
+		{
+			return Report.IsTransientFrame();
+		}
+#endif
+		return CVarMobileSeparateTranslucencyTransientTargets.GetValueOnRenderThread() != 0;
+	}
 
-	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters) { return IsMobilePlatform(Parameters.Platform); }
-
-	FMobileCopySceneAlphaPS(const ShaderMetaType::CompiledShaderInitializerType& Initializer) :
-		FGlobalShader(Initializer)
+	/** Allocates a low res target from the pool in fast VRAM, counted until the target is released. */
+	void FindFreeElement(FRHICommandList& RHICmdList, FPooledRenderTargetDesc& Desc, TRefCountPtr<IPooledRenderTarget>& Out, const TCHAR* Name)
 	{
-		SceneTextureParameters.Bind(Initializer);
+		Desc.Flags |= GFastVRamConfig.SeparateTranslucency;
+		GRenderTargetPool.FindFreeElement(RHICmdList, Desc, Out, Name, true, IsTransient() ? ERenderTargetTransience::Transient : ERenderTargetTransience::NonTransient);
+		FrameBytes += Out->ComputeMemorySize();
 	}
-	FMobileCopySceneAlphaPS() {}
 
-	void SetParameters(FRHICommandList& RHICmdList, const FSceneView& View)
+	/** Called by the composite once the target is no longer read. */
+	void Release(TRefCountPtr<IPooledRenderTarget>& Target)
 	{
-		SceneTextureParameters.Set(RHICmdList, RHICmdList.GetBoundPixelShader(), View.FeatureLevel, ESceneTextureSetupMode::All);
+		if (Target && !IsTransient())
+		{
+			HeldBytes += Target->ComputeMemorySize();
+			HeldTargets.Add(Target);
+		}
+		Target.SafeRelease();
 	}
 
-private:
-	LAYOUT_FIELD(FSceneTextureShaderParameters, SceneTextureParameters)
-};
+	/** Called by the composite after the last release. */
+	void EndFrame()
+	{
+#if !UE_BUILD_SHIPPING
+		Report.Sample(FrameBytes, HeldBytes);
+#endif
+		SET_FLOAT_STAT(STAT_MobileDownsampleTranslucencyTargetsMB, float(FrameBytes / (1024.0 * 1024.0)));
+		FrameBytes = 0;
+	}
 
-IMPLEMENT_SHADER_TYPE(, FMobileCopySceneAlphaPS, TEXT("/Engine/Private/TranslucentLightingShaders.usf"), TEXT("CopySceneAlphaMain"), SF_Pixel);
+	/** Called as a frame begins, before its first allocation. */
+	void BeginFrame()
+	{
+#if !UE_BUILD_SHIPPING
+		// The held targets are still in the pool, the previous frame's post processing is done
+		Report.Sample(0, HeldBytes);
+		Report.Advance();
+#endif
+		SET_FLOAT_STAT(STAT_MobileDownsampleTranslucencyHeldTargetsMB, float(HeldBytes / (1024.0 * 1024.0)));
+		HeldTargets.Empty();
+		HeldBytes = 0;
+	}
 
-void FMobileSceneRenderer::CopySceneAlpha(FRHICommandListImmediate& RHICmdList, const FViewInfo& View)
-{
-	SCOPED_DRAW_EVENTF(RHICmdList, EventCopy, TEXT("CopySceneAlpha"));
-	FSceneRenderTargets& SceneContext = FSceneRenderTargets::Get(RHICmdList);
+	virtual void ReleaseRHI() override
+	{
+		HeldTargets.Empty();
+		HeldBytes = 0;
+	}
 
-	RHICmdList.CopyToResolveTarget(SceneContext.GetSceneColorSurface(), SceneContext.GetSceneColorTexture(), FResolveRect(0, 0, FamilySize.X, FamilySize.Y));
+#if !UE_BUILD_SHIPPING
+	/**
+	 * Renders half of the frames with transient targets and half with held ones, then logs the memory of the low res targets and
+	 * the peak use of the render target pool with each. The pool is sampled as the composite ends and as the next frame begins.
+	 */
+	class FReport
+	{
+	public:
+		void Begin(int32 InNumFrames)
+		{
+			check(IsInRenderingThread());
+			NumFrames = FMath::Max(InNumFrames, 2);
+			FrameIndex = 0;
+			Modes[0] = FMode();
+			Modes[1] = FMode();
+		}
 
-	SceneContext.BeginRenderingSceneAlphaCopy(RHICmdList);
+		bool IsActive() const
+		{
+			return FrameIndex < NumFrames;
+		}
 
-	FGraphicsPipelineStateInitializer GraphicsPSOInit;
-	RHICmdList.ApplyCachedRenderTargets(GraphicsPSOInit);
+		bool IsTransientFrame() const
+		{
+			return FrameIndex < NumFrames / 2;
+		}
 
-	GraphicsPSOInit.RasterizerState = TStaticRasterizerState<FM_Solid, CM_None>::GetRHI();
-	GraphicsPSOInit.DepthStencilState = TStaticDepthStencilState<false, CF_Always>::GetRHI();
-	GraphicsPSOInit.BlendState = TStaticBlendState<>::GetRHI();
+		void Sample(uint64 FrameBytes, uint64 HeldBytes)
+		{
+			if (!IsActive())
+			{
+				return;
+			}
 
-	int X = SceneContext.GetBufferSizeXY().X;
-	int Y = SceneContext.GetBufferSizeXY().Y;
+			uint32 WholeCount = 0;
+			uint32 WholePoolInKB = 0;
+			uint32 UsedInKB = 0;
+			GRenderTargetPool.GetStats(WholeCount, WholePoolInKB, UsedInKB);
 
-	RHICmdList.SetViewport(0, 0, 0.0f, X, Y, 1.0f);
+			FMode& Mode = Modes[IsTransientFrame() ? 0 : 1];
+			Mode.TargetBytes = FMath::Max(Mode.TargetBytes, FrameBytes);
+			Mode.HeldBytes = FMath::Max(Mode.HeldBytes, HeldBytes);
+			Mode.PoolUsedKB = FMath::Max(Mode.PoolUsedKB, UsedInKB);
+			Mode.PoolSizeKB = FMath::Max(Mode.PoolSizeKB, WholePoolInKB);
+		}
 
-	TShaderMapRef<FScreenVS> ScreenVertexShader(View.ShaderMap);
-	TShaderMapRef<FMobileCopySceneAlphaPS> PixelShader(View.ShaderMap);
+		/** Called once per frame, logs the results after the last one. */
+		void Advance()
+		{
+			if (!IsActive() || ++FrameIndex < NumFrames)
+			{
+				return;
+			}
 
-	GraphicsPSOInit.BoundShaderState.VertexDeclarationRHI = GFilterVertexDeclaration.VertexDeclarationRHI;
-	GraphicsPSOInit.BoundShaderState.VertexShaderRHI = ScreenVertexShader.GetVertexShader();
-	GraphicsPSOInit.BoundShaderState.PixelShaderRHI = PixelShader.GetPixelShader();
-	GraphicsPSOInit.PrimitiveType = PT_TriangleList;
+			UE_LOG(LogRenderer, Display, TEXT("Mobile off-screen particle low res targets over %d frames:"), NumFrames);
+			UE_LOG(LogRenderer, Display, TEXT("                                  Transient (MB)   Held (MB)"));
+			UE_LOG(LogRenderer, Display, TEXT("  Low res targets of a frame       %14.2f %11.2f"), Modes[0].TargetBytes / (1024.0 * 1024.0), Modes[1].TargetBytes / (1024.0 * 1024.0));
+			UE_LOG(LogRenderer, Display, TEXT("  Held past the composite          %14.2f %11.2f"), Modes[0].HeldBytes / (1024.0 * 1024.0), Modes[1].HeldBytes / (1024.0 * 1024.0));
+			UE_LOG(LogRenderer, Display, TEXT("  Peak render target pool use      %14.2f %11.2f"), Modes[0].PoolUsedKB / 1024.0, Modes[1].PoolUsedKB / 1024.0);
+			UE_LOG(LogRenderer, Display, TEXT("  Peak render target pool size     %14.2f %11.2f"), Modes[0].PoolSizeKB / 1024.0, Modes[1].PoolSizeKB / 1024.0);
+		}
 
-	SetGraphicsPipelineState(RHICmdList, GraphicsPSOInit);
+	private:
+		struct FMode
+		{
+			uint64 TargetBytes = 0;
+			uint64 HeldBytes = 0;
+			uint32 PoolUsedKB = 0;
+			uint32 PoolSizeKB = 0;
+		};
+
+		/** Transient, then held. */
+		FMode Modes[2];
+		int32 NumFrames = 0;
+		int32 FrameIndex = 0;
+	};
+
+	FReport Report;
+#endif
 
-	PixelShader->SetParameters(RHICmdList, View);
+private:
+	TArray<TRefCountPtr<IPooledRenderTarget>> HeldTargets;
+	uint64 HeldBytes = 0;
+	/** Allocated by the current frame. */
+	uint64 FrameBytes = 0;
+};
 
-	DrawRectangle(
-		RHICmdList,
-		0, 0,
-		X, Y,
-		0, 0,
-		X, Y,
-		FIntPoint(X, Y),
-		SceneContext.GetBufferSizeXY(),
-		ScreenVertexShader,
-		EDRF_UseTriangleOptimization);
+static TGlobalResource<FMobileDownsampleTranslucencyTargetLifetime> GMobileDownsampleTranslucencyTargetLifetime;
 
-	SceneContext.FinishRenderingSceneAlphaCopy(RHICmdList);
-}
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommand GMobileDownsampleTranslucencyMemoryReport(
+	TEXT("r.Mobile.OffScreenParticles.MemoryReport"),
+	TEXT("Renders the given number of frames (default 240), the first half with transient mobile off-screen particle low res targets and the\n")
+	TEXT("second half holding them until the next frame, overriding r.Mobile.SeparateTranslucencyTransientTargets. Then logs their memory and\n")
+	TEXT("the peak use of the render target pool with each."),
+	FConsoleCommandWithArgsDelegate::CreateStatic([](const TArray<FString>& Args)
+	{
+		const int32 NumFrames = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 240;
+		ENQUEUE_RENDER_COMMAND(MobileDownsampleTranslucencyMemoryReport)([NumFrames](FRHICommandListImmediate&)
+		{
+			GMobileDownsampleTranslucencyTargetLifetime.Report.Begin(NumFrames);
+		});
+	}));
+#endif
 
-void FMobileSceneRenderer::RenderTranslucency(FRHICommandListImmediate& RHICmdList, const TArrayView<const FViewInfo*> PassViews, bool bRenderToSceneColor, bool bShouldRenderDownSampleTranslucency)
+/** Per view state GPU timers and resolution governors of the mobile off-screen particle pass, keyed by view state. */
+class FMobileDownsampleTranslucencyTimers : public FRenderResource
 {
-	ETranslucencyPass::Type TranslucencyPass = ViewFamily.AllowTranslucencyAfterDOF() ? ETranslucencyPass::TPT_StandardTranslucency : ETranslucencyPass::TPT_AllTranslucency;
-	bool bShouldRenderTranslucency = ShouldRenderTranslucency(TranslucencyPass);
-
-	const float DownsamplingScale = 0.5f;
-	if (bShouldRenderTranslucency)
+public:
+	struct FViewTimer
 	{
-		SCOPED_DRAW_EVENT(RHICmdList, Translucency);
-
-		for (int32 ViewIndex = 0; ViewIndex < PassViews.Num(); ViewIndex++)
+		FViewTimer(FRenderQueryPoolRHIRef QueryPool)
+			: Timer(QueryPool)
+			, CompositeTimer(QueryPool)
+		{}
+
+		/** Depth downsample and low res particles. */
+		FLatentGPUTimer Timer;
+		/** Upsample, separate since it may be recorded inside the scene color pass after the regular translucency. */
+		FLatentGPUTimer CompositeTimer;
+		FMobileDownsampleTranslucencyGovernor Governor;
+		uint32 LastUsedFrameNumber = 0;
+	};
+
+	/** Returns the timer of the view, nullptr for views without persistent state or when timestamps are not supported. */
+	FViewTimer* FindOrAdd(const FViewInfo& View)
+	{
+		if (!View.ViewState || !GSupportsTimestampRenderQueries || !QueryPool.IsValid())
 		{
-			//Test The Particles that have been culling will not increase the number of TranslucentPrimCount
-			//UE_LOG(LogTemp, Log, TEXT("1 : %d, 2 : %d, 3 : %d "), Views[ViewIndex].bHasTranslucentViewMeshElements, Views[ViewIndex].TranslucentPrimCount.Num(TranslucencyPass), ViewIndex);
-			SCOPED_CONDITIONAL_DRAW_EVENTF(RHICmdList, EventView, Views.Num() > 1, TEXT("View%d"), ViewIndex);
+			return nullptr;
+		}
 
-			const FViewInfo& View = *PassViews[ViewIndex];
-			if (!View.ShouldRenderView())
-			{
-				continue;
-			}
+		TUniquePtr<FViewTimer>& ViewTimer = ViewTimers.FindOrAdd(View.ViewState->GetViewKey());
+		if (!ViewTimer.IsValid())
+		{
+			ViewTimer = MakeUnique<FViewTimer>(QueryPool);
+		}
+		ViewTimer->LastUsedFrameNumber = View.Family->FrameNumber;
+		return ViewTimer.Get();
+	}
 
-			// Mobile multi-view is not side by side stereo
-			const FViewInfo& TranslucentViewport = (View.bIsMobileMultiViewEnabled) ? Views[0] : View;
-			RHICmdList.SetViewport(TranslucentViewport.ViewRect.Min.X, TranslucentViewport.ViewRect.Min.Y, 0.0f, TranslucentViewport.ViewRect.Max.X, TranslucentViewport.ViewRect.Max.Y, 1.0f);
+	FViewTimer* Find(const FViewInfo& View)
+	{
+		TUniquePtr<FViewTimer>* ViewTimer = View.ViewState ? ViewTimers.Find(View.ViewState->GetViewKey()) : nullptr;
+		return ViewTimer ? ViewTimer->Get() : nullptr;
+	}
 
-			if (!View.Family->UseDebugViewPS())
+	/** Drops the timers of view states which have not been rendered for a while. */
+	void RemoveStale(uint32 FrameNumber)
+	{
+		const uint32 MaxUnusedFrames = 120;
+		for (auto It = ViewTimers.CreateIterator(); It; ++It)
+		{
+			if (FrameNumber - It.Value()->LastUsedFrameNumber > MaxUnusedFrames)
 			{
-				if (Scene->UniformBuffers.UpdateViewUniformBuffer(View))
-				{
-					UpdateTranslucentBasePassUniformBuffer(RHICmdList, View);
-					UpdateDirectionalLightUniformBuffers(RHICmdList, View);
-				}
-
-				const EMeshPass::Type MeshPass = TranslucencyPassToMeshPass(TranslucencyPass);
-				View.ParallelMeshDrawCommandPasses[MeshPass].DispatchDraw(nullptr, RHICmdList);
+				It.Value()->Timer.Release();
+				It.Value()->CompositeTimer.Release();
+				It.RemoveCurrent();
 			}
 		}
 	}
 
-
-	if (bShouldRenderDownSampleTranslucency) {
-		RenderTranslucency_DownSampleSeparate(RHICmdList, PassViews);
+	virtual void InitRHI() override
+	{
+		QueryPool = RHICreateRenderQueryPool(RQT_AbsoluteTime);
 	}
-}
 
-void FMobileSceneRenderer::RenderTranslucency_DownSampleSeparate(FRHICommandListImmediate& RHICmdList, const TArrayView<const FViewInfo*>& PassViews) {
+	virtual void ReleaseRHI() override
+	{
+		for (auto& Pair : ViewTimers)
+		{
+			Pair.Value->Timer.Release();
+			Pair.Value->CompositeTimer.Release();
+		}
+		ViewTimers.Empty();
+		QueryPool.SafeRelease();
+	}
 
-	const float DownsamplingScale = 0.5f;
+private:
+	FRenderQueryPoolRHIRef QueryPool;
+	TMap<uint32, TUniquePtr<FViewTimer>> ViewTimers;
+};
 
-	RHICmdList.EndRenderPass();
+static TGlobalResource<FMobileDownsampleTranslucencyTimers> GMobileDownsampleTranslucencyTimers;
 
-	SCOPED_DRAW_EVENT(RHICmdList, TranslucencyDownSampleSeparate);
+/** Per view state low res linear depth of the previous frame, reprojected by r.Mobile.SeparateTranslucencyReprojectDepth. */
+class FMobileDownsampleTranslucencyDepthHistory : public FRenderResource
+{
+public:
+	struct FViewHistory
+	{
+		TRefCountPtr<IPooledRenderTarget> LowResDepth;
+		/** Low res view size the history was written at, the view is always at the origin of LowResDepth. */
+		FIntPoint ViewSize = FIntPoint::ZeroValue;
+		uint32 FrameNumber = 0;
+	};
+
+	/** Returns the history of the view, nullptr for views without persistent state. */
+	FViewHistory* FindOrAdd(const FViewInfo& View)
+	{
+		return View.ViewState ? &ViewHistories.FindOrAdd(View.ViewState->GetViewKey()) : nullptr;
+	}
 
-	for (int32 ViewIndex = 0; ViewIndex < PassViews.Num(); ViewIndex++){
+	/** Returns the history written by the previous frame, if it can be reprojected into a view of DownsampledViewSize. */
+	const FViewHistory* FindPreviousFrame(const FViewInfo& View, FIntPoint DownsampledViewSize) const
+	{
+		const FViewHistory* ViewHistory = View.ViewState ? ViewHistories.Find(View.ViewState->GetViewKey()) : nullptr;
+		const bool bValid = ViewHistory
+			&& ViewHistory->LowResDepth.IsValid()
+			&& ViewHistory->ViewSize == DownsampledViewSize
+			&& ViewHistory->FrameNumber + 1 == View.Family->FrameNumber
+			&& !View.bCameraCut
+			&& !View.bPrevTransformsReset;
+		return bValid ? ViewHistory : nullptr;
+	}
 
-		const FViewInfo& View = *PassViews[ViewIndex];
-		if (!View.ShouldRenderView()){
-			continue;
+	/** Drops the histories of view states which have not been rendered for a while. */
+	void RemoveStale(uint32 FrameNumber)
+	{
+		const uint32 MaxUnusedFrames = 120;
+		for (auto It = ViewHistories.CreateIterator(); It; ++It)
+		{
+			if (FrameNumber - It.Value().FrameNumber > MaxUnusedFrames)
+			{
+				It.RemoveCurrent();
+			}
 		}
+	}
 
-		FSceneRenderTargets& SceneContext = FSceneRenderTargets::Get(RHICmdList);
-
-		//SetUp UniformBuffer for DownSampleDepthAndDrawTranslucency Pass
-		FIntPoint SeparateTranslucencyBufferSize = FIntPoint(SceneContext.GetBufferSizeXY().X * DownsamplingScale, SceneContext.GetBufferSizeXY().Y * DownsamplingScale);
-
-		// Update the parts of DownsampledTranslucencyParameters which are dependent on the buffer size and view rect
-		FViewUniformShaderParameters DownsampledTranslucencyViewParameters = *View.CachedViewUniformShaderParameters;
+	virtual void ReleaseRHI() override
+	{
+		ViewHistories.Empty();
+	}
 
-		View.SetupViewRectUniformBufferParameters(
-			DownsampledTranslucencyViewParameters,
-			SeparateTranslucencyBufferSize,
-			FIntRect(View.ViewRect.Min.X * DownsamplingScale, View.ViewRect.Min.Y * DownsamplingScale, View.ViewRect.Max.X * DownsamplingScale, View.ViewRect.Max.Y * DownsamplingScale),
-			View.ViewMatrices,
-			View.PrevViewInfo.ViewMatrices
-		);
+private:
+	TMap<uint32, FViewHistory> ViewHistories;
+};
 
-		Scene->UniformBuffers.ViewUniformBuffer.UpdateUniformBufferImmediate(DownsampledTranslucencyViewParameters);
+static TGlobalResource<FMobileDownsampleTranslucencyDepthHistory> GMobileDownsampleTranslucencyDepthHistory;
 
-		MobileDownSampleDepth(RHICmdList, Views[ViewIndex], DownsamplingScale);
+/** Latent occlusion queries counting the pixels of the upsample and those taking its nearest-depth path, see r.Mobile.SeparateTranslucencyUpsampleClassStats. */
+class FMobileUpsamplePixelClassQueries : public FRenderResource
+{
+public:
+	/** Publishes the counts of the oldest buffered frame and recycles its queries, once per frame before any Allocate. */
+	void Advance()
+	{
+		CurrentFrame = (CurrentFrame + 1) % NumBufferedFrames;
+		FFrameQueries& Frame = Frames[CurrentFrame];
 
-		if (!View.Family->UseDebugViewPS())
+		if (Frame.PixelQueries.Num() > 0)
 		{
-			if (Scene->UniformBuffers.UpdateViewUniformBuffer(View))
+			uint64 Pixels = 0;
+			uint64 EdgePixels = 0;
+			bool bComplete = true;
+			for (int32 QueryIndex = 0; QueryIndex < Frame.PixelQueries.Num() && bComplete; ++QueryIndex)
+			{
+				uint64 ViewPixels = 0;
+				uint64 ViewEdgePixels = 0;
+				bComplete = RHIGetRenderQueryResult(Frame.PixelQueries[QueryIndex].GetQuery(), ViewPixels, false)
+					&& RHIGetRenderQueryResult(Frame.EdgeQueries[QueryIndex].GetQuery(), ViewEdgePixels, false);
+				Pixels += ViewPixels;
+				EdgePixels += ViewEdgePixels;
+			}
+
+			// Results which are still in flight after NumBufferedFrames are dropped rather than stalling
+			if (bComplete)
 			{
-				UpdateTranslucentBasePassUniformBuffer(RHICmdList, View);
-				UpdateDirectionalLightUniformBuffers(RHICmdList, View);
+				LastInteriorPixels = Pixels - FMath::Min(EdgePixels, Pixels);
+				LastEdgePixels = EdgePixels;
 			}
-			View.ParallelMeshDrawCommandPasses[EMeshPass::TranslucencyDownSampleSeparate].DispatchDraw(nullptr, RHICmdList);
+			Frame.PixelQueries.Reset();
+			Frame.EdgeQueries.Reset();
 		}
 
-		RHICmdList.EndRenderPass();
+		SET_DWORD_STAT(STAT_MobileUpsampleInteriorPixels, LastInteriorPixels);
+		SET_DWORD_STAT(STAT_MobileUpsampleEdgePixels, LastEdgePixels);
+		SET_FLOAT_STAT(STAT_MobileUpsampleEdgePixelPercent, LastInteriorPixels + LastEdgePixels > 0 ? 100.0f * LastEdgePixels / (LastInteriorPixels + LastEdgePixels) : 0.0f);
+	}
 
-		//restore ViewUniformBuffer
-		Scene->UniformBuffers.ViewUniformBuffer.UpdateUniformBufferImmediate(*View.CachedViewUniformShaderParameters);
+	/** Allocates the query pair of one upsample for the current frame, nullptr when occlusion queries are not available. */
+	void Allocate(FRHIRenderQuery*& OutPixelQuery, FRHIRenderQuery*& OutEdgeQuery)
+	{
+		OutPixelQuery = nullptr;
+		OutEdgeQuery = nullptr;
+		if (QueryPool.IsValid())
+		{
+			FFrameQueries& Frame = Frames[CurrentFrame];
+			OutPixelQuery = Frame.PixelQueries.Add_GetRef(QueryPool->AllocateQuery()).GetQuery();
+			OutEdgeQuery = Frame.EdgeQueries.Add_GetRef(QueryPool->AllocateQuery()).GetQuery();
+		}
+	}
 
-		UpsampleTranslucency(RHICmdList, View, DownsamplingScale);
+	virtual void InitRHI() override
+	{
+		QueryPool = RHICreateRenderQueryPool(RQT_Occlusion);
 	}
-}
 
+	virtual void ReleaseRHI() override
+	{
+		for (FFrameQueries& Frame : Frames)
+		{
+			Frame.PixelQueries.Empty();
+			Frame.EdgeQueries.Empty();
+		}
+		QueryPool.SafeRelease();
+	}
 
-//////////////////////////////////////////////////////////////////////////
-// Translucent material inverse opacity render code
-// Used to generate inverse opacity channel for scene captures that require opacity information.
-// See MobileSceneCaptureRendering for more details.
+private:
+	static constexpr int32 NumBufferedFrames = 3;
 
-/**
-* Vertex shader for mobile opacity only pass
-*/
-class FOpacityOnlyVS : public FMeshMaterialShader
-{
-	DECLARE_SHADER_TYPE(FOpacityOnlyVS, MeshMaterial);
-protected:
+	struct FFrameQueries
+	{
+		/** All the pixels of the composite draw */
+		TArray<FRHIPooledRenderQuery> PixelQueries;
+		/** Its nearest-depth pixels, drawn again without color writes */
+		TArray<FRHIPooledRenderQuery> EdgeQueries;
+	};
+
+	FRenderQueryPoolRHIRef QueryPool;
+	FFrameQueries Frames[NumBufferedFrames];
+	int32 CurrentFrame = 0;
+	uint64 LastInteriorPixels = 0;
+	uint64 LastEdgePixels = 0;
+};
 
-	FOpacityOnlyVS() {}
-	FOpacityOnlyVS(const FMeshMaterialShaderType::CompiledShaderInitializerType& Initializer) :
-		FMeshMaterialShader(Initializer)
+static TGlobalResource<FMobileUpsamplePixelClassQueries> GMobileUpsamplePixelClassQueries;
+
+/** Tile list and indirect draw arguments of the tile composite, with latent readbacks of the listed tile count. */
+class FMobileUpsampleTileList : public FRenderResource
+{
+public:
+	/** Grows the tile list to hold NumTiles and clears the draw arguments, before each classification. */
+	void Prepare(FRHICommandList& RHICmdList, int32 NumTiles)
 	{
-		PassUniformBuffer.Bind(Initializer.ParameterMap, FMobileBasePassUniformParameters::StaticStructMetadata.GetShaderVariableName());
+		if (NumTiles > MaxTiles)
+		{
+			MaxTiles = FMath::RoundUpToPowerOfTwo(NumTiles);
+			TileList.Release();
+			TileList.Initialize(sizeof(uint32), MaxTiles, PF_R32_UINT, 0, TEXT("MobileUpsampleTileList"));
+		}
+
+		FRHIUnorderedAccessView* UAVs[] = { TileList.UAV, DrawIndirectArgs.UAV };
+		RHICmdList.TransitionResources(EResourceTransitionAccess::ERWBarrier, EResourceTransitionPipeline::EGfxToCompute, UAVs, UE_ARRAY_COUNT(UAVs));
+		RHICmdList.ClearUAVUint(DrawIndirectArgs.UAV, FUintVector4(0, 0, 0, 0));
 	}
 
-public:
+	/** Copies the listed tile count of a view for the stats, NumViewTiles is the tile count of the whole low res view. */
+	void EnqueueReadback(FRHICommandList& RHICmdList, int32 NumViewTiles)
+	{
+		FFrameReadbacks& Frame = Frames[CurrentFrame];
+		if (Frame.NumUsed == Frame.Readbacks.Num())
+		{
+			Frame.Readbacks.Add(MakeUnique<FRHIGPUBufferReadback>(TEXT("MobileUpsampleTileCount")));
+		}
+		Frame.Readbacks[Frame.NumUsed++]->EnqueueCopy(RHICmdList, DrawIndirectArgs.Buffer, DrawIndirectArgsSize);
+		Frame.NumViewTiles += NumViewTiles;
+	}
 
-	static bool ShouldCompilePermutation(const FMeshMaterialShaderPermutationParameters& Parameters)
+	/** Publishes the covered tile percentage of the oldest buffered frame, once per frame before any EnqueueReadback. */
+	void Advance()
 	{
-		return IsTranslucentBlendMode(Parameters.MaterialParameters.BlendMode) && IsMobilePlatform(Parameters.Platform);
+		CurrentFrame = (CurrentFrame + 1) % NumBufferedFrames;
+		FFrameReadbacks& Frame = Frames[CurrentFrame];
+
+		if (Frame.NumUsed > 0)
+		{
+			uint32 NumListedTiles = 0;
+			bool bComplete = true;
+			for (int32 ReadbackIndex = 0; ReadbackIndex < Frame.NumUsed && bComplete; ++ReadbackIndex)
+			{
+				FRHIGPUBufferReadback& Readback = *Frame.Readbacks[ReadbackIndex];
+				bComplete = Readback.IsReady();
+				if (bComplete)
+				{
+					// InstanceCount, one instance per listed tile
+					const uint32* DrawArgs = static_cast<const uint32*>(Readback.Lock(DrawIndirectArgsSize));
+					NumListedTiles += DrawArgs[1];
+					Readback.Unlock();
+				}
+			}
+
+			// Results which are still in flight after NumBufferedFrames are dropped rather than stalling
+			if (bComplete)
+			{
+				LastCoveredTilePercent = Frame.NumViewTiles > 0 ? 100.0f * NumListedTiles / Frame.NumViewTiles : 0.0f;
+			}
+			Frame.NumUsed = 0;
+			Frame.NumViewTiles = 0;
+		}
+
+		SET_FLOAT_STAT(STAT_MobileUpsampleCoveredTilePercent, LastCoveredTilePercent);
 	}
 
-	static void ModifyCompilationEnvironment(const FMaterialShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	virtual void InitRHI() override
 	{
-		static auto* MobileUseHWsRGBEncodingCVAR = IConsoleManager::Get().FindTConsoleVariableDataInt(TEXT("r.Mobile.UseHWsRGBEncoding"));
-		const bool bMobileUseHWsRGBEncoding = (MobileUseHWsRGBEncodingCVAR && MobileUseHWsRGBEncodingCVAR->GetValueOnAnyThread() == 1);
+		DrawIndirectArgs.Initialize(sizeof(uint32), 4, PF_R32_UINT, BUF_DrawIndirect, TEXT("MobileUpsampleTileDrawArgs"));
+	}
 
-		FMeshMaterialShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
-		OutEnvironment.SetDefine(TEXT("OUTPUT_GAMMA_SPACE"), IsMobileHDR() == false && !bMobileUseHWsRGBEncoding);
-		OutEnvironment.SetDefine(TEXT("OUTPUT_MOBILE_HDR"), IsMobileHDR() == true);
+	virtual void ReleaseRHI() override
+	{
+		TileList.Release();
+		DrawIndirectArgs.Release();
+		MaxTiles = 0;
+		for (FFrameReadbacks& Frame : Frames)
+		{
+			Frame.Readbacks.Empty();
+			Frame.NumUsed = 0;
+			Frame.NumViewTiles = 0;
+		}
 	}
+
+	/** Packed low res tile origins, x | y << 16. */
+	FRWBuffer TileList;
+	/** DrawPrimitiveIndirect arguments, six vertices per tile instance. */
+	FRWBuffer DrawIndirectArgs;
+
+private:
+	static constexpr int32 NumBufferedFrames = 3;
+	static constexpr uint32 DrawIndirectArgsSize = 4 * sizeof(uint32);
+
+	struct FFrameReadbacks
+	{
+		TArray<TUniquePtr<FRHIGPUBufferReadback>> Readbacks;
+		int32 NumUsed = 0;
+		int32 NumViewTiles = 0;
+	};
+
+	FFrameReadbacks Frames[NumBufferedFrames];
+	int32 CurrentFrame = 0;
+	int32 MaxTiles = 0;
+	float LastCoveredTilePercent = 0.0f;
 };
 
-IMPLEMENT_MATERIAL_SHADER_TYPE(, FOpacityOnlyVS, TEXT("/Engine/Private/MobileOpacityShaders.usf"), TEXT("MainVS"), SF_Vertex);
+static TGlobalResource<FMobileUpsampleTileList> GMobileUpsampleTileList;
+
+#if !UE_BUILD_SHIPPING
 
 /**
-* Pixel shader for mobile opacity only pass, writes opacity to alpha channel.
-*/
-class FOpacityOnlyPS : public FMeshMaterialShader
+ * Render thread time of DrawDownsampledTranslucencyPass against the number of off-screen particle primitives, recorded serially
+ * and in parallel on alternating frames. Run with -nullrhi to measure the recording alone.
+ */
+class FMobileDownsampleTranslucencyDispatchBenchmark
 {
-	DECLARE_SHADER_TYPE(FOpacityOnlyPS, MeshMaterial);
 public:
+	void Begin(int32 InNumFrames)
+	{
+		check(IsInRenderingThread());
+		NumFramesLeft = FMath::Max(InNumFrames, 2);
+		FrameIndex = 0;
+		for (FBucket& Bucket : Buckets)
+		{
+			Bucket = FBucket();
+		}
+	}
 
-	static bool ShouldCompilePermutation(const FMeshMaterialShaderPermutationParameters& Parameters)
+	bool IsActive() const
 	{
-		return IsTranslucentBlendMode(Parameters.MaterialParameters.BlendMode) && IsMobilePlatform(Parameters.Platform);
+		return NumFramesLeft > 0;
 	}
 
-	static void ModifyCompilationEnvironment(const FMaterialShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	bool ShouldRecordInParallel() const
 	{
-		FMeshMaterialShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
-		OutEnvironment.SetDefine(TEXT("SCENE_TEXTURES_DISABLED"), 1u);
+		return (FrameIndex & 1) != 0;
 	}
 
-	FOpacityOnlyPS(const ShaderMetaType::CompiledShaderInitializerType& Initializer) :
-		FMeshMaterialShader(Initializer)
+	void AddSample(bool bParallel, int32 NumPrimitives, uint32 Cycles)
 	{
-		PassUniformBuffer.Bind(Initializer.ParameterMap, FMobileBasePassUniformParameters::StaticStructMetadata.GetShaderVariableName());
+		FBucket& Bucket = Buckets[FMath::Min<int32>(FMath::CeilLogTwo(NumPrimitives), NumBuckets - 1)];
+		Bucket.Seconds[bParallel ? 1 : 0] += FPlatformTime::ToSeconds(Cycles);
+		Bucket.NumSamples[bParallel ? 1 : 0]++;
 	}
 
-	FOpacityOnlyPS() {}
-};
+	/** Called once per frame, logs the results after the last one. */
+	void Advance()
+	{
+		if (!IsActive())
+		{
+			return;
+		}
+
+		FrameIndex++;
+		if (--NumFramesLeft > 0)
+		{
+			return;
+		}
+
+		UE_LOG(LogRenderer, Display, TEXT("Mobile off-screen particle draw dispatch, render thread time per pass over %d frames:"), FrameIndex);
+		UE_LOG(LogRenderer, Display, TEXT("  Primitives     Serial (us)   Parallel (us)"));
+		for (int32 BucketIndex = 0; BucketIndex < NumBuckets; BucketIndex++)
+		{
+			const FBucket& Bucket = Buckets[BucketIndex];
+			if (Bucket.NumSamples[0] + Bucket.NumSamples[1] > 0)
+			{
+				UE_LOG(LogRenderer, Display, TEXT("  <= %-10d %12.1f %15.1f"),
+					1 << BucketIndex,
+					Bucket.NumSamples[0] ? Bucket.Seconds[0] * 1e6 / Bucket.NumSamples[0] : 0.0,
+					Bucket.NumSamples[1] ? Bucket.Seconds[1] * 1e6 / Bucket.NumSamples[1] : 0.0);
+			}
+		}
+	}
+
+private:
+	/** Power of two buckets of the primitive count. */
+	static constexpr int32 NumBuckets = 16;
+
+	struct FBucket
+	{
+		double Seconds[2] = { 0.0, 0.0 };
+		int32 NumSamples[2] = { 0, 0 };
+	};
+
+	FBucket Buckets[NumBuckets];
+	int32 NumFramesLeft = 0;
+	int32 FrameIndex = 0;
+};
+
+static FMobileDownsampleTranslucencyDispatchBenchmark GMobileDownsampleTranslucencyDispatchBenchmark;
+
+static FAutoConsoleCommand GBenchmarkMobileDownsampleTranslucencyDispatch(
+	TEXT("r.Mobile.OffScreenParticles.BenchmarkDispatch"),
+	TEXT("Alternates serial and parallel recording of the mobile off-screen particle draws for the given number of frames (default 240),\n")
+	TEXT("then logs the render thread time of both against the number of off-screen particle primitives."),
+	FConsoleCommandWithArgsDelegate::CreateStatic([](const TArray<FString>& Args)
+	{
+		const int32 NumFrames = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 240;
+		ENQUEUE_RENDER_COMMAND(BenchmarkMobileDownsampleTranslucencyDispatch)([NumFrames](FRHICommandListImmediate&)
+		{
+			GMobileDownsampleTranslucencyDispatchBenchmark.Begin(NumFrames);
+		});
+	}));
+
+#endif // !UE_BUILD_SHIPPING
+
+/** Whether the tile composite can run on a platform, it appends to the tile list with buffer atomics. */
+static bool IsMobileUpsampleTileCompositeSupported(EShaderPlatform Platform)
+{
+	return RHISupportsComputeShaders(Platform) && !IsOpenGLPlatform(Platform);
+}
+
+/** Bytes moved between tile memory and a render target by a single full load or store, zero for memoryless targets. */
+static uint64 GetRenderTargetTransferBytes(FRHITexture* Texture)
+{
+	if (!Texture || (Texture->GetFlags() & TexCreate_Memoryless) != 0)
+	{
+		return 0;
+	}
+
+	const FIntVector Size = Texture->GetSizeXYZ();
+	return uint64(Size.X) * Size.Y * GPixelFormats[Texture->GetFormat()].BlockBytes * Texture->GetNumSamples();
+}
+
+void FMobileSceneRenderer::FDownsampledTranslucencyTier::AllocateColor(FRHICommandList& RHICmdList, FIntPoint BufferSize, bool bMultiView, const TCHAR* Name)
+{
+	const EMobileDownsampleTranslucencyColorFormat Format = GetMobileDownsampleTranslucencyColorFormat();
+	const int32 ArraySize = bMultiView ? 2 : 1;
+
+	// Cleared to no contribution: black and fully transmissive
+	FPooledRenderTargetDesc ColorDesc(FPooledRenderTargetDesc::Create2DDesc(BufferSize, GetMobileDownsampleTranslucencyColorPixelFormat(Format), FClearValueBinding::Black, TexCreate_None, TexCreate_RenderTargetable | TexCreate_ShaderResource, false));
+	ColorDesc.ArraySize = ArraySize;
+	ColorDesc.bIsArray = bMultiView;
+	GMobileDownsampleTranslucencyTargetLifetime.FindFreeElement(RHICmdList, ColorDesc, Color, Name);
+	const uint64 Bytes = uint64(BufferSize.X) * BufferSize.Y * ArraySize * GPixelFormats[ColorDesc.Format].BlockBytes;
+	INC_FLOAT_STAT_BY(STAT_MobileDownsampleTranslucencyColorMB, float(Bytes / (1024.0 * 1024.0)));
+}
+
+void FMobileSceneRenderer::ReleaseDownsampledTranslucencyTargets()
+{
+	for (FDownsampledTranslucencyTier& Tier : DownsampledTranslucencyTiers)
+	{
+		GMobileDownsampleTranslucencyTargetLifetime.Release(Tier.Color);
+		GMobileDownsampleTranslucencyTargetLifetime.Release(Tier.Depth);
+	}
+	GMobileDownsampleTranslucencyTargetLifetime.Release(DownsampledTranslucencyMinMaxDepthRT);
+	GMobileDownsampleTranslucencyTargetLifetime.EndFrame();
+}
+
+void FMobileSceneRenderer::AccountRenderPassBandwidth(const FRHIRenderPassInfo& RPInfo)
+{
+	uint64 LoadBytes = 0;
+	uint64 StoreBytes = 0;
+
+	for (int32 Index = 0; Index < RPInfo.GetNumColorRenderTargets(); ++Index)
+	{
+		const FRHIRenderPassInfo::FColorEntry& ColorEntry = RPInfo.ColorRenderTargets[Index];
+		if (GetLoadAction(ColorEntry.Action) == ERenderTargetLoadAction::ELoad)
+		{
+			LoadBytes += GetRenderTargetTransferBytes(ColorEntry.RenderTarget);
+		}
+		if (GetStoreAction(ColorEntry.Action) == ERenderTargetStoreAction::EStore)
+		{
+			StoreBytes += GetRenderTargetTransferBytes(ColorEntry.RenderTarget);
+		}
+		else if (GetStoreAction(ColorEntry.Action) == ERenderTargetStoreAction::EMultisampleResolve)
+		{
+			StoreBytes += GetRenderTargetTransferBytes(ColorEntry.ResolveTarget);
+		}
+	}
+
+	FRHITexture* DepthStencilTarget = RPInfo.DepthStencilRenderTarget.DepthStencilTarget;
+	const ERenderTargetActions DepthActions = GetDepthActions(RPInfo.DepthStencilRenderTarget.Action);
+	if (GetLoadAction(DepthActions) == ERenderTargetLoadAction::ELoad)
+	{
+		LoadBytes += GetRenderTargetTransferBytes(DepthStencilTarget);
+	}
+	if (GetStoreAction(DepthActions) == ERenderTargetStoreAction::EStore)
+	{
+		StoreBytes += GetRenderTargetTransferBytes(DepthStencilTarget);
+	}
+
+	// A pass which loads its color target resumes what an earlier pass of the frame stored: the scene color pass after a break
+	if (RPInfo.GetNumColorRenderTargets() > 0 && GetLoadAction(RPInfo.ColorRenderTargets[0].Action) == ERenderTargetLoadAction::ELoad)
+	{
+		INC_DWORD_STAT(STAT_MobileSceneColorRenderPassBreaks);
+	}
+	INC_FLOAT_STAT_BY(STAT_MobileSceneColorLoadMB, float(LoadBytes / (1024.0 * 1024.0)));
+	INC_FLOAT_STAT_BY(STAT_MobileSceneColorStoreMB, float(StoreBytes / (1024.0 * 1024.0)));
+}
+
+/** Size of the off-screen particle target for a full res size, never smaller than one texel. */
+static FIntPoint GetDownsampledTranslucencySize(FIntPoint FullResSize, float DownsamplingScale)
+{
+	return FIntPoint(
+		FMath::Max(1, FMath::CeilToInt(FullResSize.X * DownsamplingScale)),
+		FMath::Max(1, FMath::CeilToInt(FullResSize.Y * DownsamplingScale)));
+}
+
+/** Resolution scale of a fixed off-screen particle tier, the Auto tier uses FViewInfo::MobileDownsampleTranslucencyScale. */
+static float GetDownsampledTranslucencyTierScale(EMobileDownsampleTranslucencyResolution Resolution)
+{
+	switch (Resolution)
+	{
+	case EMobileDownsampleTranslucencyResolution::Full: return FMobileDownsampleTranslucencyGovernor::GetResolutionScale(FMobileDownsampleTranslucencyGovernor::EResolution::Full);
+	case EMobileDownsampleTranslucencyResolution::Half: return FMobileDownsampleTranslucencyGovernor::GetResolutionScale(FMobileDownsampleTranslucencyGovernor::EResolution::Half);
+	case EMobileDownsampleTranslucencyResolution::Quarter: return FMobileDownsampleTranslucencyGovernor::GetResolutionScale(FMobileDownsampleTranslucencyGovernor::EResolution::Quarter);
+	}
+
+	checkNoEntry();
+	return 0.5f;
+}
+
+/** Resolution scale of an off-screen particle tier in a view. */
+static float GetDownsampledTranslucencyViewScale(const FViewInfo& View, EMobileDownsampleTranslucencyResolution Resolution)
+{
+	return Resolution == EMobileDownsampleTranslucencyResolution::Auto ? View.MobileDownsampleTranslucencyScale : GetDownsampledTranslucencyTierScale(Resolution);
+}
+
+/** Cleared low res texels between two views of an atlas, the bilinear footprint of the edge of a view never reaches the next one. */
+static constexpr int32 DownsampledTranslucencyAtlasGutter = 1;
+
+/** Mean distance of the primitives of a tier to the view origin, the tiers are composited from the farthest to the closest. */
+static float GetDownsampledTranslucencyTierDistance(const FScene* Scene, const FViewInfo& View, EMobileDownsampleTranslucencyResolution Resolution)
+{
+	const TArray<int32, SceneRenderingAllocator>& Primitives = View.MobileDownsampleTranslucencyPrimitives[(int32)Resolution];
+	if (Primitives.Num() == 0)
+	{
+		return 0.0f;
+	}
+
+	const FVector ViewOrigin = View.ViewMatrices.GetViewOrigin();
+	float DistanceSum = 0.0f;
+	for (int32 PrimitiveIndex : Primitives)
+	{
+		DistanceSum += FVector::Dist(Scene->PrimitiveBounds[PrimitiveIndex].BoxSphereBounds.Origin, ViewOrigin);
+	}
+	return DistanceSum / Primitives.Num();
+}
+
+typedef TArray<EMobileDownsampleTranslucencyResolution, TInlineAllocator<(int32)EMobileDownsampleTranslucencyResolution::Num>> FDownsampledTranslucencyCompositeOrder;
+
+/** The tiers ShouldComposite accepts, from the farthest to the closest: they are blended one over another. */
+template<typename ShouldCompositeType>
+static FDownsampledTranslucencyCompositeOrder GetDownsampledTranslucencyCompositeOrder(const FScene* Scene, const FViewInfo& View, ShouldCompositeType ShouldComposite)
+{
+	TArray<TPair<float, EMobileDownsampleTranslucencyResolution>, TInlineAllocator<(int32)EMobileDownsampleTranslucencyResolution::Num>> SortedResolutions;
+	for (int32 ResolutionIndex = (int32)EMobileDownsampleTranslucencyResolution::Full; ResolutionIndex <= (int32)EMobileDownsampleTranslucencyResolution::Auto; ResolutionIndex++)
+	{
+		const EMobileDownsampleTranslucencyResolution Resolution = (EMobileDownsampleTranslucencyResolution)ResolutionIndex;
+		if (ShouldComposite(Resolution))
+		{
+			SortedResolutions.Emplace(GetDownsampledTranslucencyTierDistance(Scene, View, Resolution), Resolution);
+		}
+	}
+	SortedResolutions.Sort([](const TPair<float, EMobileDownsampleTranslucencyResolution>& A, const TPair<float, EMobileDownsampleTranslucencyResolution>& B)
+	{
+		return A.Key > B.Key;
+	});
+
+	FDownsampledTranslucencyCompositeOrder Resolutions;
+	for (const TPair<float, EMobileDownsampleTranslucencyResolution>& SortedResolution : SortedResolutions)
+	{
+		Resolutions.Add(SortedResolution.Value);
+	}
+	return Resolutions;
+}
+
+/** Low res targets of one off-screen particle tier, as read by the upsample shaders. */
+struct FDownsampledTranslucencyInputs
+{
+	FRHITexture* Color = nullptr;
+	FRHITexture* Depth = nullptr;
+	/** Optional, enables the MOBILE_TRANSLUCENCY_UPSAMPLE_MINMAX classification. */
+	FRHITexture* MinMaxDepth = nullptr;
+	/** Full res pixels the tier can touch, relative to ViewRect.Min. */
+	FIntRect Rect;
+	float DownsamplingScale = 0.5f;
+	/** Top left corner of the low res view in the targets, not at the origin when the views share an atlas. */
+	FIntPoint ViewMin = FIntPoint::ZeroValue;
+};
+
+/**
+ * Adds the estimated traffic of the low res color of a tier to the stats: stored once by the low res pass and read once by the upsample,
+ * over the texels of the views the upsample can touch.
+ */
+static void AccountDownsampledTranslucencyColorTraffic(const FDownsampledTranslucencyInputs& LowRes, int32 NumViews)
+{
+	const FIntPoint LowResSize = GetDownsampledTranslucencySize(LowRes.Rect.Size(), LowRes.DownsamplingScale);
+	const uint64 BytesPerTexel = GPixelFormats[LowRes.Color->GetFormat()].BlockBytes;
+	INC_FLOAT_STAT_BY(STAT_MobileDownsampleTranslucencyColorTrafficMB, float(2 * uint64(LowResSize.X) * LowResSize.Y * NumViews * BytesPerTexel / (1024.0 * 1024.0)));
+}
+
+
+/** Pixel shader used to copy scene color into another texture so that materials can read from scene color with a node. */
+class FMobileCopySceneAlphaPS : public FGlobalShader
+{
+	DECLARE_SHADER_TYPE(FMobileCopySceneAlphaPS, Global);
+public:
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters) { return IsMobilePlatform(Parameters.Platform); }
+
+	FMobileCopySceneAlphaPS(const ShaderMetaType::CompiledShaderInitializerType& Initializer) :
+		FGlobalShader(Initializer)
+	{
+		SceneTextureParameters.Bind(Initializer);
+	}
+	FMobileCopySceneAlphaPS() {}
+
+	void SetParameters(FRHICommandList& RHICmdList, const FSceneView& View)
+	{
+		SceneTextureParameters.Set(RHICmdList, RHICmdList.GetBoundPixelShader(), View.FeatureLevel, ESceneTextureSetupMode::All);
+	}
+
+private:
+	LAYOUT_FIELD(FSceneTextureShaderParameters, SceneTextureParameters)
+};
+
+IMPLEMENT_SHADER_TYPE(, FMobileCopySceneAlphaPS, TEXT("/Engine/Private/TranslucentLightingShaders.usf"), TEXT("CopySceneAlphaMain"), SF_Pixel);
+
+void FMobileSceneRenderer::CopySceneAlpha(FRHICommandListImmediate& RHICmdList, const FViewInfo& View)
+{
+	SCOPED_DRAW_EVENTF(RHICmdList, EventCopy, TEXT("CopySceneAlpha"));
+	FSceneRenderTargets& SceneContext = FSceneRenderTargets::Get(RHICmdList);
+
+	RHICmdList.CopyToResolveTarget(SceneContext.GetSceneColorSurface(), SceneContext.GetSceneColorTexture(), FResolveRect(0, 0, FamilySize.X, FamilySize.Y));
+
+	SceneContext.BeginRenderingSceneAlphaCopy(RHICmdList);
+
+	FGraphicsPipelineStateInitializer GraphicsPSOInit;
+	RHICmdList.ApplyCachedRenderTargets(GraphicsPSOInit);
+
+	GraphicsPSOInit.RasterizerState = TStaticRasterizerState<FM_Solid, CM_None>::GetRHI();
+	GraphicsPSOInit.DepthStencilState = TStaticDepthStencilState<false, CF_Always>::GetRHI();
+	GraphicsPSOInit.BlendState = TStaticBlendState<>::GetRHI();
+
+	int X = SceneContext.GetBufferSizeXY().X;
+	int Y = SceneContext.GetBufferSizeXY().Y;
+
+	RHICmdList.SetViewport(0, 0, 0.0f, X, Y, 1.0f);
+
+	TShaderMapRef<FScreenVS> ScreenVertexShader(View.ShaderMap);
+	TShaderMapRef<FMobileCopySceneAlphaPS> PixelShader(View.ShaderMap);
+
+	GraphicsPSOInit.BoundShaderState.VertexDeclarationRHI = GFilterVertexDeclaration.VertexDeclarationRHI;
+	GraphicsPSOInit.BoundShaderState.VertexShaderRHI = ScreenVertexShader.GetVertexShader();
+	GraphicsPSOInit.BoundShaderState.PixelShaderRHI = PixelShader.GetPixelShader();
+	GraphicsPSOInit.PrimitiveType = PT_TriangleList;
+
+	SetGraphicsPipelineState(RHICmdList, GraphicsPSOInit);
+
+	PixelShader->SetParameters(RHICmdList, View);
+
+	DrawRectangle(
+		RHICmdList,
+		0, 0,
+		X, Y,
+		0, 0,
+		X, Y,
+		FIntPoint(X, Y),
+		SceneContext.GetBufferSizeXY(),
+		ScreenVertexShader,
+		EDRF_UseTriangleOptimization);
+
+	SceneContext.FinishRenderingSceneAlphaCopy(RHICmdList);
+}
+
+void FMobileSceneRenderer::RenderTranslucency(FRHICommandListImmediate& RHICmdList, const TArrayView<const FViewInfo*> PassViews, bool bRenderToSceneColor, EDownSampleTranslucencyMode DownSampleTranslucencyMode)
+{
+	ETranslucencyPass::Type TranslucencyPass = ViewFamily.AllowTranslucencyAfterDOF() ? ETranslucencyPass::TPT_StandardTranslucency : ETranslucencyPass::TPT_AllTranslucency;
+	bool bShouldRenderTranslucency = ShouldRenderTranslucency(TranslucencyPass);
+
+	if (bShouldRenderTranslucency)
+	{
+		SCOPED_DRAW_EVENT(RHICmdList, Translucency);
+
+		for (int32 ViewIndex = 0; ViewIndex < PassViews.Num(); ViewIndex++)
+		{
+			//Test The Particles that have been culling will not increase the number of TranslucentPrimCount
+			//UE_LOG(LogTemp, Log, TEXT("1 : %d, 2 : %d, 3 : %d "), Views[ViewIndex].bHasTranslucentViewMeshElements, Views[ViewIndex].TranslucentPrimCount.Num(TranslucencyPass), ViewIndex);
+			SCOPED_CONDITIONAL_DRAW_EVENTF(RHICmdList, EventView, Views.Num() > 1, TEXT("View%d"), ViewIndex);
+
+			const FViewInfo& View = *PassViews[ViewIndex];
+			if (!View.ShouldRenderView())
+			{
+				continue;
+			}
+
+			// Mobile multi-view is not side by side stereo
+			const FViewInfo& TranslucentViewport = (View.bIsMobileMultiViewEnabled) ? Views[0] : View;
+			RHICmdList.SetViewport(TranslucentViewport.ViewRect.Min.X, TranslucentViewport.ViewRect.Min.Y, 0.0f, TranslucentViewport.ViewRect.Max.X, TranslucentViewport.ViewRect.Max.Y, 1.0f);
+
+			if (!View.Family->UseDebugViewPS())
+			{
+				if (Scene->UniformBuffers.UpdateViewUniformBuffer(View))
+				{
+					UpdateTranslucentBasePassUniformBuffer(RHICmdList, View);
+					UpdateDirectionalLightUniformBuffers(RHICmdList, View);
+				}
+
+				const EMeshPass::Type MeshPass = TranslucencyPassToMeshPass(TranslucencyPass);
+				View.ParallelMeshDrawCommandPasses[MeshPass].DispatchDraw(nullptr, RHICmdList);
+			}
+		}
+	}
+
+
+	if (DownSampleTranslucencyMode == EDownSampleTranslucencyMode::CompositeInPass || DownSampleTranslucencyMode == EDownSampleTranslucencyMode::ReprojectedDepth)
+	{
+		// The low res pass was rendered before the scene color pass (re)started, composite as its last draw
+		CompositeTranslucency_DownSampleSeparate(RHICmdList, PassViews, true);
+	}
+	else if (DownSampleTranslucencyMode == EDownSampleTranslucencyMode::MultiView)
+	{
+		RHICmdList.EndRenderPass();
+		RenderTranslucency_DownSampleSeparateMultiView(RHICmdList);
+		CompositeTranslucency_DownSampleSeparateMultiView(RHICmdList);
+	}
+	else if (DownSampleTranslucencyMode == EDownSampleTranslucencyMode::RenderGraph)
+	{
+		RHICmdList.EndRenderPass();
+		RenderTranslucency_DownSampleSeparateGraph(RHICmdList, PassViews);
+	}
+	else if (DownSampleTranslucencyMode == EDownSampleTranslucencyMode::FullResInPass)
+	{
+		RenderTranslucency_DownSampleSeparateFullRes(RHICmdList, PassViews);
+	}
+	else if (DownSampleTranslucencyMode == EDownSampleTranslucencyMode::SeparatePass)
+	{
+		bDownsampledTranslucencyAtlas = ShouldShareDownsampledTranslucencyAtlas();
+		if (bDownsampledTranslucencyAtlas)
+		{
+			// The low res views lie side by side in the off-screen targets, every tier is rendered by one pass and all views are composited by one
+			RHICmdList.EndRenderPass();
+			RenderTranslucency_DownSampleSeparate(RHICmdList, PassViews, false);
+			CompositeTranslucency_DownSampleSeparate(RHICmdList, PassViews, false);
+		}
+		else
+		{
+			// Views share the off-screen targets, each one is composited before the next one is rendered
+			for (int32 ViewIndex = 0; ViewIndex < PassViews.Num(); ViewIndex++)
+			{
+				RHICmdList.EndRenderPass();
+				const TArrayView<const FViewInfo*> SingleView = MakeArrayView(&PassViews[ViewIndex], 1);
+				RenderTranslucency_DownSampleSeparate(RHICmdList, SingleView, false);
+				CompositeTranslucency_DownSampleSeparate(RHICmdList, SingleView, false);
+			}
+		}
+	}
+}
+
+FMobileSceneRenderer::EDownSampleTranslucencyMode FMobileSceneRenderer::GetDownSampleTranslucencyMode(bool bCanSplitSceneColorPass, bool bSceneColorPassSplit, bool bCanStoreSceneDepth, bool bCanEndSceneColorPass) const
+{
+	// The scene color pass renders into the multi-view targets exactly when it renders to the back buffer, which can't be split.
+	// The pass is ended after translucency, the Adreno occlusion queries drawn after it then fall back to the separate composite pass.
+	if (bCanEndSceneColorPass && !bCanSplitSceneColorPass && ShouldRenderDownsampledTranslucencyMultiView())
+	{
+		return EDownSampleTranslucencyMode::MultiView;
+	}
+
+	// The per view passes composite onto the scene color surface and skip the right eye, which mobile multi-view renders into the
+	// multi-view scene color as the same view. Without the multi-view passes (MSAA, Adreno occlusion mode, or disabled) the particles
+	// are drawn at full res in the scene color pass instead.
+	if (Views[0].bIsMobileMultiViewEnabled)
+	{
+		return EDownSampleTranslucencyMode::FullResInPass;
+	}
+
+	if (bCanEndSceneColorPass && bCanStoreSceneDepth && CVarMobileSeparateTranslucencyRenderGraph.GetValueOnRenderThread() != 0)
+	{
+		return EDownSampleTranslucencyMode::RenderGraph;
+	}
+
+	// The fixed resolution tiers downsample the current frame's depth, only the Auto tier can be reprojected
+	const bool bHasFixedResolutionTiers = HasDownsampledTranslucencyDraws(Views[0], EMobileDownsampleTranslucencyResolution::Full, EMobileDownsampleTranslucencyResolution::Quarter);
+
+	if (ShouldUpdateDownsampledTranslucencyDepthHistory(bCanStoreSceneDepth) && !bHasFixedResolutionTiers)
+	{
+		const FViewInfo& View = Views[0];
+		const FIntPoint DownsampledViewSize = GetDownsampledTranslucencySize(View.ViewRect.Size(), View.MobileDownsampleTranslucencyScale);
+		if (GMobileDownsampleTranslucencyDepthHistory.FindPreviousFrame(View, DownsampledViewSize))
+		{
+			return EDownSampleTranslucencyMode::ReprojectedDepth;
+		}
+		// No usable history this frame, it is written at the end of this one
+	}
+
+	// Views share the off-screen targets, so only a single view can have its low res pass hoisted in front of the translucency.
+	// Splitting the scene color pass for it would store and reload scene color once, as the separate composite pass does, so only
+	// a split which is already there is taken.
+	return bSceneColorPassSplit && bCanSplitSceneColorPass && Views.Num() == 1 ? EDownSampleTranslucencyMode::CompositeInPass : EDownSampleTranslucencyMode::SeparatePass;
+}
+
+bool FMobileSceneRenderer::ShouldRenderDownsampledTranslucencyMultiView() const
+{
+	if (Views.Num() < 2 || !Views[0].bIsMobileMultiViewEnabled || CVarMobileSeparateTranslucencyMultiView.GetValueOnRenderThread() == 0)
+	{
+		return false;
+	}
+
+	// The composite loads the multi-view scene color, which can't be a MSAA target resolved by the scene color pass
+	const FSceneRenderTargets& SceneContext = FSceneRenderTargets::Get_FrameConstantsOnly();
+	return SceneContext.MobileMultiViewSceneColor && SceneContext.MobileMultiViewSceneDepthZ && SceneContext.MobileMultiViewSceneColor->GetDesc().NumSamples <= 1;
+}
+
+bool FMobileSceneRenderer::ShouldUpdateDownsampledTranslucencyDepthHistory(bool bCanStoreSceneDepth) const
+{
+	return bCanStoreSceneDepth && Views.Num() == 1 && CVarMobileSeparateTranslucencyReprojectDepth.GetValueOnRenderThread() != 0;
+}
+
+bool FMobileSceneRenderer::HasDownsampledTranslucencyDraws(const FViewInfo& View, EMobileDownsampleTranslucencyResolution FirstResolution, EMobileDownsampleTranslucencyResolution LastResolution)
+{
+	for (int32 ResolutionIndex = (int32)FirstResolution; ResolutionIndex <= (int32)LastResolution; ResolutionIndex++)
+	{
+		const EMeshPass::Type MeshPass = TranslucencyPassToMeshPass(GetMobileDownsampleTranslucencyPass((EMobileDownsampleTranslucencyResolution)ResolutionIndex));
+		if (View.ParallelMeshDrawCommandPasses[MeshPass].HasAnyDraw())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FMobileSceneRenderer::ShouldShareDownsampledTranslucencyAtlas() const
+{
+	if (Views.Num() < 2 || CVarMobileSeparateTranslucencyViewAtlas.GetValueOnRenderThread() == 0)
+	{
+		return false;
+	}
+
+	int32 NumViews = 0;
+	for (const FViewInfo& View : Views)
+	{
+		if (View.ShouldRenderView() && HasDownsampledTranslucencyDraws(View))
+		{
+			NumViews++;
+		}
+	}
+
+	// The views are laid out in a single row, a row wider than a texture falls back to a pass per view
+	bool bFitsInTexture = true;
+	for (int32 ResolutionIndex = (int32)EMobileDownsampleTranslucencyResolution::Full; ResolutionIndex <= (int32)EMobileDownsampleTranslucencyResolution::Auto; ResolutionIndex++)
+	{
+		bFitsInTexture &= GetDownsampledTranslucencyAtlasSize((EMobileDownsampleTranslucencyResolution)ResolutionIndex).X <= (int32)GetMax2DTextureDimension();
+	}
+	return NumViews > 1 && bFitsInTexture;
+}
+
+FIntPoint FMobileSceneRenderer::GetDownsampledTranslucencyAtlasSize(EMobileDownsampleTranslucencyResolution Resolution) const
+{
+	FIntPoint AtlasSize = FIntPoint::ZeroValue;
+	for (const FViewInfo& View : Views)
+	{
+		if (View.ShouldRenderView() && HasDownsampledTranslucencyDraws(View, Resolution, Resolution))
+		{
+			const FIntPoint DownsampledViewSize = GetDownsampledTranslucencySize(View.ViewRect.Size(), GetDownsampledTranslucencyViewScale(View, Resolution));
+			AtlasSize.X += DownsampledViewSize.X + DownsampledTranslucencyAtlasGutter;
+			AtlasSize.Y = FMath::Max(AtlasSize.Y, DownsampledViewSize.Y);
+		}
+	}
+	return AtlasSize;
+}
+
+FIntRect FMobileSceneRenderer::GetDownsampledTranslucencyViewRect(const FViewInfo& View, EMobileDownsampleTranslucencyResolution Resolution) const
+{
+	FIntPoint ViewMin = FIntPoint::ZeroValue;
+	if (bDownsampledTranslucencyAtlas)
+	{
+		// Same layout as GetDownsampledTranslucencyAtlasSize: in view order, views without draws in the tier take no room
+		for (const FViewInfo& PrevView : Views)
+		{
+			if (&PrevView == &View)
+			{
+				break;
+			}
+			if (PrevView.ShouldRenderView() && HasDownsampledTranslucencyDraws(PrevView, Resolution, Resolution))
+			{
+				ViewMin.X += GetDownsampledTranslucencySize(PrevView.ViewRect.Size(), GetDownsampledTranslucencyViewScale(PrevView, Resolution)).X + DownsampledTranslucencyAtlasGutter;
+			}
+		}
+	}
+	return FIntRect(ViewMin, ViewMin + GetDownsampledTranslucencySize(View.ViewRect.Size(), GetDownsampledTranslucencyViewScale(View, Resolution)));
+}
+
+FDownsampledTranslucencyInputs FMobileSceneRenderer::GetDownsampledTranslucencyInputs(const FViewInfo& View, EMobileDownsampleTranslucencyResolution Resolution, FRHITexture* Color, FRHITexture* Depth) const
+{
+	FDownsampledTranslucencyInputs LowRes;
+	LowRes.Color = Color;
+	LowRes.Depth = Depth;
+	if (Resolution == EMobileDownsampleTranslucencyResolution::Auto)
+	{
+		LowRes.Rect = View.MobileDownsampleTranslucencyRect;
+		LowRes.DownsamplingScale = View.MobileDownsampleTranslucencyScale;
+	}
+	else
+	{
+		LowRes.Rect = FIntRect(FIntPoint::ZeroValue, View.ViewRect.Size());
+		LowRes.DownsamplingScale = GetDownsampledTranslucencyTierScale(Resolution);
+	}
+	LowRes.ViewMin = GetDownsampledTranslucencyViewRect(View, Resolution).Min;
+	return LowRes;
+}
+
+FIntPoint FMobileSceneRenderer::GetDownsampledTranslucencyTargetSize(const FViewInfo& View, EMobileDownsampleTranslucencyResolution Resolution) const
+{
+	if (bDownsampledTranslucencyAtlas)
+	{
+		return GetDownsampledTranslucencyAtlasSize(Resolution);
+	}
+
+	// A single view, the targets are sized like the buffer so the pool keeps them across view size changes
+	const FSceneRenderTargets& SceneContext = FSceneRenderTargets::Get_FrameConstantsOnly();
+	return GetDownsampledTranslucencySize(SceneContext.GetBufferSizeXY(), GetDownsampledTranslucencyViewScale(View, Resolution));
+}
+
+void FMobileSceneRenderer::InitDownsampleTranslucencyScales(FRHICommandListImmediate& RHICmdList)
+{
+#if !UE_BUILD_SHIPPING
+	GMobileDownsampleTranslucencyDispatchBenchmark.Advance();
+#endif
+	GMobileDownsampleTranslucencyTargetLifetime.BeginFrame();
+
+	const float ScreenPercentage = CVarMobileSeparateTranslucencyScreenPercentage.GetValueOnRenderThread();
+	const float DownsamplingScale = ScreenPercentage > 0.0f ? FMath::Min(ScreenPercentage / 100.0f, 1.0f) : 0.5f;
+	const bool bAutoDownsample = CVarMobileSeparateTranslucencyAutoDownsample.GetValueOnRenderThread() != 0;
+	const int32 MinViewHeight = CVarMobileSeparateTranslucencyMinViewHeight.GetValueOnRenderThread();
+
+	FMobileDownsampleTranslucencyGovernor::FSettings GovernorSettings;
+	GovernorSettings.DownsampleThresholdMS = CVarMobileSeparateTranslucencyDurationDownsampleThreshold.GetValueOnRenderThread();
+	GovernorSettings.UpsampleThresholdMS = CVarMobileSeparateTranslucencyDurationUpsampleThreshold.GetValueOnRenderThread();
+	GovernorSettings.MinChangeTimeSeconds = CVarMobileSeparateTranslucencyMinDownsampleChangeTime.GetValueOnRenderThread();
+
+	float MostRecentTotalTime = 0.0f;
+	for (FViewInfo& View : Views)
+	{
+		View.MobileDownsampleTranslucencyScale = DownsamplingScale;
+		View.MobileDownsampleTranslucencyRect = FIntRect(FIntPoint::ZeroValue, View.ViewRect.Size());
+
+		FMobileDownsampleTranslucencyTimers::FViewTimer* ViewTimer = bAutoDownsample ? GMobileDownsampleTranslucencyTimers.FindOrAdd(View) : nullptr;
+		if (ViewTimer)
+		{
+			// Timings are latent, they belong to a frame a few frames back. MinChangeTimeSeconds covers that latency.
+			const bool bHasTiming = ViewTimer->Timer.Tick(RHICmdList);
+			const bool bHasCompositeTiming = ViewTimer->CompositeTimer.Tick(RHICmdList);
+			if (bHasTiming && bHasCompositeTiming)
+			{
+				const float LastFrameDurationMS = ViewTimer->Timer.GetTimeMS() + ViewTimer->CompositeTimer.GetTimeMS();
+				ViewTimer->Governor.Update(LastFrameDurationMS, View.Family->CurrentRealTime, GovernorSettings);
+				MostRecentTotalTime += LastFrameDurationMS;
+			}
+			View.MobileDownsampleTranslucencyScale = FMobileDownsampleTranslucencyGovernor::GetResolutionScale(ViewTimer->Governor.GetResolution());
+		}
+
+		// The device profile's scale is meant for full screen views, a small view would be left with too few texels to resolve the particles
+		if (MinViewHeight > 0 && View.ViewRect.Height() > 0)
+		{
+			View.MobileDownsampleTranslucencyScale = FMath::Clamp(float(MinViewHeight) / View.ViewRect.Height(), View.MobileDownsampleTranslucencyScale, 1.0f);
+		}
+
+		if (CVarMobileSeparateTranslucencyScissor.GetValueOnRenderThread() != 0)
+		{
+			// Padded by the bilinear footprint of a low res texel, the upsample spreads the particles that far
+			const FIntPoint DownsampledViewSize = GetDownsampledTranslucencySize(View.ViewRect.Size(), View.MobileDownsampleTranslucencyScale);
+			View.MobileDownsampleTranslucencyRect = MobileDownsampleTranslucencyScissor::ComputeViewRect(
+				Scene->PrimitiveBounds,
+				View.MobileDownsampleTranslucencyPrimitives[(int32)EMobileDownsampleTranslucencyResolution::Auto],
+				View.ViewMatrices.GetTranslatedViewProjectionMatrix(),
+				View.ViewMatrices.GetPreViewTranslation(),
+				View.ViewRect.Size(),
+				MobileDownsampleTranslucencyScissor::GetUpsamplePadding(View.ViewRect.Size(), DownsampledViewSize));
+		}
+	}
+	SET_FLOAT_STAT(STAT_MobileDownsampleTranslucencyGPU, MostRecentTotalTime);
+	GMobileUpsamplePixelClassQueries.Advance();
+	GMobileUpsampleTileList.Advance();
+
+	if (Views.Num() > 0)
+	{
+		GMobileDownsampleTranslucencyTimers.RemoveStale(ViewFamily.FrameNumber);
+		GMobileDownsampleTranslucencyDepthHistory.RemoveStale(ViewFamily.FrameNumber);
+	}
+}
+
+void FMobileSceneRenderer::RenderTranslucency_DownSampleSeparate(FRHICommandListImmediate& RHICmdList, const TArrayView<const FViewInfo*>& PassViews, bool bReprojectDepth) {
+
+	check(RHICmdList.IsOutsideRenderPass());
+
+	SCOPED_DRAW_EVENT(RHICmdList, TranslucencyDownSampleSeparate);
+
+	// The views of a tier share its passes in an atlas, there is a single one otherwise
+	auto GetTierViews = [&PassViews](EMobileDownsampleTranslucencyResolution Resolution)
+	{
+		TArray<const FViewInfo*, TInlineAllocator<2>> TierViews;
+		for (const FViewInfo* View : PassViews)
+		{
+			if (View->ShouldRenderView() && HasDownsampledTranslucencyDraws(*View, Resolution, Resolution))
+			{
+				TierViews.Add(View);
+			}
+		}
+		return TierViews;
+	};
+
+	// Never present with a reprojected depth, see GetDownSampleTranslucencyMode
+	for (int32 ResolutionIndex = (int32)EMobileDownsampleTranslucencyResolution::Full; ResolutionIndex <= (int32)EMobileDownsampleTranslucencyResolution::Quarter; ResolutionIndex++)
+	{
+		const EMobileDownsampleTranslucencyResolution Resolution = (EMobileDownsampleTranslucencyResolution)ResolutionIndex;
+		TArray<const FViewInfo*, TInlineAllocator<2>> TierViews = GetTierViews(Resolution);
+		if (TierViews.Num() > 0)
+		{
+			check(!bReprojectDepth);
+			check(bDownsampledTranslucencyAtlas || TierViews.Num() == 1);
+			RenderDownsampledTranslucencyTier(RHICmdList, TierViews, Resolution);
+		}
+	}
+
+	TArray<const FViewInfo*, TInlineAllocator<2>> AutoViews = GetTierViews(EMobileDownsampleTranslucencyResolution::Auto);
+	if (AutoViews.Num() == 0)
+	{
+		return;
+	}
+	check(bDownsampledTranslucencyAtlas || AutoViews.Num() == 1);
+
+	const FDownsampledTranslucencyTier& AutoTier = DownsampledTranslucencyTiers[(int32)EMobileDownsampleTranslucencyResolution::Auto];
+	const FIntPoint SeparateTranslucencyBufferSize = GetDownsampledTranslucencyTargetSize(*AutoViews[0], EMobileDownsampleTranslucencyResolution::Auto);
+
+	// Times the depth downsample and the low res particles, consumed by the governor a few frames later.
+	// The views of an atlas share the depth downsample, each one only times its own particles.
+	const bool bTimed = CVarMobileSeparateTranslucencyAutoDownsample.GetValueOnRenderThread() != 0;
+	FMobileDownsampleTranslucencyTimers::FViewTimer* PassTimer = bTimed && !bDownsampledTranslucencyAtlas ? GMobileDownsampleTranslucencyTimers.Find(*AutoViews[0]) : nullptr;
+	if (PassTimer)
+	{
+		PassTimer->Timer.Begin(RHICmdList);
+	}
+
+	MobileDownSampleDepth(RHICmdList, AutoViews, bReprojectDepth);
+
+	for (int32 ViewIndex = 0; ViewIndex < AutoViews.Num(); ViewIndex++)
+	{
+		const FViewInfo& View = *AutoViews[ViewIndex];
+
+		FMobileDownsampleTranslucencyTimers::FViewTimer* ViewTimer = bTimed && bDownsampledTranslucencyAtlas ? GMobileDownsampleTranslucencyTimers.Find(View) : nullptr;
+		if (ViewTimer)
+		{
+			ViewTimer->Timer.Begin(RHICmdList);
+		}
+
+		if (!View.Family->UseDebugViewPS() && Scene->UniformBuffers.UpdateViewUniformBuffer(View))
+		{
+			UpdateTranslucentBasePassUniformBuffer(RHICmdList, View);
+			UpdateDirectionalLightUniformBuffers(RHICmdList, View);
+		}
+
+		// The low res view is drawn at its place in the off-screen target, see MobileDownSampleDepth.
+		// Its own view uniform buffer is bound by the pass, the scene's one keeps the full res view.
+		// Material depth reads subtract the view's place in the atlas and add its full res ViewRect.Min, as the depth downsample does.
+		const FIntRect DownsampledViewRect = GetDownsampledTranslucencyViewRect(View, EMobileDownsampleTranslucencyResolution::Auto);
+		GMobileDownsampledViewUniformBuffers.Update(RHICmdList, View, EMobileDownsampleTranslucencyResolution::Auto, SeparateTranslucencyBufferSize, DownsampledViewRect);
+
+		// Under the scissor of the depth downsample, the last view ends the pass
+		DrawDownsampledTranslucencyPass(
+			RHICmdList,
+			View,
+			EMobileDownsampleTranslucencyResolution::Auto,
+			AutoTier.Color->GetRenderTargetItem().TargetableTexture,
+			AutoTier.Depth->GetRenderTargetItem().TargetableTexture,
+			DownsampledViewRect,
+			MobileDownsampleTranslucencyScissor::GetDownsampledRect(View.MobileDownsampleTranslucencyRect, View.ViewRect.Size(), DownsampledViewRect.Size()) + DownsampledViewRect.Min,
+			ViewIndex == AutoViews.Num() - 1);
+
+		if (ViewTimer)
+		{
+			ViewTimer->Timer.End(RHICmdList);
+		}
+	}
+
+	RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, AutoTier.Depth->GetRenderTargetItem().TargetableTexture);
+	RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, AutoTier.Color->GetRenderTargetItem().TargetableTexture);
+
+	// The tile list holds a single view
+	bDownsampledTranslucencyTileList = !bDownsampledTranslucencyAtlas && CVarMobileSeparateTranslucencyTileComposite.GetValueOnRenderThread() != 0 && IsMobileUpsampleTileCompositeSupported(AutoViews[0]->GetShaderPlatform());
+	if (bDownsampledTranslucencyTileList)
+	{
+		ClassifyUpsampleTiles(RHICmdList, *AutoViews[0]);
+	}
+
+	if (PassTimer)
+	{
+		PassTimer->Timer.End(RHICmdList);
+	}
+}
+
+void FMobileSceneRenderer::CompositeTranslucency_DownSampleSeparate(FRHICommandListImmediate& RHICmdList, const TArrayView<const FViewInfo*>& PassViews, bool bInSceneColorPass)
+{
+	SCOPED_DRAW_EVENT(RHICmdList, TranslucencyDownSampleSeparateComposite);
+
+	FSceneRenderTargets& SceneContext = FSceneRenderTargets::Get(RHICmdList);
+
+	if (!bInSceneColorPass)
+	{
+		//Depth and Stencil don't need
+		FRHIRenderPassInfo RPInfo(SceneContext.GetSceneColorSurface(), ERenderTargetActions::Load_Store);
+
+		RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, SceneContext.GetSceneDepthSurface());
+		RHICmdList.TransitionResource(EResourceTransitionAccess::EWritable, RPInfo.ColorRenderTargets[0].RenderTarget);
+
+		// Left open, the caller ends it together with the scene color pass
+		AccountRenderPassBandwidth(RPInfo);
+		RHICmdList.BeginRenderPass(RPInfo, TEXT("UpsampleTranslucency"));
+	}
+
+	for (int32 ViewIndex = 0; ViewIndex < PassViews.Num(); ViewIndex++)
+	{
+		const FViewInfo& View = *PassViews[ViewIndex];
+		if (!View.ShouldRenderView())
+		{
+			continue;
+		}
+
+		const FDownsampledTranslucencyCompositeOrder SortedResolutions = GetDownsampledTranslucencyCompositeOrder(Scene, View, [this, &View](EMobileDownsampleTranslucencyResolution Resolution)
+		{
+			return DownsampledTranslucencyTiers[(int32)Resolution].Color.IsValid() && HasDownsampledTranslucencyDraws(View, Resolution, Resolution);
+		});
+
+		for (EMobileDownsampleTranslucencyResolution Resolution : SortedResolutions)
+		{
+			// Only the Auto tier is timed, the governor can't change the resolution of the others
+			const bool bAutoResolution = Resolution == EMobileDownsampleTranslucencyResolution::Auto;
+			FMobileDownsampleTranslucencyTimers::FViewTimer* ViewTimer = bAutoResolution && CVarMobileSeparateTranslucencyAutoDownsample.GetValueOnRenderThread() != 0 ? GMobileDownsampleTranslucencyTimers.Find(View) : nullptr;
+			if (ViewTimer)
+			{
+				ViewTimer->CompositeTimer.Begin(RHICmdList);
+			}
+
+			UpsampleTranslucency(RHICmdList, View, Resolution);
+
+			if (ViewTimer)
+			{
+				ViewTimer->CompositeTimer.End(RHICmdList);
+			}
+		}
+	}
+
+	bDownsampledTranslucencyTileList = false;
+	bDownsampledTranslucencyAtlas = false;
+	ReleaseDownsampledTranslucencyTargets();
+}
+
+void FMobileSceneRenderer::ClassifyUpsampleTiles(FRHICommandListImmediate& RHICmdList, const FViewInfo& View)
+{
+	check(RHICmdList.IsOutsideRenderPass());
+
+	SCOPED_DRAW_EVENT(RHICmdList, ClassifyUpsampleTiles);
+
+	const FDownsampledTranslucencyTier& AutoTier = DownsampledTranslucencyTiers[(int32)EMobileDownsampleTranslucencyResolution::Auto];
+
+	// Only the scissored part of the low res target is defined
+	const FIntPoint DownsampledViewSize = GetDownsampledTranslucencySize(View.ViewRect.Size(), View.MobileDownsampleTranslucencyScale);
+	const FIntRect ClassifyRect = MobileDownsampleTranslucencyScissor::GetDownsampledRect(View.MobileDownsampleTranslucencyRect, View.ViewRect.Size(), DownsampledViewSize);
+	const FIntPoint NumTiles = FIntPoint::DivideAndRoundUp(ClassifyRect.Size(), MobileTranslucencyUpsampling::UpsampleTileSize);
+	const FIntPoint NumViewTiles = FIntPoint::DivideAndRoundUp(DownsampledViewSize, MobileTranslucencyUpsampling::UpsampleTileSize);
+
+	GMobileUpsampleTileList.Prepare(RHICmdList, FMath::Max(NumTiles.X * NumTiles.Y, 1));
+
+	if (NumTiles.X > 0 && NumTiles.Y > 0)
+	{
+		TShaderMapRef<FMobileUpsampleTileClassifyCS> ComputeShader(View.ShaderMap);
+		RHICmdList.SetComputeShader(ComputeShader.GetComputeShader());
+		ComputeShader->SetParameters(RHICmdList, AutoTier.Color->GetRenderTargetItem().ShaderResourceTexture, ClassifyRect);
+		RHICmdList.DispatchComputeShader(NumTiles.X, NumTiles.Y, 1);
+		ComputeShader->UnsetParameters(RHICmdList);
+	}
+
+	FRHIUnorderedAccessView* UAVs[] = { GMobileUpsampleTileList.TileList.UAV, GMobileUpsampleTileList.DrawIndirectArgs.UAV };
+	RHICmdList.TransitionResources(EResourceTransitionAccess::EReadable, EResourceTransitionPipeline::EComputeToGfx, UAVs, UE_ARRAY_COUNT(UAVs));
+
+	GMobileUpsampleTileList.EnqueueReadback(RHICmdList, NumViewTiles.X * NumViewTiles.Y);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Translucent material inverse opacity render code
+// Used to generate inverse opacity channel for scene captures that require opacity information.
+// See MobileSceneCaptureRendering for more details.
+
+/**
+* Vertex shader for mobile opacity only pass
+*/
+class FOpacityOnlyVS : public FMeshMaterialShader
+{
+	DECLARE_SHADER_TYPE(FOpacityOnlyVS, MeshMaterial);
+protected:
+
+	FOpacityOnlyVS() {}
+	FOpacityOnlyVS(const FMeshMaterialShaderType::CompiledShaderInitializerType& Initializer) :
+		FMeshMaterialShader(Initializer)
+	{
+		PassUniformBuffer.Bind(Initializer.ParameterMap, FMobileBasePassUniformParameters::StaticStructMetadata.GetShaderVariableName());
+	}
+
+public:
+
+	static bool ShouldCompilePermutation(const FMeshMaterialShaderPermutationParameters& Parameters)
+	{
+		return IsTranslucentBlendMode(Parameters.MaterialParameters.BlendMode) && IsMobilePlatform(Parameters.Platform);
+	}
+
+	static void ModifyCompilationEnvironment(const FMaterialShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		static auto* MobileUseHWsRGBEncodingCVAR = IConsoleManager::Get().FindTConsoleVariableDataInt(TEXT("r.Mobile.UseHWsRGBEncoding"));
+		const bool bMobileUseHWsRGBEncoding = (MobileUseHWsRGBEncodingCVAR && MobileUseHWsRGBEncodingCVAR->GetValueOnAnyThread() == 1);
+
+		FMeshMaterialShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("OUTPUT_GAMMA_SPACE"), IsMobileHDR() == false && !bMobileUseHWsRGBEncoding);
+		OutEnvironment.SetDefine(TEXT("OUTPUT_MOBILE_HDR"), IsMobileHDR() == true);
+	}
+};
+
+IMPLEMENT_MATERIAL_SHADER_TYPE(, FOpacityOnlyVS, TEXT("/Engine/Private/MobileOpacityShaders.usf"), TEXT("MainVS"), SF_Vertex);
+
+/**
+* Pixel shader for mobile opacity only pass, writes opacity to alpha channel.
+*/
+class FOpacityOnlyPS : public FMeshMaterialShader
+{
+	DECLARE_SHADER_TYPE(FOpacityOnlyPS, MeshMaterial);
+public:
+
+	static bool ShouldCompilePermutation(const FMeshMaterialShaderPermutationParameters& Parameters)
+	{
+		return IsTranslucentBlendMode(Parameters.MaterialParameters.BlendMode) && IsMobilePlatform(Parameters.Platform);
+	}
+
+	static void ModifyCompilationEnvironment(const FMaterialShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FMeshMaterialShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("SCENE_TEXTURES_DISABLED"), 1u);
+	}
+
+	FOpacityOnlyPS(const ShaderMetaType::CompiledShaderInitializerType& Initializer) :
+		FMeshMaterialShader(Initializer)
+	{
+		PassUniformBuffer.Bind(Initializer.ParameterMap, FMobileBasePassUniformParameters::StaticStructMetadata.GetShaderVariableName());
+	}
+
+	FOpacityOnlyPS() {}
+};
 
 IMPLEMENT_MATERIAL_SHADER_TYPE(, FOpacityOnlyPS, TEXT("/Engine/Private/MobileOpacityShaders.usf"), TEXT("MainPS"), SF_Pixel);
 
-bool FMobileSceneRenderer::RenderInverseOpacity(FRHICommandListImmediate& RHICmdList, const FViewInfo& View)
+bool FMobileSceneRenderer::RenderInverseOpacity(FRHICommandListImmediate& RHICmdList, const FViewInfo& View)
+{
+	// Function MUST be self-contained wrt RenderPasses
+	check(RHICmdList.IsOutsideRenderPass());
+
+	bool bDirty = false;
+	FSceneRenderTargets& SceneContext = FSceneRenderTargets::Get(RHICmdList);
+
+	SceneContext.AllocSceneColor(RHICmdList);
+
+	const bool bMobileMSAA = SceneContext.GetSceneColorSurface()->GetNumSamples() > 1;
+
+	FRHITexture* SceneColorResolve = bMobileMSAA ? SceneContext.GetSceneColorTexture() : nullptr;
+	ERenderTargetActions ColorTargetAction = bMobileMSAA ? ERenderTargetActions::Clear_Resolve : ERenderTargetActions::Clear_Store;
+	FRHIRenderPassInfo RPInfo(
+		SceneContext.GetSceneColorSurface(),
+		ColorTargetAction,
+		SceneColorResolve,
+		SceneContext.GetSceneDepthSurface(),
+		EDepthStencilTargetActions::ClearDepthStencil_DontStoreDepthStencil,
+		nullptr,
+		FExclusiveDepthStencil::DepthRead_StencilRead
+	);
+
+	// make sure targets are writable
+	RHICmdList.TransitionResource(EResourceTransitionAccess::EWritable, SceneContext.GetSceneColorSurface());
+	RHICmdList.TransitionResource(EResourceTransitionAccess::EWritable, SceneContext.GetSceneDepthSurface());
+	if (SceneColorResolve)
+	{
+		RHICmdList.TransitionResource(EResourceTransitionAccess::EWritable, SceneColorResolve);
+	}
+
+	if (Scene->UniformBuffers.UpdateViewUniformBuffer(View))
+	{
+		UpdateTranslucentBasePassUniformBuffer(RHICmdList, View);
+		UpdateDirectionalLightUniformBuffers(RHICmdList, View);
+	}
+
+	RHICmdList.BeginRenderPass(RPInfo, TEXT("RenderInverseOpacity"));
+
+	if (ShouldRenderTranslucency(ETranslucencyPass::TPT_AllTranslucency))
+	{
+		// Mobile multi-view is not side by side stereo
+		const FViewInfo& TranslucentViewport = (View.bIsMobileMultiViewEnabled) ? Views[0] : View;
+		RHICmdList.SetViewport(TranslucentViewport.ViewRect.Min.X, TranslucentViewport.ViewRect.Min.Y, 0.0f, TranslucentViewport.ViewRect.Max.X, TranslucentViewport.ViewRect.Max.Y, 1.0f);
+
+		View.ParallelMeshDrawCommandPasses[EMeshPass::MobileInverseOpacity].DispatchDraw(nullptr, RHICmdList);
+
+		bDirty |= View.ParallelMeshDrawCommandPasses[EMeshPass::MobileInverseOpacity].HasAnyDraw();
+	}
+
+	RHICmdList.EndRenderPass();
+
+	RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, SceneContext.GetSceneColorTexture());
+
+	return bDirty;
+}
+
+class FMobileInverseOpacityMeshProcessor : public FMeshPassProcessor
+{
+public:
+	const FMeshPassProcessorRenderState PassDrawRenderState;
+
+public:
+	FMobileInverseOpacityMeshProcessor(const FScene* InScene, ERHIFeatureLevel::Type InFeatureLevel, const FSceneView* InViewIfDynamicMeshCommand, const FMeshPassProcessorRenderState& InDrawRenderState, FMeshPassDrawListContext* InDrawListContext)
+		: FMeshPassProcessor(InScene, InFeatureLevel, InViewIfDynamicMeshCommand, InDrawListContext)
+		, PassDrawRenderState(InDrawRenderState)
+	{
+		// expect dynamic path
+		check(InViewIfDynamicMeshCommand);
+	}
+
+	virtual void AddMeshBatch(const FMeshBatch& RESTRICT MeshBatch, uint64 BatchElementMask, const FPrimitiveSceneProxy* RESTRICT PrimitiveSceneProxy, int32 StaticMeshId = -1) override final
+	{
+		if (MeshBatch.bUseForMaterial)
+		{
+			// Determine the mesh's material and blend mode.
+			const FMaterialRenderProxy* FallbackMaterialRenderProxyPtr = nullptr;
+			const FMaterial& Material = MeshBatch.MaterialRenderProxy->GetMaterialWithFallback(FeatureLevel, FallbackMaterialRenderProxyPtr);
+			const FMaterialRenderProxy& MaterialRenderProxy = FallbackMaterialRenderProxyPtr ? *FallbackMaterialRenderProxyPtr : *MeshBatch.MaterialRenderProxy;
+			const EBlendMode BlendMode = Material.GetBlendMode();
+			const bool bIsTranslucent = IsTranslucentBlendMode(BlendMode);
+
+			if (bIsTranslucent)
+			{
+				Process(MeshBatch, BatchElementMask, Material, MaterialRenderProxy, PrimitiveSceneProxy, StaticMeshId);
+			}
+		}
+	}
+
+private:
+	void Process(const FMeshBatch& MeshBatch, uint64 BatchElementMask, const FMaterial& Material, const FMaterialRenderProxy& MaterialRenderProxy, const FPrimitiveSceneProxy* PrimitiveSceneProxy, int32 StaticMeshId)
+	{
+		const FVertexFactory* VertexFactory = MeshBatch.VertexFactory;
+
+		TMeshProcessorShaders<
+			FOpacityOnlyVS,
+			FBaseHS,
+			FBaseDS,
+			FOpacityOnlyPS> InverseOpacityShaders;
+
+		InverseOpacityShaders.VertexShader = Material.GetShader<FOpacityOnlyVS>(VertexFactory->GetType());
+		InverseOpacityShaders.PixelShader = Material.GetShader<FOpacityOnlyPS>(VertexFactory->GetType());
+
+		FMeshPassProcessorRenderState DrawRenderState(PassDrawRenderState);
+		MobileBasePass::SetTranslucentRenderState(DrawRenderState, Material);
+
+		const FMeshDrawingPolicyOverrideSettings OverrideSettings = ComputeMeshOverrideSettings(MeshBatch);
+		ERasterizerFillMode MeshFillMode = ComputeMeshFillMode(MeshBatch, Material, OverrideSettings);
+		ERasterizerCullMode MeshCullMode = ComputeMeshCullMode(MeshBatch, Material, OverrideSettings);
+
+		FMeshMaterialShaderElementData ShaderElementData;
+		ShaderElementData.InitializeMeshMaterialData(ViewIfDynamicMeshCommand, PrimitiveSceneProxy, MeshBatch, StaticMeshId, false);
+
+		FMeshDrawCommandSortKey SortKey = CalculateTranslucentMeshStaticSortKey(PrimitiveSceneProxy, MeshBatch.MeshIdInPrimitive);
+
+		BuildMeshDrawCommands(
+			MeshBatch,
+			BatchElementMask,
+			PrimitiveSceneProxy,
+			MaterialRenderProxy,
+			Material,
+			PassDrawRenderState,
+			InverseOpacityShaders,
+			MeshFillMode,
+			MeshCullMode,
+			SortKey,
+			EMeshPassFeatures::Default,
+			ShaderElementData);
+	}
+};
+
+// This pass is registered only when we render to scene capture, see UpdateSceneCaptureContentMobile_RenderThread()
+FMeshPassProcessor* CreateMobileInverseOpacityPassProcessor(const FScene* Scene, const FSceneView* InViewIfDynamicMeshCommand, FMeshPassDrawListContext* InDrawListContext)
+{
+	FMeshPassProcessorRenderState PassDrawRenderState(Scene->UniformBuffers.ViewUniformBuffer, Scene->UniformBuffers.MobileTranslucentBasePassUniformBuffer);
+	PassDrawRenderState.SetDepthStencilState(TStaticDepthStencilState<false, CF_DepthNearOrEqual>::GetRHI());
+	PassDrawRenderState.SetBlendState(TStaticBlendState<CW_ALPHA, BO_Add, BF_DestColor, BF_Zero, BO_Add, BF_Zero, BF_InverseSourceAlpha>::GetRHI());
+
+	return new(FMemStack::Get()) FMobileInverseOpacityMeshProcessor(Scene, Scene->GetFeatureLevel(), InViewIfDynamicMeshCommand, PassDrawRenderState, InDrawListContext);
+}
+
+
+
+/** A simple pixel shader used on Mobile to read scene depth from scene color alpha and write it to a downsized depth buffer. */
+class FMobileDownsampleSceneDepthPS : public FGlobalShader
+{
+	DECLARE_SHADER_TYPE(FMobileDownsampleSceneDepthPS, Global);
+public:
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return true;
+	}
+
+	FMobileDownsampleSceneDepthPS(const ShaderMetaType::CompiledShaderInitializerType& Initializer) :
+		FGlobalShader(Initializer)
+	{
+		SLInvDeviceZToWorldZTransform.Bind(Initializer.ParameterMap, TEXT("SLInvDeviceZToWorldZTransform"));
+		SLSceneColorTexture.Bind(Initializer.ParameterMap, TEXT("SLSceneColorTexture"));
+		SLDownsampleFactor.Bind(Initializer.ParameterMap, TEXT("SLDownsampleFactor"));
+		SLLowResViewMin.Bind(Initializer.ParameterMap, TEXT("SLLowResViewMin"));
+		SLFullResViewMin.Bind(Initializer.ParameterMap, TEXT("SLFullResViewMin"));
+		SLFullResViewMax.Bind(Initializer.ParameterMap, TEXT("SLFullResViewMax"));
+		SLMinMaxDepthTexture.Bind(Initializer.ParameterMap, TEXT("SLMinMaxDepthTexture"));
+		SLSceneDepthTexture.Bind(Initializer.ParameterMap, TEXT("SLSceneDepthTexture"));
+	}
+	FMobileDownsampleSceneDepthPS() {}
+
+	void SetParameters(FRHICommandList& RHICmdList, const FViewInfo& View, const FIntRect& DownsampledViewRect, FRHITexture* InputTexture)
+	{
+		FSceneRenderTargets& SceneContext = FSceneRenderTargets::Get(RHICmdList);
+
+		// Full res texels per low res texel, any integer or fractional ratio
+		const FVector2D DownsampleFactor(float(View.ViewRect.Width()) / DownsampledViewRect.Width(), float(View.ViewRect.Height()) / DownsampledViewRect.Height());
+
+		SetShaderValue(RHICmdList, RHICmdList.GetBoundPixelShader(), SLInvDeviceZToWorldZTransform, View.InvDeviceZToWorldZTransform);
+		SetShaderValue(RHICmdList, RHICmdList.GetBoundPixelShader(), SLDownsampleFactor, DownsampleFactor);
+		SetShaderValue(RHICmdList, RHICmdList.GetBoundPixelShader(), SLLowResViewMin, FVector2D(DownsampledViewRect.Min));
+		SetShaderValue(RHICmdList, RHICmdList.GetBoundPixelShader(), SLFullResViewMin, FVector2D(View.ViewRect.Min));
+		SetShaderValue(RHICmdList, RHICmdList.GetBoundPixelShader(), SLFullResViewMax, FVector2D(View.ViewRect.Max));
+		SetTextureParameter(RHICmdList, RHICmdList.GetBoundPixelShader(), SLSceneColorTexture, SceneContext.GetSceneColorSurface());
+		SetTextureParameter(RHICmdList, RHICmdList.GetBoundPixelShader(), SLSceneDepthTexture, SceneContext.GetSceneDepthSurface());
+		if (InputTexture)
+		{
+			SetTextureParameter(RHICmdList, RHICmdList.GetBoundPixelShader(), SLMinMaxDepthTexture, InputTexture);
+		}
+	}
+
+	LAYOUT_FIELD(FShaderParameter, SLInvDeviceZToWorldZTransform);
+	LAYOUT_FIELD(FShaderParameter, SLDownsampleFactor);
+	LAYOUT_FIELD(FShaderParameter, SLLowResViewMin);
+	LAYOUT_FIELD(FShaderParameter, SLFullResViewMin);
+	LAYOUT_FIELD(FShaderParameter, SLFullResViewMax);
+	LAYOUT_FIELD(FShaderResourceParameter, SLSceneColorTexture);
+	LAYOUT_FIELD(FShaderResourceParameter, SLMinMaxDepthTexture);
+	LAYOUT_FIELD(FShaderResourceParameter, SLSceneDepthTexture);
+};
+
+IMPLEMENT_SHADER_TYPE(, FMobileDownsampleSceneDepthPS, TEXT("/Engine/Private/MobileDownSampleDepthPixelShader.usf"), TEXT("Main"), SF_Pixel);
+
+/** Writes the closest and farthest scene depth of every low res texel to a two channel target, and classifies the texel for the upsample. */
+class FMobileDownsampleSceneDepthMinMaxPS : public FMobileDownsampleSceneDepthPS
+{
+	DECLARE_SHADER_TYPE(FMobileDownsampleSceneDepthMinMaxPS, Global);
+public:
+
+	FMobileDownsampleSceneDepthMinMaxPS(const ShaderMetaType::CompiledShaderInitializerType& Initializer) :
+		FMobileDownsampleSceneDepthPS(Initializer)
+	{}
+	FMobileDownsampleSceneDepthMinMaxPS() {}
+};
+
+IMPLEMENT_SHADER_TYPE(, FMobileDownsampleSceneDepthMinMaxPS, TEXT("/Engine/Private/MobileDownSampleDepthPixelShader.usf"), TEXT("MinMaxMain"), SF_Pixel);
+
+/** Writes the closest depth of the min/max target to the downsized depth buffer. */
+class FMobileDownsampleSceneDepthFromMinMaxPS : public FMobileDownsampleSceneDepthPS
+{
+	DECLARE_SHADER_TYPE(FMobileDownsampleSceneDepthFromMinMaxPS, Global);
+public:
+
+	FMobileDownsampleSceneDepthFromMinMaxPS(const ShaderMetaType::CompiledShaderInitializerType& Initializer) :
+		FMobileDownsampleSceneDepthPS(Initializer)
+	{}
+	FMobileDownsampleSceneDepthFromMinMaxPS() {}
+};
+
+IMPLEMENT_SHADER_TYPE(, FMobileDownsampleSceneDepthFromMinMaxPS, TEXT("/Engine/Private/MobileDownSampleDepthPixelShader.usf"), TEXT("FromMinMaxMain"), SF_Pixel);
+
+/** Writes the low res linear depth kept for the next frame's reprojection. */
+class FMobileDownsampledDepthHistoryPS : public FMobileDownsampleSceneDepthPS
+{
+	DECLARE_SHADER_TYPE(FMobileDownsampledDepthHistoryPS, Global);
+public:
+
+	FMobileDownsampledDepthHistoryPS(const ShaderMetaType::CompiledShaderInitializerType& Initializer) :
+		FMobileDownsampleSceneDepthPS(Initializer)
+	{}
+	FMobileDownsampledDepthHistoryPS() {}
+};
+
+IMPLEMENT_SHADER_TYPE(, FMobileDownsampledDepthHistoryPS, TEXT("/Engine/Private/MobileDownSampleDepthPixelShader.usf"), TEXT("HistoryMain"), SF_Pixel);
+
+/** FScreenVS of the mobile multi-view full screen draws, also passes the eye to the pixel shader. */
+class FMobileMultiViewScreenVS : public FGlobalShader
+{
+	DECLARE_SHADER_TYPE(FMobileMultiViewScreenVS, Global);
+public:
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return RHISupportsMobileMultiView(Parameters.Platform);
+	}
+
+	FMobileMultiViewScreenVS(const ShaderMetaType::CompiledShaderInitializerType& Initializer) :
+		FGlobalShader(Initializer)
+	{}
+	FMobileMultiViewScreenVS() {}
+};
+
+IMPLEMENT_SHADER_TYPE(, FMobileMultiViewScreenVS, TEXT("/Engine/Private/MobileTranslucencyMultiView.usf"), TEXT("MobileMultiViewScreenVS"), SF_Vertex);
+
+/** Writes the downsized depth buffer of both eyes of mobile multi-view from the multi-view scene depth, passed as the input texture. */
+class FMobileDownsampleSceneDepthMultiViewPS : public FMobileDownsampleSceneDepthPS
+{
+	DECLARE_SHADER_TYPE(FMobileDownsampleSceneDepthMultiViewPS, Global);
+public:
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return RHISupportsMobileMultiView(Parameters.Platform);
+	}
+
+	FMobileDownsampleSceneDepthMultiViewPS(const ShaderMetaType::CompiledShaderInitializerType& Initializer) :
+		FMobileDownsampleSceneDepthPS(Initializer)
+	{}
+	FMobileDownsampleSceneDepthMultiViewPS() {}
+
+	void SetParameters(FRHICommandList& RHICmdList, const FViewInfo& View, const FIntRect& DownsampledViewRect, FRHITexture* InputTexture)
+	{
+		FMobileDownsampleSceneDepthPS::SetParameters(RHICmdList, View, DownsampledViewRect, nullptr);
+		SetTextureParameter(RHICmdList, RHICmdList.GetBoundPixelShader(), SLSceneDepthTexture, InputTexture);
+	}
+};
+
+IMPLEMENT_SHADER_TYPE(, FMobileDownsampleSceneDepthMultiViewPS, TEXT("/Engine/Private/MobileTranslucencyMultiView.usf"), TEXT("DownsampleDepthMultiViewPS"), SF_Pixel);
+
+/** Writes the downsized depth buffer from the previous frame's low res depth, reprojected with PrevViewInfo. */
+class FMobileReprojectDownsampledDepthPS : public FGlobalShader
+{
+	DECLARE_SHADER_TYPE(FMobileReprojectDownsampledDepthPS, Global);
+public:
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return true;
+	}
+
+	FMobileReprojectDownsampledDepthPS(const ShaderMetaType::CompiledShaderInitializerType& Initializer) :
+		FGlobalShader(Initializer)
+	{
+		SLInvDeviceZToWorldZTransform.Bind(Initializer.ParameterMap, TEXT("SLInvDeviceZToWorldZTransform"));
+		SLCurrentScreenToPrevClip.Bind(Initializer.ParameterMap, TEXT("SLCurrentScreenToPrevClip"));
+		SLPrevScreenToCurrentClip.Bind(Initializer.ParameterMap, TEXT("SLPrevScreenToCurrentClip"));
+		SLPrevScreenPosToTexel.Bind(Initializer.ParameterMap, TEXT("SLPrevScreenPosToTexel"));
+		SLPrevViewSize.Bind(Initializer.ParameterMap, TEXT("SLPrevViewSize"));
+		SLDownsampledViewSize.Bind(Initializer.ParameterMap, TEXT("SLDownsampledViewSize"));
+		SLPrevLowResDepthTexture.Bind(Initializer.ParameterMap, TEXT("SLPrevLowResDepthTexture"));
+	}
+	FMobileReprojectDownsampledDepthPS() {}
+
+	void SetParameters(FRHICommandList& RHICmdList, const FViewInfo& View, const FIntRect& DownsampledViewRect, FRHITexture* InputTexture)
+	{
+		FRHIPixelShader* ShaderRHI = RHICmdList.GetBoundPixelShader();
+
+		// Only a single view is reprojected, always at the origin of the low res target
+		check(DownsampledViewRect.Min == FIntPoint::ZeroValue);
+		const FIntPoint DownsampledViewSize = DownsampledViewRect.Size();
+
+		const FViewMatrices& ViewMatrices = View.ViewMatrices;
+		const FViewMatrices& PrevViewMatrices = View.PrevViewInfo.ViewMatrices;
+		const MobileTranslucencyUpsampling::FReprojectionMatrices Matrices = MobileTranslucencyUpsampling::MakeReprojectionMatrices(
+			ViewMatrices.GetProjectionMatrix(), ViewMatrices.GetInvProjectionMatrix(), ViewMatrices.GetTranslatedViewMatrix(), ViewMatrices.GetPreViewTranslation(),
+			PrevViewMatrices.GetProjectionMatrix(), PrevViewMatrices.GetInvProjectionMatrix(), PrevViewMatrices.GetTranslatedViewMatrix(), PrevViewMatrices.GetPreViewTranslation());
+
+		// The history is only reprojected at the size it was written at, see FMobileDownsampleTranslucencyDepthHistory::FindPreviousFrame
+		const FVector2D PrevViewSize(DownsampledViewSize.X, DownsampledViewSize.Y);
+
+		SetShaderValue(RHICmdList, ShaderRHI, SLInvDeviceZToWorldZTransform, View.InvDeviceZToWorldZTransform);
+		SetShaderValue(RHICmdList, ShaderRHI, SLCurrentScreenToPrevClip, Matrices.CurrentScreenToPrevClip);
+		SetShaderValue(RHICmdList, ShaderRHI, SLPrevScreenToCurrentClip, Matrices.PrevScreenToCurrentClip);
+		SetShaderValue(RHICmdList, ShaderRHI, SLPrevScreenPosToTexel, FVector4(0.5f * PrevViewSize.X, -0.5f * PrevViewSize.Y, 0.5f * PrevViewSize.X, 0.5f * PrevViewSize.Y));
+		SetShaderValue(RHICmdList, ShaderRHI, SLPrevViewSize, PrevViewSize);
+		SetShaderValue(RHICmdList, ShaderRHI, SLDownsampledViewSize, FVector2D(DownsampledViewSize.X, DownsampledViewSize.Y));
+		SetTextureParameter(RHICmdList, ShaderRHI, SLPrevLowResDepthTexture, InputTexture);
+	}
+
+	LAYOUT_FIELD(FShaderParameter, SLInvDeviceZToWorldZTransform);
+	LAYOUT_FIELD(FShaderParameter, SLCurrentScreenToPrevClip);
+	LAYOUT_FIELD(FShaderParameter, SLPrevScreenToCurrentClip);
+	LAYOUT_FIELD(FShaderParameter, SLPrevScreenPosToTexel);
+	LAYOUT_FIELD(FShaderParameter, SLPrevViewSize);
+	LAYOUT_FIELD(FShaderParameter, SLDownsampledViewSize);
+	LAYOUT_FIELD(FShaderResourceParameter, SLPrevLowResDepthTexture);
+};
+
+IMPLEMENT_SHADER_TYPE(, FMobileReprojectDownsampledDepthPS, TEXT("/Engine/Private/MobileDownSampleDepthPixelShader.usf"), TEXT("ReprojectMain"), SF_Pixel);
+
+/**
+ * Draws one of the depth downsample shaders over the low res view, the render pass must already be begun.
+ * DownsampledViewRect is the low res view in the target, at the origin unless the views share an atlas.
+ * InputTexture is the min/max depth, the depth history or the multi-view scene depth, depending on the shader.
+ * VertexShaderType is FMobileMultiViewScreenVS in mobile multi-view passes.
+ * ScissorRect is in low res pixels of the target and stays set after the draw, the caller disables it once done with the pass.
+ */
+template<typename PixelShaderType, typename VertexShaderType = FScreenVS>
+static void DrawDownsampleSceneDepth(FRHICommandList& RHICmdList, const FViewInfo& View, const FIntRect& DownsampledViewRect, const FIntRect& ScissorRect, FRHIBlendState* BlendState, FRHIDepthStencilState* DepthStencilState, FRHITexture* InputTexture)
+{
+	// Set shaders and texture
+	TShaderMapRef<VertexShaderType> ScreenVertexShader(View.ShaderMap);
+	TShaderMapRef<PixelShaderType> PixelShader(View.ShaderMap);
+
+	extern TGlobalResource<FFilterVertexDeclaration> GFilterVertexDeclaration;
+
+	FGraphicsPipelineStateInitializer GraphicsPSOInit;
+	RHICmdList.ApplyCachedRenderTargets(GraphicsPSOInit);
+
+	GraphicsPSOInit.BlendState = BlendState;
+	GraphicsPSOInit.RasterizerState = TStaticRasterizerState<FM_Solid, CM_None>::GetRHI();
+	GraphicsPSOInit.DepthStencilState = DepthStencilState;
+
+	GraphicsPSOInit.BoundShaderState.VertexDeclarationRHI = GFilterVertexDeclaration.VertexDeclarationRHI;
+	GraphicsPSOInit.BoundShaderState.VertexShaderRHI = ScreenVertexShader.GetVertexShader();
+	GraphicsPSOInit.BoundShaderState.PixelShaderRHI = PixelShader.GetPixelShader();
+	GraphicsPSOInit.PrimitiveType = PT_TriangleList;
+
+	SetGraphicsPipelineState(RHICmdList, GraphicsPSOInit);
+
+	PixelShader->SetParameters(RHICmdList, View, DownsampledViewRect, InputTexture);
+
+	RHICmdList.SetViewport(DownsampledViewRect.Min.X, DownsampledViewRect.Min.Y, 0.0f, DownsampledViewRect.Max.X, DownsampledViewRect.Max.Y, 1.0f);
+	RHICmdList.SetScissorRect(true, ScissorRect.Min.X, ScissorRect.Min.Y, ScissorRect.Max.X, ScissorRect.Max.Y);
+
+	DrawRectangle(
+		RHICmdList,
+		0, 0,
+		DownsampledViewRect.Width(), DownsampledViewRect.Height(),
+		0, 0,
+		View.ViewRect.Width(), View.ViewRect.Height(),
+		DownsampledViewRect.Size(),
+		View.ViewRect.Size(),
+		ScreenVertexShader,
+		EDRF_UseTriangleOptimization);
+}
+
+void FMobileSceneRenderer::MobileDownSampleDepth(FRHICommandListImmediate& RHICmdList, const TArrayView<const FViewInfo*>& PassViews, bool bReprojectDepth) {
+
+	FSceneRenderTargets& SceneContext = FSceneRenderTargets::Get(RHICmdList);
+
+	FIntPoint MobileSeparateTranslucencyBufferSize = GetDownsampledTranslucencyTargetSize(*PassViews[0], EMobileDownsampleTranslucencyResolution::Auto);
+
+	// Only lives until the composite, see r.Mobile.SeparateTranslucencyTransientTargets
+	FDownsampledTranslucencyTier& AutoTier = DownsampledTranslucencyTiers[(int32)EMobileDownsampleTranslucencyResolution::Auto];
+	FPooledRenderTargetDesc DepthDesc(FPooledRenderTargetDesc::Create2DDesc(MobileSeparateTranslucencyBufferSize, PF_DepthStencil, FClearValueBinding::None, TexCreate_None, TexCreate_DepthStencilTargetable | TexCreate_ShaderResource, false));
+	GMobileDownsampleTranslucencyTargetLifetime.FindFreeElement(RHICmdList, DepthDesc, AutoTier.Depth, TEXT("SeparateTranslucencyDepth"));
+	FRHITexture* DownSampleDepth = AutoTier.Depth->GetRenderTargetItem().TargetableTexture;
+
+	// Low res rect of every view in the targets. Texels outside of its scissor are neither written nor read by the upsample.
+	TArray<FIntRect, TInlineAllocator<2>> DownsampledViewRects;
+	TArray<FIntRect, TInlineAllocator<2>> ScissorRects;
+	for (const FViewInfo* View : PassViews)
+	{
+		const FIntRect DownsampledViewRect = GetDownsampledTranslucencyViewRect(*View, EMobileDownsampleTranslucencyResolution::Auto);
+		DownsampledViewRects.Add(DownsampledViewRect);
+		ScissorRects.Add(MobileDownsampleTranslucencyScissor::GetDownsampledRect(View->MobileDownsampleTranslucencyRect, View->ViewRect.Size(), DownsampledViewRect.Size()) + DownsampledViewRect.Min);
+	}
+
+	// The gutters of an atlas are read by the bilinear footprint of its views' edges, it is always cleared
+	const bool bClearTarget = bDownsampledTranslucencyAtlas || ScissorRects[0] == DownsampledViewRects[0];
+
+	// Nothing of the current frame is rendered yet when reprojecting, only a single view is
+	check(!bReprojectDepth || PassViews.Num() == 1);
+	const FMobileDownsampleTranslucencyDepthHistory::FViewHistory* DepthHistory = bReprojectDepth ? GMobileDownsampleTranslucencyDepthHistory.FindPreviousFrame(*PassViews[0], DownsampledViewRects[0].Size()) : nullptr;
+	check(!bReprojectDepth || DepthHistory);
+
+	if (!bReprojectDepth)
+	{
+		//Because Metal and Vulkan can't use the texture as MemoryLess as SRV, we use SceneColor
+		RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, SceneContext.GetSceneColorSurface());
+	}
+
+	FRHITexture* MinMaxDepthTexture = nullptr;
+	DownsampledTranslucencyMinMaxDepthRT.SafeRelease();
+	// Full precision, the closest depth is written back to the low res depth buffer and must match the scene's
+	if (!bReprojectDepth && CVarMobileSeparateTranslucencyMinMaxDepth.GetValueOnRenderThread() != 0 && GPixelFormats[PF_G32R32F].Supported)
+	{
+		FPooledRenderTargetDesc Desc(FPooledRenderTargetDesc::Create2DDesc(MobileSeparateTranslucencyBufferSize, PF_G32R32F, FClearValueBinding::None, TexCreate_None, TexCreate_RenderTargetable | TexCreate_ShaderResource, false));
+		GMobileDownsampleTranslucencyTargetLifetime.FindFreeElement(RHICmdList, Desc, DownsampledTranslucencyMinMaxDepthRT, TEXT("SeparateTranslucencyMinMaxDepth"));
+		MinMaxDepthTexture = DownsampledTranslucencyMinMaxDepthRT->GetRenderTargetItem().TargetableTexture;
+
+		FRHIRenderPassInfo MinMaxRPInfo(MinMaxDepthTexture, ERenderTargetActions::DontLoad_Store);
+		RHICmdList.TransitionResource(EResourceTransitionAccess::EWritable, MinMaxDepthTexture);
+		AccountRenderPassBandwidth(MinMaxRPInfo);
+		RHICmdList.BeginRenderPass(MinMaxRPInfo, TEXT("DownsampleDepthMinMax"));
+		{
+			SCOPED_DRAW_EVENT(RHICmdList, DownsampleDepthMinMax);
+			for (int32 ViewIndex = 0; ViewIndex < PassViews.Num(); ViewIndex++)
+			{
+				DrawDownsampleSceneDepth<FMobileDownsampleSceneDepthMinMaxPS>(RHICmdList, *PassViews[ViewIndex], DownsampledViewRects[ViewIndex], ScissorRects[ViewIndex], TStaticBlendState<>::GetRHI(), TStaticDepthStencilState<false, CF_Always>::GetRHI(), nullptr);
+			}
+			RHICmdList.SetScissorRect(false, 0, 0, 0, 0);
+		}
+		RHICmdList.EndRenderPass();
+		RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, MinMaxDepthTexture);
+	}
+
+	AutoTier.AllocateColor(RHICmdList, MobileSeparateTranslucencyBufferSize, false, TEXT("SeparateTranslucency"));
+
+	FRHIRenderPassInfo RPInfo(
+		AutoTier.Color->GetRenderTargetItem().TargetableTexture,
+		// A partial view is cleared by a quad under the scissor instead
+		bClearTarget ? ERenderTargetActions::Clear_Store : ERenderTargetActions::DontLoad_Store,
+		nullptr, //暂时不管MSAA
+		DownSampleDepth,
+		EDepthStencilTargetActions::LoadDepthStencil_StoreDepthStencil,  //直接Load应该更省
+		nullptr,
+		FExclusiveDepthStencil::DepthWrite_StencilWrite //
+	);
+
+	AccountRenderPassBandwidth(RPInfo);
+	RHICmdList.BeginRenderPass(RPInfo, TEXT("DownsampleDepthAndSeparatePass"));
+	{
+		SCOPED_DRAW_EVENT(RHICmdList, DownsampleDepth);
+
+		//直接强制写深度了
+		for (int32 ViewIndex = 0; ViewIndex < PassViews.Num(); ViewIndex++)
+		{
+			const FViewInfo& View = *PassViews[ViewIndex];
+			if (DepthHistory)
+			{
+				FRHITexture* PrevLowResDepthTexture = DepthHistory->LowResDepth->GetRenderTargetItem().ShaderResourceTexture;
+				DrawDownsampleSceneDepth<FMobileReprojectDownsampledDepthPS>(RHICmdList, View, DownsampledViewRects[ViewIndex], ScissorRects[ViewIndex], TStaticBlendState<CW_NONE>::GetRHI(), TStaticDepthStencilState<true, CF_Always>::GetRHI(), PrevLowResDepthTexture);
+			}
+			else if (MinMaxDepthTexture)
+			{
+				DrawDownsampleSceneDepth<FMobileDownsampleSceneDepthFromMinMaxPS>(RHICmdList, View, DownsampledViewRects[ViewIndex], ScissorRects[ViewIndex], TStaticBlendState<CW_NONE>::GetRHI(), TStaticDepthStencilState<true, CF_Always>::GetRHI(), MinMaxDepthTexture);
+			}
+			else
+			{
+				DrawDownsampleSceneDepth<FMobileDownsampleSceneDepthPS>(RHICmdList, View, DownsampledViewRects[ViewIndex], ScissorRects[ViewIndex], TStaticBlendState<CW_NONE>::GetRHI(), TStaticDepthStencilState<true, CF_Always>::GetRHI(), nullptr);
+			}
+		}
+
+		if (!bClearTarget)
+		{
+			DrawClearQuad(RHICmdList, FLinearColor::Black);
+		}
+	}
+
+	RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, DownSampleDepth);
+	RHICmdList.TransitionResource(EResourceTransitionAccess::EWritable, RPInfo.ColorRenderTargets[0].RenderTarget);
+}
+
+void FMobileSceneRenderer::RenderDownsampledTranslucencyTier(FRHICommandListImmediate& RHICmdList, const TArrayView<const FViewInfo*>& PassViews, EMobileDownsampleTranslucencyResolution Resolution)
+{
+	check(RHICmdList.IsOutsideRenderPass());
+
+	const EMeshPass::Type MeshPass = TranslucencyPassToMeshPass(GetMobileDownsampleTranslucencyPass(Resolution));
+	SCOPED_DRAW_EVENTF(RHICmdList, TranslucencyDownSampleSeparateTier, TEXT("%s"), GetMeshPassName(MeshPass));
+
+	FSceneRenderTargets& SceneContext = FSceneRenderTargets::Get(RHICmdList);
+	const FIntPoint BufferSize = GetDownsampledTranslucencyTargetSize(*PassViews[0], Resolution);
+
+	// Same formats as the Auto tier's targets
+	FDownsampledTranslucencyTier& Tier = DownsampledTranslucencyTiers[(int32)Resolution];
+	Tier.AllocateColor(RHICmdList, BufferSize, false, TEXT("SeparateTranslucencyTier"));
+	FPooledRenderTargetDesc DepthDesc(FPooledRenderTargetDesc::Create2DDesc(BufferSize, PF_DepthStencil, FClearValueBinding::DepthFar, TexCreate_None, TexCreate_DepthStencilTargetable | TexCreate_ShaderResource, false));
+	GMobileDownsampleTranslucencyTargetLifetime.FindFreeElement(RHICmdList, DepthDesc, Tier.Depth, TEXT("SeparateTranslucencyTierDepth"));
+
+	RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, SceneContext.GetSceneColorSurface());
+
+	FRHIRenderPassInfo RPInfo(
+		Tier.Color->GetRenderTargetItem().TargetableTexture,
+		ERenderTargetActions::Clear_Store,
+		nullptr,
+		Tier.Depth->GetRenderTargetItem().TargetableTexture,
+		EDepthStencilTargetActions::DontLoad_StoreDepthStencil,
+		nullptr,
+		FExclusiveDepthStencil::DepthWrite_StencilWrite
+	);
+
+	RHICmdList.TransitionResource(EResourceTransitionAccess::EWritable, RPInfo.ColorRenderTargets[0].RenderTarget);
+	AccountRenderPassBandwidth(RPInfo);
+	RHICmdList.BeginRenderPass(RPInfo, TEXT("DownsampleDepthAndSeparateTierPass"));
+	for (const FViewInfo* View : PassViews)
+	{
+		// Neither scissored nor classified, those are driven by the Auto tier's primitives and history
+		const FIntRect DownsampledViewRect = GetDownsampledTranslucencyViewRect(*View, Resolution);
+		DrawDownsampleSceneDepth<FMobileDownsampleSceneDepthPS>(RHICmdList, *View, DownsampledViewRect, DownsampledViewRect, TStaticBlendState<CW_NONE>::GetRHI(), TStaticDepthStencilState<true, CF_Always>::GetRHI(), nullptr);
+	}
+
+	for (int32 ViewIndex = 0; ViewIndex < PassViews.Num(); ViewIndex++)
+	{
+		const FViewInfo& View = *PassViews[ViewIndex];
+		if (Scene->UniformBuffers.UpdateViewUniformBuffer(View))
+		{
+			UpdateTranslucentBasePassUniformBuffer(RHICmdList, View);
+			UpdateDirectionalLightUniformBuffers(RHICmdList, View);
+		}
+
+		// Low res view at its place in the tier's targets, as for the Auto tier, the last view ends the pass.
+		// Its size is the tier's own scale, which also gives the factor of the material depth reads, 1 for Full and 4 for Quarter.
+		const FIntRect DownsampledViewRect = GetDownsampledTranslucencyViewRect(View, Resolution);
+		GMobileDownsampledViewUniformBuffers.Update(RHICmdList, View, Resolution, BufferSize, DownsampledViewRect);
+		DrawDownsampledTranslucencyPass(RHICmdList, View, Resolution, RPInfo.ColorRenderTargets[0].RenderTarget, RPInfo.DepthStencilRenderTarget.DepthStencilTarget, DownsampledViewRect, DownsampledViewRect, ViewIndex == PassViews.Num() - 1);
+	}
+
+	RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, Tier.Depth->GetRenderTargetItem().TargetableTexture);
+	RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, Tier.Color->GetRenderTargetItem().TargetableTexture);
+}
+
+/** Records the draws of an off-screen particle pass in parallel, every command list resumes the low res render pass. */
+class FMobileDownsampleTranslucencyParallelCommandListSet : public FParallelCommandListSet
+{
+	FRHIRenderPassInfo RPInfo;
+	FIntRect DownsampledViewRect;
+	FIntRect ScissorRect;
+
+public:
+	FMobileDownsampleTranslucencyParallelCommandListSet(
+		const FViewInfo& InView,
+		const FSceneRenderer* InSceneRenderer,
+		FRHICommandListImmediate& InParentCmdList,
+		bool bInParallelExecute,
+		const FMeshPassProcessorRenderState& InDrawRenderState,
+		FRHITexture* ColorTarget,
+		FRHITexture* DepthTarget,
+		const FIntRect& InDownsampledViewRect,
+		const FIntRect& InScissorRect)
+		: FParallelCommandListSet(GET_STATID(STAT_CLP_MobileDownsampleTranslucency), InView, InSceneRenderer, InParentCmdList, bInParallelExecute, true, InDrawRenderState)
+		, RPInfo(ColorTarget, ERenderTargetActions::Load_Store, nullptr, DepthTarget, EDepthStencilTargetActions::LoadDepthStencil_StoreDepthStencil, nullptr, FExclusiveDepthStencil::DepthWrite_StencilWrite)
+		, DownsampledViewRect(InDownsampledViewRect)
+		, ScissorRect(InScissorRect)
+	{
+		// Array targets are only rendered by the mobile multi-view passes
+		RPInfo.bMultiviewPass = ColorTarget->GetTexture2DArray() != nullptr;
+	}
+
+	virtual ~FMobileDownsampleTranslucencyParallelCommandListSet()
+	{
+		Dispatch();
+	}
+
+	virtual void SetStateOnCommandList(FRHICommandList& CmdList) override
+	{
+		FParallelCommandListSet::SetStateOnCommandList(CmdList);
+		CmdList.BeginRenderPass(RPInfo, TEXT("SeparateTranslucencyParallel"));
+		CmdList.SetViewport(DownsampledViewRect.Min.X, DownsampledViewRect.Min.Y, 0.0f, DownsampledViewRect.Max.X, DownsampledViewRect.Max.Y, 1.0f);
+		CmdList.SetScissorRect(true, ScissorRect.Min.X, ScissorRect.Min.Y, ScissorRect.Max.X, ScissorRect.Max.Y);
+	}
+};
+
+static bool ShouldRecordDownsampledTranslucencyInParallel(const FViewInfo& View)
+{
+	static const auto* ParallelTranslucencyCVar = IConsoleManager::Get().FindTConsoleVariableDataInt(TEXT("r.ParallelTranslucency"));
+	return GRHICommandList.UseParallelAlgorithms()
+		&& GRHISupportsParallelRHIExecute
+		&& CVarMobileSeparateTranslucencyParallel.GetValueOnRenderThread() != 0
+		&& ParallelTranslucencyCVar && ParallelTranslucencyCVar->GetValueOnRenderThread() != 0
+		&& !View.Family->UseDebugViewPS();
+}
+
+void FMobileSceneRenderer::DrawDownsampledTranslucencyPass(FRHICommandListImmediate& RHICmdList, const FViewInfo& View, EMobileDownsampleTranslucencyResolution Resolution, FRHITexture* ColorTarget, FRHITexture* DepthTarget, const FIntRect& DownsampledViewRect, const FIntRect& ScissorRect, bool bEndRenderPass)
+{
+	check(RHICmdList.IsInsideRenderPass());
+	SCOPE_CYCLE_COUNTER(STAT_MobileDownsampleTranslucencyDispatch);
+
+	// Parallel command lists resume the pass once per list, the views of an atlas keep it to a single one
+	const bool bCanRecordInParallel = bEndRenderPass && !bDownsampledTranslucencyAtlas;
+	const EMeshPass::Type MeshPass = TranslucencyPassToMeshPass(GetMobileDownsampleTranslucencyPass(Resolution));
+	bool bParallel = bCanRecordInParallel && ShouldRecordDownsampledTranslucencyInParallel(View);
+
+#if !UE_BUILD_SHIPPING
+	const bool bBenchmark = GMobileDownsampleTranslucencyDispatchBenchmark.IsActive() && !View.Family->UseDebugViewPS();
+	if (bBenchmark)
+	{
+		bParallel = bCanRecordInParallel && GMobileDownsampleTranslucencyDispatchBenchmark.ShouldRecordInParallel();
+	}
+	const uint32 StartCycles = FPlatformTime::Cycles();
+#endif
+
+	// The particles are drawn under the scissor of the depth downsample
+	if (bParallel)
+	{
+		RHICmdList.SetScissorRect(false, 0, 0, 0, 0);
+		RHICmdList.EndRenderPass();
+
+		static const auto* DeferredContextsCVar = IConsoleManager::Get().FindTConsoleVariableDataInt(TEXT("r.RHICmdTranslucencyPassDeferredContexts"));
+		FMobileDownsampleTranslucencyParallelCommandListSet ParallelCommandListSet(
+			View,
+			this,
+			RHICmdList,
+			!DeferredContextsCVar || DeferredContextsCVar->GetValueOnRenderThread() > 0,
+			FMeshPassProcessorRenderState(GMobileDownsampledViewUniformBuffers.Get(Resolution), GMobileDownsampledViewUniformBuffers.GetBasePass(Resolution)),
+			ColorTarget,
+			DepthTarget,
+			DownsampledViewRect,
+			ScissorRect);
+
+		View.ParallelMeshDrawCommandPasses[MeshPass].DispatchDraw(&ParallelCommandListSet, RHICmdList);
+	}
+	else
+	{
+		RHICmdList.SetViewport(DownsampledViewRect.Min.X, DownsampledViewRect.Min.Y, 0.0f, DownsampledViewRect.Max.X, DownsampledViewRect.Max.Y, 1.0f);
+		RHICmdList.SetScissorRect(true, ScissorRect.Min.X, ScissorRect.Min.Y, ScissorRect.Max.X, ScissorRect.Max.Y);
+		if (!View.Family->UseDebugViewPS())
+		{
+			View.ParallelMeshDrawCommandPasses[MeshPass].DispatchDraw(nullptr, RHICmdList);
+		}
+		RHICmdList.SetScissorRect(false, 0, 0, 0, 0);
+		if (bEndRenderPass)
+		{
+			RHICmdList.EndRenderPass();
+		}
+	}
+
+#if !UE_BUILD_SHIPPING
+	if (bBenchmark)
+	{
+		GMobileDownsampleTranslucencyDispatchBenchmark.AddSample(bParallel, View.MobileDownsampleTranslucencyPrimitives[(int32)Resolution].Num(), FPlatformTime::Cycles() - StartCycles);
+	}
+#endif
+}
+
+void FMobileSceneRenderer::UpdateDownsampledTranslucencyDepthHistory(FRHICommandListImmediate& RHICmdList)
 {
-	// Function MUST be self-contained wrt RenderPasses
 	check(RHICmdList.IsOutsideRenderPass());
 
-	bool bDirty = false;
+	SCOPED_DRAW_EVENT(RHICmdList, DownsampledTranslucencyDepthHistory);
+
 	FSceneRenderTargets& SceneContext = FSceneRenderTargets::Get(RHICmdList);
+	RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, SceneContext.GetSceneDepthSurface());
 
-	SceneContext.AllocSceneColor(RHICmdList);
+	for (const FViewInfo& View : Views)
+	{
+		FMobileDownsampleTranslucencyDepthHistory::FViewHistory* DepthHistory = GMobileDownsampleTranslucencyDepthHistory.FindOrAdd(View);
+		if (!DepthHistory || !View.ShouldRenderView())
+		{
+			continue;
+		}
 
-	const bool bMobileMSAA = SceneContext.GetSceneColorSurface()->GetNumSamples() > 1;
+		const float DownsamplingScale = View.MobileDownsampleTranslucencyScale;
+		const FIntPoint BufferSize = GetDownsampledTranslucencySize(SceneContext.GetBufferSizeXY(), DownsamplingScale);
+		const FIntPoint DownsampledViewSize = GetDownsampledTranslucencySize(View.ViewRect.Size(), DownsamplingScale);
+
+		FPooledRenderTargetDesc Desc(FPooledRenderTargetDesc::Create2DDesc(BufferSize, PF_R32_FLOAT, FClearValueBinding::None, TexCreate_None, TexCreate_RenderTargetable | TexCreate_ShaderResource, false));
+		GRenderTargetPool.FindFreeElement(RHICmdList, Desc, DepthHistory->LowResDepth, TEXT("SeparateTranslucencyDepthHistory"));
+		DepthHistory->ViewSize = DownsampledViewSize;
+		DepthHistory->FrameNumber = View.Family->FrameNumber;
+
+		FRHITexture* HistoryTexture = DepthHistory->LowResDepth->GetRenderTargetItem().TargetableTexture;
+		FRHIRenderPassInfo RPInfo(HistoryTexture, ERenderTargetActions::DontLoad_Store);
+		RHICmdList.TransitionResource(EResourceTransitionAccess::EWritable, HistoryTexture);
+		AccountRenderPassBandwidth(RPInfo);
+		RHICmdList.BeginRenderPass(RPInfo, TEXT("DownsampledTranslucencyDepthHistory"));
+		// The next frame's particles can be anywhere, the history is never scissored
+		const FIntRect DownsampledViewRect(FIntPoint::ZeroValue, DownsampledViewSize);
+		DrawDownsampleSceneDepth<FMobileDownsampledDepthHistoryPS>(RHICmdList, View, DownsampledViewRect, DownsampledViewRect, TStaticBlendState<>::GetRHI(), TStaticDepthStencilState<false, CF_Always>::GetRHI(), nullptr);
+		RHICmdList.SetScissorRect(false, 0, 0, 0, 0);
+		RHICmdList.EndRenderPass();
+		RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, HistoryTexture);
+	}
+}
 
-	FRHITexture* SceneColorResolve = bMobileMSAA ? SceneContext.GetSceneColorTexture() : nullptr;
-	ERenderTargetActions ColorTargetAction = bMobileMSAA ? ERenderTargetActions::Clear_Resolve : ERenderTargetActions::Clear_Store;
-	FRHIRenderPassInfo RPInfo(
-		SceneContext.GetSceneColorSurface(),
-		ColorTargetAction,
-		SceneColorResolve,
-		SceneContext.GetSceneDepthSurface(),
-		EDepthStencilTargetActions::ClearDepthStencil_DontStoreDepthStencil,
-		nullptr,
-		FExclusiveDepthStencil::DepthRead_StencilRead
-	);
 
-	// make sure targets are writable
-	RHICmdList.TransitionResource(EResourceTransitionAccess::EWritable, SceneContext.GetSceneColorSurface());
-	RHICmdList.TransitionResource(EResourceTransitionAccess::EWritable, SceneContext.GetSceneDepthSurface());
-	if (SceneColorResolve)
+
+class FMobileTranslucencyUpsamplingPS : public FGlobalShader
+{
+	//DECLARE_INLINE_TYPE_LAYOUT(FMobileTranslucencyUpsamplingPS, NonVirtual);
+	DECLARE_SHADER_TYPE(FMobileTranslucencyUpsamplingPS, Global);
+public:
+
+	/** Classifies interior pixels from the low res min/max depth, see r.Mobile.SeparateTranslucencyMinMaxDepth. */
+	class FMinMaxDepthDim : SHADER_PERMUTATION_BOOL("MOBILE_TRANSLUCENCY_UPSAMPLE_MINMAX");
+	using FPermutationDomain = TShaderPermutationDomain<FMinMaxDepthDim>;
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
 	{
-		RHICmdList.TransitionResource(EResourceTransitionAccess::EWritable, SceneColorResolve);
+		return true;
 	}
 
-	if (Scene->UniformBuffers.UpdateViewUniformBuffer(View))
+	/** Default constructor. */
+	FMobileTranslucencyUpsamplingPS()
 	{
-		UpdateTranslucentBasePassUniformBuffer(RHICmdList, View);
-		UpdateDirectionalLightUniformBuffers(RHICmdList, View);
+
 	}
+	LAYOUT_FIELD(FShaderParameter, SLInvDeviceZToWorldZTransform);
 
-	RHICmdList.BeginRenderPass(RPInfo, TEXT("RenderInverseOpacity"));
+	LAYOUT_FIELD(FShaderResourceParameter, LowResColorTexture_0);
+	LAYOUT_FIELD(FShaderResourceParameter, LowResColorTexture_1);
+	LAYOUT_FIELD(FShaderResourceParameter, LowResDepthTexture);
+	LAYOUT_FIELD(FShaderResourceParameter, FullResDepthTexture);
+	LAYOUT_FIELD(FShaderResourceParameter, LowResMinMaxDepthTexture);
 
-	if (ShouldRenderTranslucency(ETranslucencyPass::TPT_AllTranslucency))
+	LAYOUT_FIELD(FShaderResourceParameter, BilinearClampedSampler);
+	LAYOUT_FIELD(FShaderResourceParameter, PointClampedSampler);
+	LAYOUT_FIELD(FShaderResourceParameter, BilinearLowDepthClampedSampler);
+
+public:
+
+	/** Initialization constructor. */
+	FMobileTranslucencyUpsamplingPS(const ShaderMetaType::CompiledShaderInitializerType& Initializer)
+		: FGlobalShader(Initializer)
 	{
-		// Mobile multi-view is not side by side stereo
-		const FViewInfo& TranslucentViewport = (View.bIsMobileMultiViewEnabled) ? Views[0] : View;
-		RHICmdList.SetViewport(TranslucentViewport.ViewRect.Min.X, TranslucentViewport.ViewRect.Min.Y, 0.0f, TranslucentViewport.ViewRect.Max.X, TranslucentViewport.ViewRect.Max.Y, 1.0f);
+		SLInvDeviceZToWorldZTransform.Bind(Initializer.ParameterMap, TEXT("SLInvDeviceZToWorldZTransform"));
+		LowResColorTexture_0.Bind(Initializer.ParameterMap, TEXT("LowResColorTexture_0"));
+		LowResColorTexture_1.Bind(Initializer.ParameterMap, TEXT("LowResColorTexture_1"));
+		LowResDepthTexture.Bind(Initializer.ParameterMap, TEXT("LowResDepthTexture"));
+		FullResDepthTexture.Bind(Initializer.ParameterMap, TEXT("FullResDepthTexture"));
+		LowResMinMaxDepthTexture.Bind(Initializer.ParameterMap, TEXT("LowResMinMaxDepthTexture"));
 
-		View.ParallelMeshDrawCommandPasses[EMeshPass::MobileInverseOpacity].DispatchDraw(nullptr, RHICmdList);
+		BilinearClampedSampler.Bind(Initializer.ParameterMap, TEXT("BilinearClampedSampler"));
+		PointClampedSampler.Bind(Initializer.ParameterMap, TEXT("PointClampedSampler"));
+		BilinearLowDepthClampedSampler.Bind(Initializer.ParameterMap, TEXT("BilinearLowDepthClampedSampler"));
+	}
 
-		bDirty |= View.ParallelMeshDrawCommandPasses[EMeshPass::MobileInverseOpacity].HasAnyDraw();
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
 	}
 
-	RHICmdList.EndRenderPass();
 
-	RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, SceneContext.GetSceneColorTexture());
+	void SetParameters(FRHICommandList& RHICmdList, const FViewInfo& View, const FDownsampledTranslucencyInputs& LowRes)
+	{
+		FRHIPixelShader* ShaderRHI = RHICmdList.GetBoundPixelShader();
 
-	return bDirty;
-}
+		//FGlobalShader::SetParameters<FViewUniformShaderParameters>(RHICmdList, ShaderRHI, View.ViewUniformBuffer);
 
-class FMobileInverseOpacityMeshProcessor : public FMeshPassProcessor
+		FSceneRenderTargets& SceneContext = FSceneRenderTargets::Get(RHICmdList);
+
+		SetShaderValue(RHICmdList, RHICmdList.GetBoundPixelShader(), SLInvDeviceZToWorldZTransform, View.InvDeviceZToWorldZTransform);
+		//Because OpenGL does not support the separation of Texture and Sampler, bind the same texture to two texture units
+		SetTextureParameter(RHICmdList, ShaderRHI, LowResColorTexture_0, LowRes.Color);
+		SetTextureParameter(RHICmdList, ShaderRHI, LowResColorTexture_1, LowRes.Color);
+		SetTextureParameter(RHICmdList, ShaderRHI, LowResDepthTexture, LowRes.Depth);
+		if (LowRes.MinMaxDepth)
+		{
+			SetTextureParameter(RHICmdList, ShaderRHI, LowResMinMaxDepthTexture, LowRes.MinMaxDepth);
+		}
+
+#if !PLATFORM_IOS && !PLATFORM_ANDROID
+		SetTextureParameter(RHICmdList, ShaderRHI, FullResDepthTexture, SceneContext.GetSceneDepthSurface());
+#endif
+
+		SetSamplerParameter(RHICmdList, ShaderRHI, BilinearClampedSampler, TStaticSamplerState<SF_Bilinear, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI());
+		SetSamplerParameter(RHICmdList, ShaderRHI, PointClampedSampler, TStaticSamplerState<SF_Point, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI());
+		SetSamplerParameter(RHICmdList, ShaderRHI, BilinearLowDepthClampedSampler, TStaticSamplerState<SF_Bilinear, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI());
+	}
+};
+
+
+IMPLEMENT_SHADER_TYPE(, FMobileTranslucencyUpsamplingPS, TEXT("/Engine/Private/MobileTranslucencyUpsampling.usf"), TEXT("MobileNearestDepthNeighborUpsamplingPS"), SF_Pixel);
+
+/** Draws the nearest-depth pixels of the upsample without writing them, see r.Mobile.SeparateTranslucencyUpsampleClassStats. */
+class FMobileTranslucencyUpsampleClassifyPS : public FMobileTranslucencyUpsamplingPS
 {
+	DECLARE_SHADER_TYPE(FMobileTranslucencyUpsampleClassifyPS, Global);
 public:
-	const FMeshPassProcessorRenderState PassDrawRenderState;
+	using FPermutationDomain = FShaderPermutationNone;
+
+	FMobileTranslucencyUpsampleClassifyPS(const ShaderMetaType::CompiledShaderInitializerType& Initializer)
+		: FMobileTranslucencyUpsamplingPS(Initializer)
+	{}
+	FMobileTranslucencyUpsampleClassifyPS() {}
+};
+
+IMPLEMENT_SHADER_TYPE(, FMobileTranslucencyUpsampleClassifyPS, TEXT("/Engine/Private/MobileTranslucencyUpsampling.usf"), TEXT("MobileUpsampleClassifyPS"), SF_Pixel);
 
+/** Nearest-depth upsample of both eyes of mobile multi-view, from array targets. */
+class FMobileTranslucencyUpsamplingMultiViewPS : public FMobileTranslucencyUpsamplingPS
+{
+	DECLARE_SHADER_TYPE(FMobileTranslucencyUpsamplingMultiViewPS, Global);
 public:
-	FMobileInverseOpacityMeshProcessor(const FScene* InScene, ERHIFeatureLevel::Type InFeatureLevel, const FSceneView* InViewIfDynamicMeshCommand, const FMeshPassProcessorRenderState& InDrawRenderState, FMeshPassDrawListContext* InDrawListContext)
-		: FMeshPassProcessor(InScene, InFeatureLevel, InViewIfDynamicMeshCommand, InDrawListContext)
-		, PassDrawRenderState(InDrawRenderState)
+	using FPermutationDomain = FShaderPermutationNone;
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
 	{
-		// expect dynamic path
-		check(InViewIfDynamicMeshCommand);
+		return RHISupportsMobileMultiView(Parameters.Platform);
 	}
 
-	virtual void AddMeshBatch(const FMeshBatch& RESTRICT MeshBatch, uint64 BatchElementMask, const FPrimitiveSceneProxy* RESTRICT PrimitiveSceneProxy, int32 StaticMeshId = -1) override final
+	FMobileTranslucencyUpsamplingMultiViewPS(const ShaderMetaType::CompiledShaderInitializerType& Initializer)
+		: FMobileTranslucencyUpsamplingPS(Initializer)
+	{}
+	FMobileTranslucencyUpsamplingMultiViewPS() {}
+
+	void SetParameters(FRHICommandList& RHICmdList, const FViewInfo& View, const FDownsampledTranslucencyInputs& LowRes)
 	{
-		if (MeshBatch.bUseForMaterial)
-		{
-			// Determine the mesh's material and blend mode.
-			const FMaterialRenderProxy* FallbackMaterialRenderProxyPtr = nullptr;
-			const FMaterial& Material = MeshBatch.MaterialRenderProxy->GetMaterialWithFallback(FeatureLevel, FallbackMaterialRenderProxyPtr);
-			const FMaterialRenderProxy& MaterialRenderProxy = FallbackMaterialRenderProxyPtr ? *FallbackMaterialRenderProxyPtr : *MeshBatch.MaterialRenderProxy;
-			const EBlendMode BlendMode = Material.GetBlendMode();
-			const bool bIsTranslucent = IsTranslucentBlendMode(BlendMode);
+		FMobileTranslucencyUpsamplingPS::SetParameters(RHICmdList, View, LowRes);
 
-			if (bIsTranslucent)
-			{
-				Process(MeshBatch, BatchElementMask, Material, MaterialRenderProxy, PrimitiveSceneProxy, StaticMeshId);
-			}
-		}
+		// Scene color alpha is not the depth of the multi-view scene color, the stored multi-view depth is read on every platform
+		FSceneRenderTargets& SceneContext = FSceneRenderTargets::Get(RHICmdList);
+		SetTextureParameter(RHICmdList, RHICmdList.GetBoundPixelShader(), FullResDepthTexture, SceneContext.MobileMultiViewSceneDepthZ->GetRenderTargetItem().ShaderResourceTexture);
 	}
+};
 
-private:
-	void Process(const FMeshBatch& MeshBatch, uint64 BatchElementMask, const FMaterial& Material, const FMaterialRenderProxy& MaterialRenderProxy, const FPrimitiveSceneProxy* PrimitiveSceneProxy, int32 StaticMeshId)
+IMPLEMENT_SHADER_TYPE(, FMobileTranslucencyUpsamplingMultiViewPS, TEXT("/Engine/Private/MobileTranslucencyMultiView.usf"), TEXT("MobileNearestDepthNeighborUpsamplingMultiViewPS"), SF_Pixel);
+
+/** Lists the low res tiles with particle contribution, see r.Mobile.SeparateTranslucencyTileComposite. */
+class FMobileUpsampleTileClassifyCS : public FGlobalShader
+{
+	DECLARE_SHADER_TYPE(FMobileUpsampleTileClassifyCS, Global);
+public:
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
 	{
-		const FVertexFactory* VertexFactory = MeshBatch.VertexFactory;
+		return IsMobileUpsampleTileCompositeSupported(Parameters.Platform);
+	}
 
-		TMeshProcessorShaders<
-			FOpacityOnlyVS,
-			FBaseHS,
-			FBaseDS,
-			FOpacityOnlyPS> InverseOpacityShaders;
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("MOBILE_UPSAMPLE_TILE_SIZE"), MobileTranslucencyUpsampling::UpsampleTileSize);
+	}
 
-		InverseOpacityShaders.VertexShader = Material.GetShader<FOpacityOnlyVS>(VertexFactory->GetType());
-		InverseOpacityShaders.PixelShader = Material.GetShader<FOpacityOnlyPS>(VertexFactory->GetType());
+	FMobileUpsampleTileClassifyCS() {}
 
-		FMeshPassProcessorRenderState DrawRenderState(PassDrawRenderState);
-		MobileBasePass::SetTranslucentRenderState(DrawRenderState, Material);
+	FMobileUpsampleTileClassifyCS(const ShaderMetaType::CompiledShaderInitializerType& Initializer)
+		: FGlobalShader(Initializer)
+	{
+		LowResColorTexture_0.Bind(Initializer.ParameterMap, TEXT("LowResColorTexture_0"));
+		TileClassifyRect.Bind(Initializer.ParameterMap, TEXT("TileClassifyRect"));
+		RWTileList.Bind(Initializer.ParameterMap, TEXT("RWTileList"));
+		RWTileDrawIndirectArgs.Bind(Initializer.ParameterMap, TEXT("RWTileDrawIndirectArgs"));
+	}
 
-		const FMeshDrawingPolicyOverrideSettings OverrideSettings = ComputeMeshOverrideSettings(MeshBatch);
-		ERasterizerFillMode MeshFillMode = ComputeMeshFillMode(MeshBatch, Material, OverrideSettings);
-		ERasterizerCullMode MeshCullMode = ComputeMeshCullMode(MeshBatch, Material, OverrideSettings);
+	void SetParameters(FRHICommandList& RHICmdList, FRHITexture* LowResColorTexture, const FIntRect& ClassifyRect)
+	{
+		FRHIComputeShader* ShaderRHI = RHICmdList.GetBoundComputeShader();
 
-		FMeshMaterialShaderElementData ShaderElementData;
-		ShaderElementData.InitializeMeshMaterialData(ViewIfDynamicMeshCommand, PrimitiveSceneProxy, MeshBatch, StaticMeshId, false);
+		SetTextureParameter(RHICmdList, ShaderRHI, LowResColorTexture_0, LowResColorTexture);
+		SetShaderValue(RHICmdList, ShaderRHI, TileClassifyRect, FIntVector4(ClassifyRect.Min.X, ClassifyRect.Min.Y, ClassifyRect.Max.X, ClassifyRect.Max.Y));
+		RWTileList.SetBuffer(RHICmdList, ShaderRHI, GMobileUpsampleTileList.TileList);
+		RWTileDrawIndirectArgs.SetBuffer(RHICmdList, ShaderRHI, GMobileUpsampleTileList.DrawIndirectArgs);
+	}
 
-		FMeshDrawCommandSortKey SortKey = CalculateTranslucentMeshStaticSortKey(PrimitiveSceneProxy, MeshBatch.MeshIdInPrimitive);
+	void UnsetParameters(FRHICommandList& RHICmdList)
+	{
+		FRHIComputeShader* ShaderRHI = RHICmdList.GetBoundComputeShader();
+		RWTileList.UnsetUAV(RHICmdList, ShaderRHI);
+		RWTileDrawIndirectArgs.UnsetUAV(RHICmdList, ShaderRHI);
+	}
 
-		BuildMeshDrawCommands(
-			MeshBatch,
-			BatchElementMask,
-			PrimitiveSceneProxy,
-			MaterialRenderProxy,
-			Material,
-			PassDrawRenderState,
-			InverseOpacityShaders,
-			MeshFillMode,
-			MeshCullMode,
-			SortKey,
-			EMeshPassFeatures::Default,
-			ShaderElementData);
+private:
+	LAYOUT_FIELD(FShaderResourceParameter, LowResColorTexture_0);
+	LAYOUT_FIELD(FShaderParameter, TileClassifyRect);
+	LAYOUT_FIELD(FRWShaderParameter, RWTileList);
+	LAYOUT_FIELD(FRWShaderParameter, RWTileDrawIndirectArgs);
+};
+
+IMPLEMENT_SHADER_TYPE(, FMobileUpsampleTileClassifyCS, TEXT("/Engine/Private/MobileTranslucencyUpsampling.usf"), TEXT("MobileUpsampleTileClassifyCS"), SF_Compute);
+
+/** Expands the tile list into one quad per tile, replaces FScreenVS for the upsample shaders. */
+class FMobileUpsampleTileVS : public FGlobalShader
+{
+	DECLARE_SHADER_TYPE(FMobileUpsampleTileVS, Global);
+public:
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsMobileUpsampleTileCompositeSupported(Parameters.Platform);
+	}
+
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("MOBILE_UPSAMPLE_TILE_SIZE"), MobileTranslucencyUpsampling::UpsampleTileSize);
+	}
+
+	FMobileUpsampleTileVS() {}
+
+	FMobileUpsampleTileVS(const ShaderMetaType::CompiledShaderInitializerType& Initializer)
+		: FGlobalShader(Initializer)
+	{
+		TileList.Bind(Initializer.ParameterMap, TEXT("TileList"));
+		UpsampleLowResViewSize.Bind(Initializer.ParameterMap, TEXT("UpsampleLowResViewSize"));
+		UpsampleLowResBufferInvSize.Bind(Initializer.ParameterMap, TEXT("UpsampleLowResBufferInvSize"));
+	}
+
+	void SetParameters(FRHICommandList& RHICmdList, FIntPoint DownsampledViewSize, FIntPoint DownsampledBufferSize)
+	{
+		FRHIVertexShader* ShaderRHI = RHICmdList.GetBoundVertexShader();
+
+		SetSRVParameter(RHICmdList, ShaderRHI, TileList, GMobileUpsampleTileList.TileList.SRV);
+		SetShaderValue(RHICmdList, ShaderRHI, UpsampleLowResViewSize, FVector2D(DownsampledViewSize));
+		SetShaderValue(RHICmdList, ShaderRHI, UpsampleLowResBufferInvSize, FVector2D(1.0f / DownsampledBufferSize.X, 1.0f / DownsampledBufferSize.Y));
 	}
+
+private:
+	LAYOUT_FIELD(FShaderResourceParameter, TileList);
+	LAYOUT_FIELD(FShaderParameter, UpsampleLowResViewSize);
+	LAYOUT_FIELD(FShaderParameter, UpsampleLowResBufferInvSize);
 };
 
-// This pass is registered only when we render to scene capture, see UpdateSceneCaptureContentMobile_RenderThread()
-FMeshPassProcessor* CreateMobileInverseOpacityPassProcessor(const FScene* Scene, const FSceneView* InViewIfDynamicMeshCommand, FMeshPassDrawListContext* InDrawListContext)
+IMPLEMENT_SHADER_TYPE(, FMobileUpsampleTileVS, TEXT("/Engine/Private/MobileTranslucencyUpsampling.usf"), TEXT("MobileUpsampleTileVS"), SF_Vertex);
+
+/**
+ * Draws one of the upsample shaders over the full res view, the render pass must already be begun.
+ * With bTileList only the tiles listed by ClassifyUpsampleTiles are drawn, with an indirect instanced draw.
+ * VertexShaderType is FMobileMultiViewScreenVS in mobile multi-view passes.
+ */
+template<typename PixelShaderType, typename VertexShaderType = FScreenVS>
+static void DrawUpsampleTranslucency(FRHICommandList& RHICmdList, const FViewInfo& View, const FDownsampledTranslucencyInputs& LowRes, const TShaderRef<PixelShaderType>& PixelShader, FRHIBlendState* BlendState, FRHIDepthStencilState* DepthStencilState, uint32 StencilRef, bool bTileList)
 {
-	FMeshPassProcessorRenderState PassDrawRenderState(Scene->UniformBuffers.ViewUniformBuffer, Scene->UniformBuffers.MobileTranslucentBasePassUniformBuffer);
-	PassDrawRenderState.SetDepthStencilState(TStaticDepthStencilState<false, CF_DepthNearOrEqual>::GetRHI());
-	PassDrawRenderState.SetBlendState(TStaticBlendState<CW_ALPHA, BO_Add, BF_DestColor, BF_Zero, BO_Add, BF_Zero, BF_InverseSourceAlpha>::GetRHI());
+	TShaderMapRef<VertexShaderType> ScreenVertexShader(View.ShaderMap);
 
-	return new(FMemStack::Get()) FMobileInverseOpacityMeshProcessor(Scene, Scene->GetFeatureLevel(), InViewIfDynamicMeshCommand, PassDrawRenderState, InDrawListContext);
-}
+	FGraphicsPipelineStateInitializer GraphicsPSOInit;
+	RHICmdList.ApplyCachedRenderTargets(GraphicsPSOInit);
+	GraphicsPSOInit.RasterizerState = TStaticRasterizerState<FM_Solid, CM_None>::GetRHI();
+	GraphicsPSOInit.DepthStencilState = DepthStencilState;
+	GraphicsPSOInit.BlendState = BlendState;
 
+	if (bTileList)
+	{
+		TShaderMapRef<FMobileUpsampleTileVS> TileVertexShader(View.ShaderMap);
+		GraphicsPSOInit.BoundShaderState.VertexDeclarationRHI = GEmptyVertexDeclaration.VertexDeclarationRHI;
+		GraphicsPSOInit.BoundShaderState.VertexShaderRHI = TileVertexShader.GetVertexShader();
+	}
+	else
+	{
+		GraphicsPSOInit.BoundShaderState.VertexDeclarationRHI = GFilterVertexDeclaration.VertexDeclarationRHI;
+		GraphicsPSOInit.BoundShaderState.VertexShaderRHI = ScreenVertexShader.GetVertexShader();
+	}
+	GraphicsPSOInit.BoundShaderState.PixelShaderRHI = PixelShader.GetPixelShader();
+	GraphicsPSOInit.PrimitiveType = PT_TriangleList;
 
+	SetGraphicsPipelineState(RHICmdList, GraphicsPSOInit);
+	RHICmdList.SetStencilRef(StencilRef);
 
-/** A simple pixel shader used on Mobile to read scene depth from scene color alpha and write it to a downsized depth buffer. */
-class FMobileDownsampleSceneDepthPS : public FGlobalShader
+	PixelShader->SetParameters(RHICmdList, View, LowRes);
+
+	const FIntVector TextureSize = LowRes.Color->GetSizeXYZ();
+	const int32 TextureWidth = TextureSize.X;
+	const int32 TextureHeight = TextureSize.Y;
+	const FIntPoint DownsampledViewSize = GetDownsampledTranslucencySize(View.ViewRect.Size(), LowRes.DownsamplingScale);
+
+	RHICmdList.SetViewport(View.ViewRect.Min.X, View.ViewRect.Min.Y, 0.0f, View.ViewRect.Max.X, View.ViewRect.Max.Y, 1.0f);
+
+	const FIntRect ScissorRect = LowRes.Rect + View.ViewRect.Min;
+	RHICmdList.SetScissorRect(true, ScissorRect.Min.X, ScissorRect.Min.Y, ScissorRect.Max.X, ScissorRect.Max.Y);
+
+	if (bTileList)
+	{
+		// Only built for a view alone in the low res target
+		check(LowRes.ViewMin == FIntPoint::ZeroValue);
+		TShaderMapRef<FMobileUpsampleTileVS> TileVertexShader(View.ShaderMap);
+		TileVertexShader->SetParameters(RHICmdList, DownsampledViewSize, FIntPoint(TextureWidth, TextureHeight));
+		RHICmdList.DrawPrimitiveIndirect(GMobileUpsampleTileList.DrawIndirectArgs.Buffer, 0);
+	}
+	else
+	{
+		DrawRectangle(
+			RHICmdList,
+			0, 0,
+			View.ViewRect.Width(), View.ViewRect.Height(),
+			LowRes.ViewMin.X, LowRes.ViewMin.Y,
+			DownsampledViewSize.X, DownsampledViewSize.Y,
+			View.ViewRect.Size(),
+			FIntPoint(TextureWidth, TextureHeight),
+			ScreenVertexShader,
+			EDRF_UseTriangleOptimization);
+	}
+
+	// The composite can share its pass with the scene color draws
+	RHICmdList.SetScissorRect(false, 0, 0, 0, 0);
+}
+
+/** Draws the upsample of the low res targets of a tier, shared by the immediate and the render graph composites. */
+static void DrawUpsampleTranslucencyTier(FRHICommandList& RHICmdList, const FViewInfo& View, const FDownsampledTranslucencyInputs& LowRes, bool bTileList)
 {
-	DECLARE_SHADER_TYPE(FMobileDownsampleSceneDepthPS, Global);
-public:
+	FRHITexture* MinMaxDepthTexture = LowRes.MinMaxDepth;
+	AccountDownsampledTranslucencyColorTraffic(LowRes, 1);
 
-	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	// The pixel classes are only known with the min/max depth, see MinMaxMain
+	FRHIRenderQuery* PixelQuery = nullptr;
+	FRHIRenderQuery* EdgeQuery = nullptr;
+	if (MinMaxDepthTexture && CVarMobileSeparateTranslucencyUpsampleClassStats.GetValueOnRenderThread() != 0)
 	{
-		return true;
+		GMobileUpsamplePixelClassQueries.Allocate(PixelQuery, EdgeQuery);
 	}
 
-	FMobileDownsampleSceneDepthPS(const ShaderMetaType::CompiledShaderInitializerType& Initializer) :
-		FGlobalShader(Initializer)
+	if (PixelQuery)
 	{
-		SLInvDeviceZToWorldZTransform.Bind(Initializer.ParameterMap, TEXT("SLInvDeviceZToWorldZTransform"));
-		SLSceneColorTexture.Bind(Initializer.ParameterMap, TEXT("SLSceneColorTexture"));
+		RHICmdList.BeginRenderQuery(PixelQuery);
 	}
-	FMobileDownsampleSceneDepthPS() {}
-
-	void SetParameters(FRHICommandList& RHICmdList, const FViewInfo& View)
+	FMobileTranslucencyUpsamplingPS::FPermutationDomain PermutationVector;
+	PermutationVector.Set<FMobileTranslucencyUpsamplingPS::FMinMaxDepthDim>(MinMaxDepthTexture != nullptr);
+	TShaderMapRef<FMobileTranslucencyUpsamplingPS> PixelShader(View.ShaderMap, PermutationVector);
+	DrawUpsampleTranslucency(RHICmdList, View, LowRes, PixelShader, TStaticBlendState<CW_RGB, BO_Add, BF_One, BF_SourceAlpha>::GetRHI(), TStaticDepthStencilState<false, CF_Always>::GetRHI(), 0, bTileList);
+	if (PixelQuery)
 	{
-		FSceneRenderTargets& SceneContext = FSceneRenderTargets::Get(RHICmdList);
+		RHICmdList.EndRenderQuery(PixelQuery);
+	}
 
-		SetShaderValue(RHICmdList, RHICmdList.GetBoundPixelShader(), SLInvDeviceZToWorldZTransform, View.InvDeviceZToWorldZTransform);
-		SetTextureParameter(RHICmdList, RHICmdList.GetBoundPixelShader(), SLSceneColorTexture, SceneContext.GetSceneColorSurface());
+	if (EdgeQuery)
+	{
+		RHICmdList.BeginRenderQuery(EdgeQuery);
+		TShaderMapRef<FMobileTranslucencyUpsampleClassifyPS> ClassifyShader(View.ShaderMap);
+		DrawUpsampleTranslucency(RHICmdList, View, LowRes, ClassifyShader, TStaticBlendState<CW_NONE>::GetRHI(), TStaticDepthStencilState<false, CF_Always>::GetRHI(), 0, bTileList);
+		RHICmdList.EndRenderQuery(EdgeQuery);
 	}
+}
 
-	LAYOUT_FIELD(FShaderParameter, SLInvDeviceZToWorldZTransform);
-	LAYOUT_FIELD(FShaderResourceParameter, SLSceneColorTexture);
-};
+void FMobileSceneRenderer::UpsampleTranslucency(FRHICommandList& RHICmdList, const FViewInfo& View, EMobileDownsampleTranslucencyResolution Resolution)
+{
+	SCOPED_DRAW_EVENTF(RHICmdList, EventUpsampleCopy, TEXT("Upsample translucency"));
 
-IMPLEMENT_SHADER_TYPE(, FMobileDownsampleSceneDepthPS, TEXT("/Engine/Private/MobileDownSampleDepthPixelShader.usf"), TEXT("Main"), SF_Pixel);
+	const FDownsampledTranslucencyTier& Tier = DownsampledTranslucencyTiers[(int32)Resolution];
+	FDownsampledTranslucencyInputs LowRes = GetDownsampledTranslucencyInputs(View, Resolution, Tier.Color->GetRenderTargetItem().ShaderResourceTexture, Tier.Depth->GetRenderTargetItem().ShaderResourceTexture);
+	bool bTileList = false;
+	if (Resolution == EMobileDownsampleTranslucencyResolution::Auto)
+	{
+		LowRes.MinMaxDepth = DownsampledTranslucencyMinMaxDepthRT ? DownsampledTranslucencyMinMaxDepthRT->GetRenderTargetItem().ShaderResourceTexture.GetReference() : nullptr;
+		bTileList = bDownsampledTranslucencyTileList;
+	}
+	DrawUpsampleTranslucencyTier(RHICmdList, View, LowRes, bTileList);
+}
+
+void FMobileSceneRenderer::RenderTranslucency_DownSampleSeparateFullRes(FRHICommandListImmediate& RHICmdList, const TArrayView<const FViewInfo*> PassViews)
+{
+	check(RHICmdList.IsInsideRenderPass());
+	SCOPED_DRAW_EVENT(RHICmdList, TranslucencyDownSampleSeparateFullRes);
 
+	for (const FViewInfo* View : PassViews)
+	{
+		// The right eye of mobile multi-view is drawn by the instanced view of the left one
+		if (!View->ShouldRenderView() || View->Family->UseDebugViewPS())
+		{
+			continue;
+		}
 
-void FMobileSceneRenderer::MobileDownSampleDepth(FRHICommandListImmediate& RHICmdList, const FViewInfo& View, float DownsamplingScale) {
+		if (Scene->UniformBuffers.UpdateViewUniformBuffer(*View))
+		{
+			UpdateTranslucentBasePassUniformBuffer(RHICmdList, *View);
+			UpdateDirectionalLightUniformBuffers(RHICmdList, *View);
+		}
 
-	FSceneRenderTargets& SceneContext = FSceneRenderTargets::Get(RHICmdList);
+		for (int32 ResolutionIndex = (int32)EMobileDownsampleTranslucencyResolution::Full; ResolutionIndex <= (int32)EMobileDownsampleTranslucencyResolution::Auto; ResolutionIndex++)
+		{
+			const EMobileDownsampleTranslucencyResolution Resolution = (EMobileDownsampleTranslucencyResolution)ResolutionIndex;
+			if (!HasDownsampledTranslucencyDraws(*View, Resolution, Resolution))
+			{
+				continue;
+			}
 
-	FIntPoint MobileSeparateTranslucencyBufferSize = FIntPoint(SceneContext.GetBufferSizeXY().X * DownsamplingScale, SceneContext.GetBufferSizeXY().Y * DownsamplingScale);
-	FRHITexture* DownSampleDepth = SceneContext.GetDownsampledTranslucencyDepth(RHICmdList, MobileSeparateTranslucencyBufferSize)->GetRenderTargetItem().TargetableTexture;
+			// The cached draws bind the tier's uniform buffers, which then hold the full res view and a depth read factor of 1
+			const FIntPoint BufferSize(View->CachedViewUniformShaderParameters->BufferSizeAndInvSize.X, View->CachedViewUniformShaderParameters->BufferSizeAndInvSize.Y);
+			GMobileDownsampledViewUniformBuffers.Update(RHICmdList, *View, Resolution, BufferSize, View->ViewRect);
+			View->ParallelMeshDrawCommandPasses[TranslucencyPassToMeshPass(GetMobileDownsampleTranslucencyPass(Resolution))].DispatchDraw(nullptr, RHICmdList);
+		}
+	}
+}
 
-	FRHIRenderPassInfo RPInfo(
-		SceneContext.GetSeparateTranslucency(RHICmdList, MobileSeparateTranslucencyBufferSize)->GetRenderTargetItem().TargetableTexture,
-		ERenderTargetActions::Clear_Store,
-		nullptr, //暂时不管MSAA
-		DownSampleDepth,
-		EDepthStencilTargetActions::LoadDepthStencil_StoreDepthStencil,  //直接Load应该更省
-		nullptr,
-		FExclusiveDepthStencil::DepthWrite_StencilWrite //
-	);
+void FMobileSceneRenderer::RenderTranslucency_DownSampleSeparateMultiView(FRHICommandListImmediate& RHICmdList)
+{
+	check(RHICmdList.IsOutsideRenderPass());
 
+	SCOPED_DRAW_EVENT(RHICmdList, TranslucencyDownSampleSeparateMultiView);
 
-	//Because Metal and Vulkan can't use the texture as MemoryLess as SRV, we use SceneColor
-	RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, SceneContext.GetSceneColorSurface());
+	// The left eye view draws both eyes, the right eye one is its instanced view
+	const FViewInfo& View = Views[0];
+	FSceneRenderTargets& SceneContext = FSceneRenderTargets::Get(RHICmdList);
+	FRHITexture* MultiViewSceneDepth = SceneContext.MobileMultiViewSceneDepthZ->GetRenderTargetItem().ShaderResourceTexture;
+	RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, MultiViewSceneDepth);
 
-	RHICmdList.BeginRenderPass(RPInfo, TEXT("DownsampleDepthAndSeparatePass"));
+	if (!View.Family->UseDebugViewPS() && Scene->UniformBuffers.UpdateViewUniformBuffer(View))
 	{
-		SCOPED_DRAW_EVENT(RHICmdList, DownsampleDepth);
+		UpdateTranslucentBasePassUniformBuffer(RHICmdList, View);
+		UpdateDirectionalLightUniformBuffers(RHICmdList, View);
+	}
 
-		// Set shaders and texture
-		TShaderMapRef<FScreenVS> ScreenVertexShader(View.ShaderMap);
-		TShaderMapRef<FMobileDownsampleSceneDepthPS> PixelShader(View.ShaderMap);
+	for (int32 ResolutionIndex = (int32)EMobileDownsampleTranslucencyResolution::Full; ResolutionIndex <= (int32)EMobileDownsampleTranslucencyResolution::Auto; ResolutionIndex++)
+	{
+		const EMobileDownsampleTranslucencyResolution Resolution = (EMobileDownsampleTranslucencyResolution)ResolutionIndex;
+		if (!HasDownsampledTranslucencyDraws(View, Resolution, Resolution))
+		{
+			continue;
+		}
 
-		extern TGlobalResource<FFilterVertexDeclaration> GFilterVertexDeclaration;
+		const bool bAutoResolution = Resolution == EMobileDownsampleTranslucencyResolution::Auto;
+		const FIntPoint DownsampledViewSize = GetDownsampledTranslucencySize(View.ViewRect.Size(), GetDownsampledTranslucencyViewScale(View, Resolution));
 
-		FGraphicsPipelineStateInitializer GraphicsPSOInit;
-		RHICmdList.ApplyCachedRenderTargets(GraphicsPSOInit);
+		// One slice per eye. Depth without stencil, as the multi-view scene depth: packed depth stencil doesn't work in array frame buffers.
+		FDownsampledTranslucencyTier& Tier = DownsampledTranslucencyTiers[ResolutionIndex];
+		Tier.AllocateColor(RHICmdList, DownsampledViewSize, true, TEXT("SeparateTranslucencyMultiView"));
+		FPooledRenderTargetDesc DepthDesc(FPooledRenderTargetDesc::Create2DDesc(DownsampledViewSize, PF_D24, FClearValueBinding::DepthFar, TexCreate_None, TexCreate_DepthStencilTargetable | TexCreate_ShaderResource, false));
+		DepthDesc.ArraySize = 2;
+		DepthDesc.bIsArray = true;
+		GMobileDownsampleTranslucencyTargetLifetime.FindFreeElement(RHICmdList, DepthDesc, Tier.Depth, TEXT("SeparateTranslucencyMultiViewDepth"));
 
-		GraphicsPSOInit.BlendState = TStaticBlendState<CW_NONE>::GetRHI();
-		GraphicsPSOInit.RasterizerState = TStaticRasterizerState<FM_Solid, CM_None>::GetRHI();
-		GraphicsPSOInit.DepthStencilState = TStaticDepthStencilState<true, CF_Always>::GetRHI(); //直接强制写深度了
+		GMobileDownsampledViewUniformBuffers.Update(RHICmdList, View, Resolution, DownsampledViewSize, FIntRect(FIntPoint::ZeroValue, DownsampledViewSize));
 
-		GraphicsPSOInit.BoundShaderState.VertexDeclarationRHI = GFilterVertexDeclaration.VertexDeclarationRHI;
-		GraphicsPSOInit.BoundShaderState.VertexShaderRHI = ScreenVertexShader.GetVertexShader();
-		GraphicsPSOInit.BoundShaderState.PixelShaderRHI = PixelShader.GetPixelShader();
-		GraphicsPSOInit.PrimitiveType = PT_TriangleList;
+		FMobileDownsampleTranslucencyTimers::FViewTimer* ViewTimer = bAutoResolution && CVarMobileSeparateTranslucencyAutoDownsample.GetValueOnRenderThread() != 0 ? GMobileDownsampleTranslucencyTimers.Find(View) : nullptr;
+		if (ViewTimer)
+		{
+			ViewTimer->Timer.Begin(RHICmdList);
+		}
 
-		SetGraphicsPipelineState(RHICmdList, GraphicsPSOInit);
+		FRHIRenderPassInfo RPInfo(
+			Tier.Color->GetRenderTargetItem().TargetableTexture,
+			ERenderTargetActions::Clear_Store,
+			nullptr,
+			Tier.Depth->GetRenderTargetItem().TargetableTexture,
+			EDepthStencilTargetActions::DontLoad_StoreDepthStencil,
+			nullptr,
+			FExclusiveDepthStencil::DepthWrite_StencilWrite
+		);
+		RPInfo.bMultiviewPass = true;
 
-		PixelShader->SetParameters(RHICmdList, View);
+		RHICmdList.TransitionResource(EResourceTransitionAccess::EWritable, RPInfo.ColorRenderTargets[0].RenderTarget);
+		AccountRenderPassBandwidth(RPInfo);
+		RHICmdList.BeginRenderPass(RPInfo, TEXT("DownsampleDepthAndSeparateMultiViewPass"));
 
-		const uint32 DownsampledViewSizeX = FMath::TruncToInt(View.ViewRect.Width() * DownsamplingScale);
-		const uint32 DownsampledViewSizeY = FMath::TruncToInt(View.ViewRect.Height() * DownsamplingScale);
+		// Neither scissored nor classified, the scissor rect of a view only covers its own eye
+		const FIntRect ViewScissorRect(FIntPoint::ZeroValue, DownsampledViewSize);
+		DrawDownsampleSceneDepth<FMobileDownsampleSceneDepthMultiViewPS, FMobileMultiViewScreenVS>(RHICmdList, View, ViewScissorRect, ViewScissorRect, TStaticBlendState<CW_NONE>::GetRHI(), TStaticDepthStencilState<true, CF_Always>::GetRHI(), MultiViewSceneDepth);
+		DrawDownsampledTranslucencyPass(RHICmdList, View, Resolution, RPInfo.ColorRenderTargets[0].RenderTarget, RPInfo.DepthStencilRenderTarget.DepthStencilTarget, ViewScissorRect, ViewScissorRect, true);
 
-		RHICmdList.SetViewport(0, 0, 0.0f, DownsampledViewSizeX, DownsampledViewSizeY, 1.0f);
+		RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, Tier.Depth->GetRenderTargetItem().TargetableTexture);
+		RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, Tier.Color->GetRenderTargetItem().TargetableTexture);
 
-		DrawRectangle(
-			RHICmdList,
-			0, 0,
-			DownsampledViewSizeX, DownsampledViewSizeY,
-			0, 0,
-			View.ViewRect.Width(), View.ViewRect.Height(),
-			FIntPoint(DownsampledViewSizeX, DownsampledViewSizeY),
-			View.ViewRect.Size(),
-			ScreenVertexShader,
-			EDRF_UseTriangleOptimization);
+		if (ViewTimer)
+		{
+			ViewTimer->Timer.End(RHICmdList);
+		}
 	}
+}
+
+void FMobileSceneRenderer::CompositeTranslucency_DownSampleSeparateMultiView(FRHICommandListImmediate& RHICmdList)
+{
+	check(RHICmdList.IsOutsideRenderPass());
+
+	SCOPED_DRAW_EVENT(RHICmdList, TranslucencyDownSampleSeparateMultiViewComposite);
 
-	RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, SceneContext.GetDownsampledTranslucencyDepthSurface());
+	const FViewInfo& View = Views[0];
+	FSceneRenderTargets& SceneContext = FSceneRenderTargets::Get(RHICmdList);
+
+	// Left open, the caller ends it together with the scene color pass
+	FRHIRenderPassInfo RPInfo(GetMultiViewSceneColor(SceneContext), ERenderTargetActions::Load_Store);
+	RPInfo.bMultiviewPass = true;
+	RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, SceneContext.MobileMultiViewSceneDepthZ->GetRenderTargetItem().ShaderResourceTexture);
 	RHICmdList.TransitionResource(EResourceTransitionAccess::EWritable, RPInfo.ColorRenderTargets[0].RenderTarget);
-}
+	AccountRenderPassBandwidth(RPInfo);
+	RHICmdList.BeginRenderPass(RPInfo, TEXT("UpsampleTranslucencyMultiView"));
 
+	const FDownsampledTranslucencyCompositeOrder SortedResolutions = GetDownsampledTranslucencyCompositeOrder(Scene, View, [this](EMobileDownsampleTranslucencyResolution Resolution)
+	{
+		return DownsampledTranslucencyTiers[(int32)Resolution].Color.IsValid();
+	});
 
+	for (EMobileDownsampleTranslucencyResolution Resolution : SortedResolutions)
+	{
+		SCOPED_DRAW_EVENTF(RHICmdList, EventUpsampleCopy, TEXT("Upsample translucency"));
+
+		const bool bAutoResolution = Resolution == EMobileDownsampleTranslucencyResolution::Auto;
+		const FDownsampledTranslucencyTier& Tier = DownsampledTranslucencyTiers[(int32)Resolution];
+		FDownsampledTranslucencyInputs LowRes;
+		LowRes.Color = Tier.Color->GetRenderTargetItem().ShaderResourceTexture;
+		LowRes.Depth = Tier.Depth->GetRenderTargetItem().ShaderResourceTexture;
+		LowRes.Rect = FIntRect(FIntPoint::ZeroValue, View.ViewRect.Size());
+		LowRes.DownsamplingScale = GetDownsampledTranslucencyViewScale(View, Resolution);
+		AccountDownsampledTranslucencyColorTraffic(LowRes, 2);
+
+		FMobileDownsampleTranslucencyTimers::FViewTimer* ViewTimer = bAutoResolution && CVarMobileSeparateTranslucencyAutoDownsample.GetValueOnRenderThread() != 0 ? GMobileDownsampleTranslucencyTimers.Find(View) : nullptr;
+		if (ViewTimer)
+		{
+			ViewTimer->CompositeTimer.Begin(RHICmdList);
+		}
 
-class FMobileTranslucencyUpsamplingPS : public FGlobalShader
-{
-	//DECLARE_INLINE_TYPE_LAYOUT(FMobileTranslucencyUpsamplingPS, NonVirtual);
-	DECLARE_SHADER_TYPE(FMobileTranslucencyUpsamplingPS, Global);
-public:
+		TShaderMapRef<FMobileTranslucencyUpsamplingMultiViewPS> PixelShader(View.ShaderMap);
+		DrawUpsampleTranslucency<FMobileTranslucencyUpsamplingMultiViewPS, FMobileMultiViewScreenVS>(RHICmdList, View, LowRes, PixelShader,
+			TStaticBlendState<CW_RGB, BO_Add, BF_One, BF_SourceAlpha>::GetRHI(), TStaticDepthStencilState<false, CF_Always>::GetRHI(), 0, false);
 
-	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+		if (ViewTimer)
+		{
+			ViewTimer->CompositeTimer.End(RHICmdList);
+		}
+	}
+
+	ReleaseDownsampledTranslucencyTargets();
+}
+
+BEGIN_SHADER_PARAMETER_STRUCT(FMobileDownsampledTranslucencyTierPassParameters, )
+	SHADER_PARAMETER_RDG_TEXTURE(Texture2D, SceneColor)
+	RENDER_TARGET_BINDING_SLOTS()
+END_SHADER_PARAMETER_STRUCT()
+
+BEGIN_SHADER_PARAMETER_STRUCT(FMobileDownsampledTranslucencyTierTextures, )
+	SHADER_PARAMETER_RDG_TEXTURE(Texture2D, Color)
+	SHADER_PARAMETER_RDG_TEXTURE(Texture2D, Depth)
+END_SHADER_PARAMETER_STRUCT()
+
+BEGIN_SHADER_PARAMETER_STRUCT(FMobileUpsampleTranslucencyPassParameters, )
+	SHADER_PARAMETER_RDG_TEXTURE(Texture2D, SceneDepth)
+	SHADER_PARAMETER_STRUCT(FMobileDownsampledTranslucencyTierTextures, FullTier)
+	SHADER_PARAMETER_STRUCT(FMobileDownsampledTranslucencyTierTextures, HalfTier)
+	SHADER_PARAMETER_STRUCT(FMobileDownsampledTranslucencyTierTextures, QuarterTier)
+	SHADER_PARAMETER_STRUCT(FMobileDownsampledTranslucencyTierTextures, AutoTier)
+	RENDER_TARGET_BINDING_SLOTS()
+END_SHADER_PARAMETER_STRUCT()
+
+static FMobileDownsampledTranslucencyTierTextures& GetUpsampleTierTextures(FMobileUpsampleTranslucencyPassParameters& PassParameters, EMobileDownsampleTranslucencyResolution Resolution)
+{
+	switch (Resolution)
 	{
-		return true;
+	case EMobileDownsampleTranslucencyResolution::Full:
+		return PassParameters.FullTier;
+	case EMobileDownsampleTranslucencyResolution::Half:
+		return PassParameters.HalfTier;
+	case EMobileDownsampleTranslucencyResolution::Quarter:
+		return PassParameters.QuarterTier;
+	default:
+		check(Resolution == EMobileDownsampleTranslucencyResolution::Auto);
+		return PassParameters.AutoTier;
 	}
+}
 
-	/** Default constructor. */
-	FMobileTranslucencyUpsamplingPS()
+/** Creates the textures a DownsampleAndParticles pass of Plan writes, indexed like Plan.Textures, and binds them as the render targets of the pass. */
+static void CreateDownsampledTranslucencyGraphTargets(
+	FRDGBuilder& GraphBuilder,
+	const MobileDownsampleTranslucencyGraph::FPlan& Plan,
+	const MobileDownsampleTranslucencyGraph::FPass& Pass,
+	FIntPoint BufferSize,
+	EPixelFormat ColorFormat,
+	TArrayView<FRDGTextureRef> Textures,
+	FMobileDownsampledTranslucencyTierPassParameters& PassParameters)
+{
+	// Cleared to no contribution, as the pooled targets
+	for (int32 TextureIndex : Pass.Writes)
 	{
+		if (Plan.Textures[TextureIndex].Type == MobileDownsampleTranslucencyGraph::ETextureType::Depth)
+		{
+			FRDGTextureDesc Desc = FRDGTextureDesc::Create2DDesc(BufferSize, PF_DepthStencil, FClearValueBinding::DepthFar, TexCreate_None, TexCreate_DepthStencilTargetable | TexCreate_ShaderResource, false);
+			Desc.Flags |= GFastVRamConfig.SeparateTranslucency;
+			Textures[TextureIndex] = GraphBuilder.CreateTexture(Desc, TEXT("SeparateTranslucencyDepth"));
+			PassParameters.RenderTargets.DepthStencil = FDepthStencilBinding(Textures[TextureIndex], ERenderTargetLoadAction::EClear, ERenderTargetLoadAction::EClear, FExclusiveDepthStencil::DepthWrite_StencilWrite);
+		}
+		else
+		{
+			FRDGTextureDesc Desc = FRDGTextureDesc::Create2DDesc(BufferSize, ColorFormat, FClearValueBinding::Black, TexCreate_None, TexCreate_RenderTargetable | TexCreate_ShaderResource, false);
+			Desc.Flags |= GFastVRamConfig.SeparateTranslucency;
+			Textures[TextureIndex] = GraphBuilder.CreateTexture(Desc, TEXT("SeparateTranslucency"));
+			PassParameters.RenderTargets[0] = FRenderTargetBinding(Textures[TextureIndex], ERenderTargetLoadAction::EClear);
+		}
+	}
+}
 
+/** Binds the textures an Upsample pass of Plan reads to their tiers. */
+static void BindDownsampledTranslucencyGraphInputs(
+	const MobileDownsampleTranslucencyGraph::FPlan& Plan,
+	const MobileDownsampleTranslucencyGraph::FPass& Pass,
+	TArrayView<const FRDGTextureRef> Textures,
+	FMobileUpsampleTranslucencyPassParameters& PassParameters)
+{
+	for (int32 TextureIndex : Pass.Reads)
+	{
+		const MobileDownsampleTranslucencyGraph::FTexture& Texture = Plan.Textures[TextureIndex];
+		FMobileDownsampledTranslucencyTierTextures& TierTextures = GetUpsampleTierTextures(PassParameters, Texture.Resolution);
+		if (Texture.Type == MobileDownsampleTranslucencyGraph::ETextureType::Depth)
+		{
+			TierTextures.Depth = Textures[TextureIndex];
+		}
+		else
+		{
+			TierTextures.Color = Textures[TextureIndex];
+		}
 	}
-	LAYOUT_FIELD(FShaderParameter, SLInvDeviceZToWorldZTransform);
+}
 
-	LAYOUT_FIELD(FShaderResourceParameter, LowResColorTexture_0);
-	LAYOUT_FIELD(FShaderResourceParameter, LowResColorTexture_1);
-	LAYOUT_FIELD(FShaderResourceParameter, LowResDepthTexture);
-	LAYOUT_FIELD(FShaderResourceParameter, FullResDepthTexture);
+void FMobileSceneRenderer::RenderTranslucency_DownSampleSeparateGraph(FRHICommandListImmediate& RHICmdList, const TArrayView<const FViewInfo*>& PassViews)
+{
+	using namespace MobileDownsampleTranslucencyGraph;
 
-	LAYOUT_FIELD(FShaderResourceParameter, BilinearClampedSampler);
-	LAYOUT_FIELD(FShaderResourceParameter, PointClampedSampler);
-	LAYOUT_FIELD(FShaderResourceParameter, BilinearLowDepthClampedSampler);
+	check(RHICmdList.IsOutsideRenderPass());
 
-public:
+	SCOPED_DRAW_EVENT(RHICmdList, TranslucencyDownSampleSeparateGraph);
 
-	/** Initialization constructor. */
-	FMobileTranslucencyUpsamplingPS(const ShaderMetaType::CompiledShaderInitializerType& Initializer)
-		: FGlobalShader(Initializer)
-	{
-		SLInvDeviceZToWorldZTransform.Bind(Initializer.ParameterMap, TEXT("SLInvDeviceZToWorldZTransform"));
-		LowResColorTexture_0.Bind(Initializer.ParameterMap, TEXT("LowResColorTexture_0"));
-		LowResColorTexture_1.Bind(Initializer.ParameterMap, TEXT("LowResColorTexture_1"));
-		LowResDepthTexture.Bind(Initializer.ParameterMap, TEXT("LowResDepthTexture"));
-		FullResDepthTexture.Bind(Initializer.ParameterMap, TEXT("FullResDepthTexture"));
+	FSceneRenderTargets& SceneContext = FSceneRenderTargets::Get(RHICmdList);
+	const EMobileDownsampleTranslucencyColorFormat ColorFormat = GetMobileDownsampleTranslucencyColorFormat();
+	const bool bTimed = CVarMobileSeparateTranslucencyAutoDownsample.GetValueOnRenderThread() != 0;
 
-		BilinearClampedSampler.Bind(Initializer.ParameterMap, TEXT("BilinearClampedSampler"));
-		PointClampedSampler.Bind(Initializer.ParameterMap, TEXT("PointClampedSampler"));
-		BilinearLowDepthClampedSampler.Bind(Initializer.ParameterMap, TEXT("BilinearLowDepthClampedSampler"));
-	}
+	// Same layout as the immediate passes, read by the pass lambdas during Execute
+	bDownsampledTranslucencyAtlas = ShouldShareDownsampledTranslucencyAtlas();
 
-	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	TArray<FViewDesc, TInlineAllocator<2>> ViewDescs;
+	for (const FViewInfo* View : PassViews)
 	{
-		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		FViewDesc& ViewDesc = ViewDescs.AddDefaulted_GetRef();
+		for (int32 ResolutionIndex = (int32)EMobileDownsampleTranslucencyResolution::Full; ResolutionIndex <= (int32)EMobileDownsampleTranslucencyResolution::Auto; ResolutionIndex++)
+		{
+			const EMobileDownsampleTranslucencyResolution Resolution = (EMobileDownsampleTranslucencyResolution)ResolutionIndex;
+			if (View->ShouldRenderView() && HasDownsampledTranslucencyDraws(*View, Resolution, Resolution))
+			{
+				ViewDesc.ResolutionMask |= 1u << ResolutionIndex;
+			}
+		}
 	}
+	const FPlan Plan = BuildPlan(ViewDescs, bDownsampledTranslucencyAtlas);
+
+	FRDGBuilder GraphBuilder(RHICmdList);
+	FRDGTextureRef SceneColor = GraphBuilder.RegisterExternalTexture(SceneContext.GetSceneColor(), TEXT("SceneColor"));
+	FRDGTextureRef SceneDepth = GraphBuilder.RegisterExternalTexture(SceneContext.SceneDepthZ, TEXT("SceneDepthZ"));
 
+	// Indexed like Plan.Textures, the graph allocates them when their producer runs and reuses their memory after their upsample
+	TArray<FRDGTextureRef, TInlineAllocator<8>> Textures;
+	Textures.SetNumZeroed(Plan.Textures.Num());
 
-	void SetParameters(FRHICommandList& RHICmdList, const FViewInfo& View)
+	for (const FPass& Pass : Plan.Passes)
 	{
-		FRHIPixelShader* ShaderRHI = RHICmdList.GetBoundPixelShader();
+		TArray<const FViewInfo*, TInlineAllocator<2>> GraphViews;
+		for (int32 ViewIndex : Pass.Views)
+		{
+			GraphViews.Add(PassViews[ViewIndex]);
+		}
 
-		//FGlobalShader::SetParameters<FViewUniformShaderParameters>(RHICmdList, ShaderRHI, View.ViewUniformBuffer);
+		if (Pass.Type == EPassType::DownsampleAndParticles)
+		{
+			const EMobileDownsampleTranslucencyResolution Resolution = Pass.Resolution;
+			const EMeshPass::Type MeshPass = TranslucencyPassToMeshPass(GetMobileDownsampleTranslucencyPass(Resolution));
+			const FIntPoint BufferSize = GetDownsampledTranslucencyTargetSize(*GraphViews[0], Resolution);
 
-		FSceneRenderTargets& SceneContext = FSceneRenderTargets::Get(RHICmdList);
+			FMobileDownsampledTranslucencyTierPassParameters* PassParameters = GraphBuilder.AllocParameters<FMobileDownsampledTranslucencyTierPassParameters>();
+			PassParameters->SceneColor = SceneColor;
 
-		SetShaderValue(RHICmdList, RHICmdList.GetBoundPixelShader(), SLInvDeviceZToWorldZTransform, View.InvDeviceZToWorldZTransform);
-		//Because OpenGL does not support the separation of Texture and Sampler, bind the same texture to two texture units
-		SetTextureParameter(RHICmdList, ShaderRHI, LowResColorTexture_0, SceneContext.SeparateTranslucencyRT->GetRenderTargetItem().ShaderResourceTexture);
-		SetTextureParameter(RHICmdList, ShaderRHI, LowResColorTexture_1, SceneContext.SeparateTranslucencyRT->GetRenderTargetItem().ShaderResourceTexture);
-		SetTextureParameter(RHICmdList, ShaderRHI, LowResDepthTexture, SceneContext.GetDownsampledTranslucencyDepthSurface());
+			CreateDownsampledTranslucencyGraphTargets(GraphBuilder, Plan, Pass, BufferSize, GetMobileDownsampleTranslucencyColorPixelFormat(ColorFormat), Textures, *PassParameters);
 
-#if !PLATFORM_IOS && !PLATFORM_ANDROID
-		SetTextureParameter(RHICmdList, ShaderRHI, FullResDepthTexture, SceneContext.GetSceneDepthSurface());
-#endif
+			GraphBuilder.AddPass(
+				RDG_EVENT_NAME("DownsampleDepthAndSeparateTierPass %s", GetMeshPassName(MeshPass)),
+				PassParameters,
+				ERDGPassFlags::Raster,
+				[this, GraphViews, Resolution, MeshPass, BufferSize, bTimed](FRHICommandListImmediate& RHICmdList)
+			{
+				// Only the Auto tier is scissored and timed, as in the immediate passes
+				const bool bAutoResolution = Resolution == EMobileDownsampleTranslucencyResolution::Auto;
+				auto GetScissorRect = [bAutoResolution](const FViewInfo& View, const FIntRect& DownsampledViewRect)
+				{
+					return bAutoResolution
+						? MobileDownsampleTranslucencyScissor::GetDownsampledRect(View.MobileDownsampleTranslucencyRect, View.ViewRect.Size(), DownsampledViewRect.Size()) + DownsampledViewRect.Min
+						: DownsampledViewRect;
+				};
 
-		SetSamplerParameter(RHICmdList, ShaderRHI, BilinearClampedSampler, TStaticSamplerState<SF_Bilinear, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI());
-		SetSamplerParameter(RHICmdList, ShaderRHI, PointClampedSampler, TStaticSamplerState<SF_Point, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI());
-		SetSamplerParameter(RHICmdList, ShaderRHI, BilinearLowDepthClampedSampler, TStaticSamplerState<SF_Bilinear, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI());
+				FMobileDownsampleTranslucencyTimers::FViewTimer* PassTimer = bTimed && bAutoResolution && !bDownsampledTranslucencyAtlas ? GMobileDownsampleTranslucencyTimers.Find(*GraphViews[0]) : nullptr;
+				if (PassTimer)
+				{
+					PassTimer->Timer.Begin(RHICmdList);
+				}
+
+				for (const FViewInfo* View : GraphViews)
+				{
+					const FIntRect DownsampledViewRect = GetDownsampledTranslucencyViewRect(*View, Resolution);
+					DrawDownsampleSceneDepth<FMobileDownsampleSceneDepthPS>(RHICmdList, *View, DownsampledViewRect, GetScissorRect(*View, DownsampledViewRect), TStaticBlendState<CW_NONE>::GetRHI(), TStaticDepthStencilState<true, CF_Always>::GetRHI(), nullptr);
+				}
+
+				for (const FViewInfo* View : GraphViews)
+				{
+					FMobileDownsampleTranslucencyTimers::FViewTimer* ViewTimer = bTimed && bAutoResolution && bDownsampledTranslucencyAtlas ? GMobileDownsampleTranslucencyTimers.Find(*View) : nullptr;
+					if (ViewTimer)
+					{
+						ViewTimer->Timer.Begin(RHICmdList);
+					}
+
+					if (!View->Family->UseDebugViewPS() && Scene->UniformBuffers.UpdateViewUniformBuffer(*View))
+					{
+						UpdateTranslucentBasePassUniformBuffer(RHICmdList, *View);
+						UpdateDirectionalLightUniformBuffers(RHICmdList, *View);
+					}
+
+					const FIntRect DownsampledViewRect = GetDownsampledTranslucencyViewRect(*View, Resolution);
+					const FIntRect ScissorRect = GetScissorRect(*View, DownsampledViewRect);
+					GMobileDownsampledViewUniformBuffers.Update(RHICmdList, *View, Resolution, BufferSize, DownsampledViewRect);
+
+					// Recorded serially, parallel command lists can't resume a graph pass
+					RHICmdList.SetViewport(DownsampledViewRect.Min.X, DownsampledViewRect.Min.Y, 0.0f, DownsampledViewRect.Max.X, DownsampledViewRect.Max.Y, 1.0f);
+					RHICmdList.SetScissorRect(true, ScissorRect.Min.X, ScissorRect.Min.Y, ScissorRect.Max.X, ScissorRect.Max.Y);
+					if (!View->Family->UseDebugViewPS())
+					{
+						SCOPE_CYCLE_COUNTER(STAT_MobileDownsampleTranslucencyDispatch);
+						View->ParallelMeshDrawCommandPasses[MeshPass].DispatchDraw(nullptr, RHICmdList);
+					}
+
+					if (ViewTimer)
+					{
+						ViewTimer->Timer.End(RHICmdList);
+					}
+				}
+				RHICmdList.SetScissorRect(false, 0, 0, 0, 0);
+
+				if (PassTimer)
+				{
+					PassTimer->Timer.End(RHICmdList);
+				}
+			});
+		}
+		else
+		{
+			FMobileUpsampleTranslucencyPassParameters* PassParameters = GraphBuilder.AllocParameters<FMobileUpsampleTranslucencyPassParameters>();
+			PassParameters->SceneDepth = SceneDepth;
+			BindDownsampledTranslucencyGraphInputs(Plan, Pass, Textures, *PassParameters);
+			PassParameters->RenderTargets[0] = FRenderTargetBinding(SceneColor, ERenderTargetLoadAction::ELoad);
+
+			GraphBuilder.AddPass(
+				RDG_EVENT_NAME("UpsampleTranslucency"),
+				PassParameters,
+				ERDGPassFlags::Raster,
+				[this, PassParameters, GraphViews, bTimed](FRHICommandListImmediate& RHICmdList)
+			{
+				for (const FViewInfo* View : GraphViews)
+				{
+					const FDownsampledTranslucencyCompositeOrder SortedResolutions = GetDownsampledTranslucencyCompositeOrder(Scene, *View, [View](EMobileDownsampleTranslucencyResolution Resolution)
+					{
+						return HasDownsampledTranslucencyDraws(*View, Resolution, Resolution);
+					});
+
+					for (EMobileDownsampleTranslucencyResolution Resolution : SortedResolutions)
+					{
+						SCOPED_DRAW_EVENTF(RHICmdList, EventUpsampleCopy, TEXT("Upsample translucency"));
+
+						const FMobileDownsampledTranslucencyTierTextures& TierTextures = GetUpsampleTierTextures(*PassParameters, Resolution);
+						const bool bAutoResolution = Resolution == EMobileDownsampleTranslucencyResolution::Auto;
+
+						const FDownsampledTranslucencyInputs LowRes = GetDownsampledTranslucencyInputs(*View, Resolution, TierTextures.Color->GetRHI(), TierTextures.Depth->GetRHI());
+
+						FMobileDownsampleTranslucencyTimers::FViewTimer* ViewTimer = bTimed && bAutoResolution ? GMobileDownsampleTranslucencyTimers.Find(*View) : nullptr;
+						if (ViewTimer)
+						{
+							ViewTimer->CompositeTimer.Begin(RHICmdList);
+						}
+
+						DrawUpsampleTranslucencyTier(RHICmdList, *View, LowRes, false);
+
+						if (ViewTimer)
+						{
+							ViewTimer->CompositeTimer.End(RHICmdList);
+						}
+					}
+				}
+			});
+		}
 	}
-};
 
+	GraphBuilder.Execute();
 
-IMPLEMENT_SHADER_TYPE(, FMobileTranslucencyUpsamplingPS, TEXT("/Engine/Private/MobileTranslucencyUpsampling.usf"), TEXT("MobileNearestDepthNeighborUpsamplingPS"), SF_Pixel);
+	bDownsampledTranslucencyAtlas = false;
+}
 
-void FMobileSceneRenderer::UpsampleTranslucency(FRHICommandList& RHICmdList, const FViewInfo& View, float DownsamplingScale)
+#if !UE_BUILD_SHIPPING
+
+bool MobileDownsampleTranslucencyGraph::ValidateGraph(FRHICommandListImmediate& RHICmdList, const FPlan& Plan, TArrayView<const FViewDesc> Views, bool bAtlas, FString& OutError)
 {
-	SCOPED_DRAW_EVENTF(RHICmdList, EventUpsampleCopy, TEXT("Upsample translucency"));
+	check(IsInRenderingThread() && RHICmdList.IsOutsideRenderPass());
 
-	FSceneRenderTargets& SceneContext = FSceneRenderTargets::Get(RHICmdList);
+	// Expected from the views alone: the atlas draws each tier of any view once and composites all views in one pass,
+	// otherwise every view with draws gets a pass per tier and its own upsample
+	uint32 AtlasMask = 0;
+	int32 NumPasses = 0;
+	for (const FViewDesc& View : Views)
+	{
+		AtlasMask |= View.ResolutionMask;
+		NumPasses += View.ResolutionMask != 0 ? FMath::CountBits(View.ResolutionMask) + 1 : 0;
+	}
+	if (bAtlas)
+	{
+		NumPasses = AtlasMask != 0 ? FMath::CountBits(AtlasMask) + 1 : 0;
+	}
 
-	//Depth and Stencil don't need
-	FRHIRenderPassInfo RPInfo(SceneContext.GetSceneColorSurface(), ERenderTargetActions::Load_Store);
+	// Every tier has its own size below, a texture can only take the memory of one of the same tier and type. The upsample of a view releases
+	// its textures and the next view's ones reuse them, so the graph allocates a color and a depth texture per tier whatever the number of views.
+	const int32 NumAllocations = FMath::CountBits(AtlasMask) * 2;
 
-	RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, SceneContext.GetDownsampledTranslucencyDepthSurface());
-	RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, SceneContext.SeparateTranslucencyRT->GetRenderTargetItem().TargetableTexture);
-	RHICmdList.TransitionResource(EResourceTransitionAccess::EReadable, SceneContext.GetSceneDepthSurface());
-	RHICmdList.TransitionResource(EResourceTransitionAccess::EWritable, RPInfo.ColorRenderTargets[0].RenderTarget);
+	// Free targets left by earlier frames would be picked instead of the ones the graph releases
+	GRenderTargetPool.FreeUnusedResources();
 
-	RHICmdList.BeginRenderPass(RPInfo, TEXT("UpsampleTranslucency"));
-	FGraphicsPipelineStateInitializer GraphicsPSOInit;
-	RHICmdList.ApplyCachedRenderTargets(GraphicsPSOInit);
-	GraphicsPSOInit.RasterizerState = TStaticRasterizerState<FM_Solid, CM_None>::GetRHI();
-	GraphicsPSOInit.DepthStencilState = TStaticDepthStencilState<false, CF_Always>::GetRHI();
-	GraphicsPSOInit.BlendState = TStaticBlendState<CW_RGB, BO_Add, BF_One, BF_SourceAlpha>::GetRHI();
+	const FIntPoint ViewSize(1280, 720);
+	TRefCountPtr<IPooledRenderTarget> SceneColorTarget;
+	FPooledRenderTargetDesc SceneColorDesc(FPooledRenderTargetDesc::Create2DDesc(ViewSize, PF_FloatRGBA, FClearValueBinding::Black, TexCreate_None, TexCreate_RenderTargetable | TexCreate_ShaderResource, false));
+	GRenderTargetPool.FindFreeElement(RHICmdList, SceneColorDesc, SceneColorTarget, TEXT("SceneColor"));
 
-	TShaderMapRef<FScreenVS> ScreenVertexShader(View.ShaderMap);
-	TShaderMapRef<FMobileTranslucencyUpsamplingPS> PixelShader(View.ShaderMap);
+	// What each pass lambda sees, indexed like Plan.Passes and Plan.Textures
+	TArray<int32> ExecutedPasses;
+	TArray<FRHITexture*> ProducerAllocations;
+	TArray<FRHITexture*> ConsumerAllocations;
+	ProducerAllocations.SetNumZeroed(Plan.Textures.Num());
+	ConsumerAllocations.SetNumZeroed(Plan.Textures.Num());
 
-	GraphicsPSOInit.BoundShaderState.VertexDeclarationRHI = GFilterVertexDeclaration.VertexDeclarationRHI;
-	GraphicsPSOInit.BoundShaderState.VertexShaderRHI = ScreenVertexShader.GetVertexShader();
-	GraphicsPSOInit.BoundShaderState.PixelShaderRHI = PixelShader.GetPixelShader();
-	GraphicsPSOInit.PrimitiveType = PT_TriangleList;
+	{
+		FRDGBuilder GraphBuilder(RHICmdList);
+		FRDGTextureRef SceneColor = GraphBuilder.RegisterExternalTexture(SceneColorTarget, TEXT("SceneColor"));
 
-	SetGraphicsPipelineState(RHICmdList, GraphicsPSOInit);
+		TArray<FRDGTextureRef, TInlineAllocator<8>> Textures;
+		Textures.SetNumZeroed(Plan.Textures.Num());
 
-	PixelShader->SetParameters(RHICmdList, View);
+		for (int32 PassIndex = 0; PassIndex < Plan.Passes.Num(); PassIndex++)
+		{
+			const FPass& Pass = Plan.Passes[PassIndex];
+			const bool bUpsample = Pass.Type == EPassType::Upsample;
 
-	TRefCountPtr<IPooledRenderTarget>& DownsampledTranslucency = SceneContext.SeparateTranslucencyRT;
-	int32 TextureWidth = DownsampledTranslucency->GetDesc().Extent.X;
-	int32 TextureHeight = DownsampledTranslucency->GetDesc().Extent.Y;
+			// Draws nothing, records the allocations of the textures the pass uses while the graph has them
+			auto RecordPass = [&ExecutedPasses, &ProducerAllocations, &ConsumerAllocations, &Textures, &Pass, PassIndex](FRHICommandListImmediate&)
+			{
+				ExecutedPasses.Add(PassIndex);
+				for (int32 TextureIndex : Pass.Writes)
+				{
+					ProducerAllocations[TextureIndex] = Textures[TextureIndex]->GetRHI();
+				}
+				for (int32 TextureIndex : Pass.Reads)
+				{
+					ConsumerAllocations[TextureIndex] = Textures[TextureIndex]->GetRHI();
+				}
+			};
 
-	RHICmdList.SetViewport(View.ViewRect.Min.X, View.ViewRect.Min.Y, 0.0f, View.ViewRect.Max.X, View.ViewRect.Max.Y, 1.0f);
+			if (bUpsample)
+			{
+				FMobileUpsampleTranslucencyPassParameters* PassParameters = GraphBuilder.AllocParameters<FMobileUpsampleTranslucencyPassParameters>();
+				BindDownsampledTranslucencyGraphInputs(Plan, Pass, Textures, *PassParameters);
+				PassParameters->RenderTargets[0] = FRenderTargetBinding(SceneColor, ERenderTargetLoadAction::ELoad);
+				GraphBuilder.AddPass(RDG_EVENT_NAME("UpsampleTranslucency"), PassParameters, ERDGPassFlags::Raster, MoveTemp(RecordPass));
+			}
+			else
+			{
+				// A synthetic scale for Auto, apart from the fixed tiers
+				const float DownsamplingScale = Pass.Resolution == EMobileDownsampleTranslucencyResolution::Auto ? 0.375f : GetDownsampledTranslucencyTierScale(Pass.Resolution);
+				const FIntPoint BufferSize = GetDownsampledTranslucencySize(FIntPoint(ViewSize.X * (bAtlas ? Views.Num() : 1), ViewSize.Y), DownsamplingScale);
+
+				FMobileDownsampledTranslucencyTierPassParameters* PassParameters = GraphBuilder.AllocParameters<FMobileDownsampledTranslucencyTierPassParameters>();
+				PassParameters->SceneColor = SceneColor;
+				CreateDownsampledTranslucencyGraphTargets(GraphBuilder, Plan, Pass, BufferSize, GetMobileDownsampleTranslucencyColorPixelFormat(GetMobileDownsampleTranslucencyColorFormat()), Textures, *PassParameters);
+				GraphBuilder.AddPass(RDG_EVENT_NAME("DownsampleDepthAndSeparateTierPass"), PassParameters, ERDGPassFlags::Raster, MoveTemp(RecordPass));
+			}
+		}
 
-	DrawRectangle(
-		RHICmdList,
-		0, 0,
-		View.ViewRect.Width(), View.ViewRect.Height(),
-		0, 0,
-		View.ViewRect.Width() * DownsamplingScale, View.ViewRect.Height() * DownsamplingScale,
-		View.ViewRect.Size(),
-		FIntPoint(TextureWidth, TextureHeight),
-		ScreenVertexShader,
-		EDRF_UseTriangleOptimization);
+		GraphBuilder.Execute();
+	}
+
+	if (ExecutedPasses.Num() != NumPasses)
+	{
+		OutError = FString::Printf(TEXT("the graph executed %d passes, %d expected"), ExecutedPasses.Num(), NumPasses);
+		return false;
+	}
+	for (int32 ExecutedIndex = 0; ExecutedIndex < ExecutedPasses.Num(); ExecutedIndex++)
+	{
+		if (ExecutedPasses[ExecutedIndex] != ExecutedIndex)
+		{
+			OutError = FString::Printf(TEXT("the graph executed pass %d in place of pass %d"), ExecutedPasses[ExecutedIndex], ExecutedIndex);
+			return false;
+		}
+	}
+
+	TArray<FRHITexture*, TInlineAllocator<8>> DistinctAllocations;
+	for (int32 TextureIndex = 0; TextureIndex < Plan.Textures.Num(); TextureIndex++)
+	{
+		if (!ProducerAllocations[TextureIndex] || ProducerAllocations[TextureIndex] != ConsumerAllocations[TextureIndex])
+		{
+			OutError = FString::Printf(TEXT("texture %d is not the same allocation from its producer to its upsample"), TextureIndex);
+			return false;
+		}
+		DistinctAllocations.AddUnique(ProducerAllocations[TextureIndex]);
+
+		// Alive at once, from the producer to the upsample
+		const FTexture& Texture = Plan.Textures[TextureIndex];
+		for (int32 OtherIndex = 0; OtherIndex < TextureIndex; OtherIndex++)
+		{
+			const FTexture& Other = Plan.Textures[OtherIndex];
+			if (Other.ProducerPass <= Texture.LastConsumerPass && Texture.ProducerPass <= Other.LastConsumerPass && ProducerAllocations[OtherIndex] == ProducerAllocations[TextureIndex])
+			{
+				OutError = FString::Printf(TEXT("textures %d and %d are alive at once and share an allocation"), OtherIndex, TextureIndex);
+				return false;
+			}
+		}
+	}
+
+	if (DistinctAllocations.Num() != NumAllocations)
+	{
+		OutError = FString::Printf(TEXT("the graph allocated %d textures, %d expected"), DistinctAllocations.Num(), NumAllocations);
+		return false;
+	}
+
+	return true;
+}
 
-}
\ No newline at end of file
+#endif // !UE_BUILD_SHIPPING
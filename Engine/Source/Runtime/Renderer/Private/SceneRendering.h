@@ -42,6 +42,7 @@ struct FILCUpdatePrimTaskData;
 class FRaytracingLightDataPacked;
 class FRayTracingLocalShaderBindingWriter;
 struct FExposureBufferData;
+struct FDownsampledTranslucencyInputs;
 
 DECLARE_STATS_GROUP(TEXT("Command List Markers"), STATGROUP_CommandListMarkers, STATCAT_Advanced);
 
@@ -219,6 +220,43 @@ public:
 	}
 };
 
+/**
+ * Translucency and mesh passes of a translucent primitive in a view, looked up from its packed translucency relevance instead of
+ * testing each relevance flag against the view. Only valid for primitives rendered in the main pass without editor relevance.
+ */
+struct FTranslucencyRelevancePassTable
+{
+	enum
+	{
+		NormalTranslucencyBit = 1 << 0,
+		SeparateTranslucencyBit = 1 << 1,
+		SeparateTranslucencyModulateBit = 1 << 2,
+		DistortionBit = 1 << 3,
+		DownsampleTranslucencyResolutionShift = 4,
+		NumEntries = 1 << (DownsampleTranslucencyResolutionShift + 4)
+	};
+
+	static FORCEINLINE uint32 GetIndex(const FPrimitiveViewRelevance& ViewRelevance)
+	{
+		return (ViewRelevance.bNormalTranslucency ? NormalTranslucencyBit : 0)
+			| (ViewRelevance.bSeparateTranslucency ? SeparateTranslucencyBit : 0)
+			| (ViewRelevance.bSeparateTranslucencyModulate ? SeparateTranslucencyModulateBit : 0)
+			| (ViewRelevance.bDistortion ? DistortionBit : 0)
+			| (ViewRelevance.bDownSampleSeparateTranslucency ? uint32(ViewRelevance.DownSampleSeparateTranslucencyResolutionMask) << DownsampleTranslucencyResolutionShift : 0);
+	}
+
+	/** Fills the table for a view, given its family's AllowTranslucencyAfterDOF and whether it is a mobile scene capture. */
+	void Init(bool bAllowTranslucencyAfterDOF, bool bMobileSceneCapture);
+
+	/** Mesh passes of each entry, including distortion and the mobile scene capture inverse opacity. */
+	FMeshPassMask MeshPasses[NumEntries];
+
+	/** Bit per ETranslucencyPass::Type of each entry. */
+	uint16 TranslucencyPasses[NumEntries];
+};
+
+static_assert(ETranslucencyPass::TPT_MAX <= 16, "FTranslucencyRelevancePassTable::TranslucencyPasses is too small to fit all translucency passes.");
+
 /** A batched occlusion primitive. */
 struct FOcclusionPrimitive
 {
@@ -936,6 +974,28 @@ public:
 
 	/** Count of translucent prims for this view. */
 	FTranslucenyPrimCount TranslucentPrimCount;
+
+	/** Passes of the translucent primitives of this view by packed relevance, filled before computing the view relevance. */
+	FTranslucencyRelevancePassTable TranslucencyRelevancePassTable;
+
+	/** Resolution scale of the mobile off-screen particle pass (TranslucencyDownSampleSeparate), in (0, 1]. */
+	float MobileDownsampleTranslucencyScale = 0.5f;
+
+	/** Primitives of this view with off-screen particle relevance per EMobileDownsampleTranslucencyResolution, gathered by the relevance packets. Disabled stays empty. */
+	TArray<int32, SceneRenderingAllocator> MobileDownsampleTranslucencyPrimitives[(int32)EMobileDownsampleTranslucencyResolution::Num];
+
+	/** Full res pixels of the view which the off-screen particles can touch, relative to ViewRect.Min. */
+	FIntRect MobileDownsampleTranslucencyRect;
+
+	/**
+	 * Translucent sort distance of every visible primitive, indexed by primitive index and computed once by the relevance packets
+	 * for all the translucency passes. Entries of other primitives are NaN. Empty when r.SharedTranslucentSortDistances is 0.
+	 */
+	TArray<float, SceneRenderingAllocator> TranslucentSortDistances;
+
+	/** View transform TranslucentSortDistances were computed with, they are only valid for passes sorting with the same. */
+	FVector TranslucentSortDistancesViewOrigin = FVector::ZeroVector;
+	FMatrix TranslucentSortDistancesViewMatrix = FMatrix::Identity;
 	
 	bool bHasDistortionPrimitives;
 	bool bHasCustomDepthPrimitives;
@@ -1865,10 +1925,67 @@ protected:
 	/** Renders decals. */
 	void RenderDecals(FRHICommandListImmediate& RHICmdList);
 
+	/** Where the off-screen particles (TranslucencyDownSampleSeparate) are rendered relative to the scene color passes. */
+	enum class EDownSampleTranslucencyMode : uint8
+	{
+		None,
+		/** Low res pass rendered in the break the platform already takes between the opaque and translucency scene color passes, composited as the last translucent draw. */
+		CompositeInPass,
+		/** Scene color pass broken after translucency, the composite gets its own pass. */
+		SeparatePass,
+		/** Low res pass rendered before the scene color pass against the previous frame's reprojected depth, composited as the last translucent draw. */
+		ReprojectedDepth,
+		/** Both eyes of mobile multi-view rendered by single multi-view passes into array targets after translucency, the composite gets its own pass. */
+		MultiView,
+		/** Scene color pass ended after translucency, the low res passes and the composite are a render graph, which ends scene color rendering. */
+		RenderGraph,
+		/** Mobile multi-view without the multi-view passes, the off-screen particles of both eyes are drawn at full res after translucency in the scene color pass. */
+		FullResInPass,
+	};
+
+	/**
+	 * Picks the off-screen particle mode. bCanSplitSceneColorPass is false when scene color can't be stored after opaque,
+	 * bSceneColorPassSplit is true when the scene color pass is restarted for translucency anyway, see RequiresTranslucencyPass,
+	 * bCanStoreSceneDepth is false when the scene color pass can't store a single sample depth for the reprojection history,
+	 * bCanEndSceneColorPass is false when draws after translucency need the scene color pass, the Adreno occlusion queries or the MSAA pre-tonemap.
+	 */
+	EDownSampleTranslucencyMode GetDownSampleTranslucencyMode(bool bCanSplitSceneColorPass, bool bSceneColorPassSplit, bool bCanStoreSceneDepth, bool bCanEndSceneColorPass) const;
+
+	/** Whether scene depth is stored and downsampled after the scene color pass, for the next frame's reprojection. */
+	bool ShouldUpdateDownsampledTranslucencyDepthHistory(bool bCanStoreSceneDepth) const;
+
+	/** Writes the low res depth history of every view from the stored scene depth, must be called outside a render pass. */
+	void UpdateDownsampledTranslucencyDepthHistory(FRHICommandListImmediate& RHICmdList);
+
 	/** Renders the base pass for translucency. */
-	void RenderTranslucency(FRHICommandListImmediate& RHICmdList, const TArrayView<const FViewInfo*> PassViews, bool bRenderToSceneColor, bool bShouldRenderDownSampleTranslucency);
+	void RenderTranslucency(FRHICommandListImmediate& RHICmdList, const TArrayView<const FViewInfo*> PassViews, bool bRenderToSceneColor, EDownSampleTranslucencyMode DownSampleTranslucencyMode);
+
+	/** Renders the off-screen particles into the low res targets, of all views at once when they share an atlas. Must be called outside a render pass. */
+	void RenderTranslucency_DownSampleSeparate(FRHICommandListImmediate& RHICmdList, const TArrayView<const FViewInfo*>& PassViews, bool bReprojectDepth);
+
+	/** Upsamples the off-screen particles onto scene color, either inside the current scene color pass or in a new pass left open for the caller. */
+	void CompositeTranslucency_DownSampleSeparate(FRHICommandListImmediate& RHICmdList, const TArrayView<const FViewInfo*>& PassViews, bool bInSceneColorPass);
+
+	/**
+	 * Renders the off-screen particles of every view and composites them onto scene color through a render graph, see r.Mobile.SeparateTranslucencyRenderGraph.
+	 * Must be called outside a render pass, and leaves none begun.
+	 */
+	void RenderTranslucency_DownSampleSeparateGraph(FRHICommandListImmediate& RHICmdList, const TArrayView<const FViewInfo*>& PassViews);
+
+	/** Whether the off-screen particles of mobile multi-view are rendered for both eyes at once, see r.Mobile.SeparateTranslucencyMultiView. */
+	bool ShouldRenderDownsampledTranslucencyMultiView() const;
+
+	/** Renders every off-screen particle tier of both eyes of mobile multi-view into array targets, must be called outside a render pass. */
+	void RenderTranslucency_DownSampleSeparateMultiView(FRHICommandListImmediate& RHICmdList);
 
-	void RenderTranslucency_DownSampleSeparate(FRHICommandListImmediate& RHICmdList, const TArrayView<const FViewInfo*>& PassViews);
+	/** Upsamples the multi-view off-screen particles onto the multi-view scene color, in a new pass left open for the caller. */
+	void CompositeTranslucency_DownSampleSeparateMultiView(FRHICommandListImmediate& RHICmdList);
+
+	/** Draws the off-screen particles at full res into the current scene color pass, for both eyes with mobile multi-view. */
+	void RenderTranslucency_DownSampleSeparateFullRes(FRHICommandListImmediate& RHICmdList, const TArrayView<const FViewInfo*> PassViews);
+
+	/** Adds the estimated load/store traffic of a scene color path render pass to the per-frame stats, and counts it as a break when it loads scene color. */
+	static void AccountRenderPassBandwidth(const FRHIRenderPassInfo& RPInfo);
 
 	/** Perform upscaling when post process is not used. */
 	void BasicPostProcess(FRHICommandListImmediate& RHICmdList, FViewInfo &View, bool bDoUpscale, bool bDoEditorPrimitives);
@@ -1883,9 +2000,49 @@ protected:
 	void PreTonemapMSAA(FRHICommandListImmediate& RHICmdList);
 
 	//YJH
-	void MobileDownSampleDepth(FRHICommandListImmediate& RHICmdList, const FViewInfo& View, float DownsamplingScale);
+	/** Picks the off-screen particle resolution scale of every view, called by InitViews. */
+	void InitDownsampleTranslucencyScales(FRHICommandListImmediate& RHICmdList);
+
+	/** Returns the low res targets of the off-screen particles once composited, see r.Mobile.SeparateTranslucencyTransientTargets. */
+	void ReleaseDownsampledTranslucencyTargets();
+
+	/** Begins the low res particle pass with the depth of every view, downsampled from scene color alpha or reprojected from the previous frame. */
+	void MobileDownSampleDepth(FRHICommandListImmediate& RHICmdList, const TArrayView<const FViewInfo*>& PassViews, bool bReprojectDepth);
 
-	void UpsampleTranslucency(FRHICommandList& RHICmdList, const FViewInfo& View, float DownsamplingScale);
+	/** Draws the upsample of one resolution tier of one view, the render pass must already be begun. */
+	void UpsampleTranslucency(FRHICommandList& RHICmdList, const FViewInfo& View, EMobileDownsampleTranslucencyResolution Resolution);
+
+	/** Renders the off-screen particles of a fixed resolution tier (Full, Half, Quarter) of the views into its own pooled targets, must be called outside a render pass. */
+	void RenderDownsampledTranslucencyTier(FRHICommandListImmediate& RHICmdList, const TArrayView<const FViewInfo*>& PassViews, EMobileDownsampleTranslucencyResolution Resolution);
+
+	/**
+	 * Draws the particles of a resolution tier of a view into the low res render pass left open by its depth downsample, and ends that pass with bEndRenderPass.
+	 * Recorded in parallel command lists when r.Mobile.SeparateTranslucencyParallel allows it and the pass holds no other view.
+	 */
+	void DrawDownsampledTranslucencyPass(FRHICommandListImmediate& RHICmdList, const FViewInfo& View, EMobileDownsampleTranslucencyResolution Resolution, FRHITexture* ColorTarget, FRHITexture* DepthTarget, const FIntRect& DownsampledViewRect, const FIntRect& ScissorRect, bool bEndRenderPass);
+
+	/** Whether the off-screen particles of the views are rendered side by side into shared targets, see r.Mobile.SeparateTranslucencyViewAtlas. */
+	bool ShouldShareDownsampledTranslucencyAtlas() const;
+
+	/** Size of the atlas of the low res views of a tier, each followed by a gutter. Zero without any view. */
+	FIntPoint GetDownsampledTranslucencyAtlasSize(EMobileDownsampleTranslucencyResolution Resolution) const;
+
+	/** Low res rect of the view in the off-screen targets of a tier, at the origin unless the views share an atlas. */
+	FIntRect GetDownsampledTranslucencyViewRect(const FViewInfo& View, EMobileDownsampleTranslucencyResolution Resolution) const;
+
+	/** Size of the off-screen targets of a tier: the buffer size scaled for the view, or the atlas of all views. */
+	FIntPoint GetDownsampledTranslucencyTargetSize(const FViewInfo& View, EMobileDownsampleTranslucencyResolution Resolution) const;
+
+	/** Upsample inputs of a tier of the view from the low res textures of the tier: the full res pixels it covers, its scale and its place in the textures. */
+	FDownsampledTranslucencyInputs GetDownsampledTranslucencyInputs(const FViewInfo& View, EMobileDownsampleTranslucencyResolution Resolution, FRHITexture* Color, FRHITexture* Depth) const;
+
+	/** Whether any of the off-screen particle tiers in [FirstResolution, LastResolution] has draws in the view. */
+	static bool HasDownsampledTranslucencyDraws(const FViewInfo& View,
+		EMobileDownsampleTranslucencyResolution FirstResolution = EMobileDownsampleTranslucencyResolution::Full,
+		EMobileDownsampleTranslucencyResolution LastResolution = EMobileDownsampleTranslucencyResolution::Auto);
+
+	/** Lists the low res tiles with particle contribution for the composite, after the low res pass of the view. */
+	void ClassifyUpsampleTiles(FRHICommandListImmediate& RHICmdList, const FViewInfo& View);
 	//YJH End
 
 
@@ -1901,6 +2058,26 @@ protected:
 private:
 	bool bModulatedShadowsInUse;
 	bool bShouldRenderCustomDepth;
+	/** Closest and farthest depth of every off-screen particle texel, see r.Mobile.SeparateTranslucencyMinMaxDepth. */
+	TRefCountPtr<IPooledRenderTarget> DownsampledTranslucencyMinMaxDepthRT;
+	/** Whether the tile list of the off-screen particles was built for the composite, see r.Mobile.SeparateTranslucencyTileComposite. */
+	bool bDownsampledTranslucencyTileList = false;
+	/** Whether the off-screen targets hold the low res views of all views side by side, see r.Mobile.SeparateTranslucencyViewAtlas. */
+	bool bDownsampledTranslucencyAtlas = false;
+	/**
+	 * Off-screen targets of the resolution tiers, indexed by EMobileDownsampleTranslucencyResolution, with mobile multi-view array targets of one slice
+	 * per eye. Sized for the atlas when the views share one. The color is in the r.Mobile.SeparateTranslucencyColorFormat format. Allocated by the low res
+	 * passes and released by ReleaseDownsampledTranslucencyTargets.
+	 */
+	struct FDownsampledTranslucencyTier
+	{
+		TRefCountPtr<IPooledRenderTarget> Color;
+		TRefCountPtr<IPooledRenderTarget> Depth;
+
+		/** Allocates Color for BufferSize, with one slice per eye of mobile multi-view when bMultiView. */
+		void AllocateColor(FRHICommandList& RHICmdList, FIntPoint BufferSize, bool bMultiView, const TCHAR* Name);
+	};
+	FDownsampledTranslucencyTier DownsampledTranslucencyTiers[(int32)EMobileDownsampleTranslucencyResolution::Num];
 	static FGlobalDynamicIndexBuffer DynamicIndexBuffer;
 	static FGlobalDynamicVertexBuffer DynamicVertexBuffer;
 	static TGlobalResource<FGlobalDynamicReadBuffer> DynamicReadBuffer;
@@ -2055,6 +2232,20 @@ extern FFastVramConfig GFastVRamConfig;
 extern bool UseCachedMeshDrawCommands();
 extern bool IsDynamicInstancingEnabled(ERHIFeatureLevel::Type FeatureLevel);
 
+/** Writes the translucent sort distance of each of PrimitiveIndices to OutPrimitiveSortDistances[PrimitiveIndex]. */
+extern void ComputeTranslucentSortDistances(
+	ETranslucentSortPolicy::Type TranslucentSortPolicy,
+	const FVector& TranslucentSortAxis,
+	const FVector& ViewOrigin,
+	const FMatrix& ViewMatrix,
+	const TArray<struct FPrimitiveBounds>& PrimitiveBounds,
+	const int32* PrimitiveIndices,
+	int32 NumPrimitives,
+	float* RESTRICT OutPrimitiveSortDistances);
+
+/** Whether the view rotated or moved beyond the thresholds, in degrees and world units, since the given previous view. */
+extern bool IsLargeCameraMovement(const FSceneView& View, const FMatrix& PrevViewMatrix, const FVector& PrevViewOrigin, float CameraRotationThreshold, float CameraTranslationThreshold);
+
 enum class EGPUSkinCacheTransition
 {
 	FrameSetup,
@@ -40,6 +40,7 @@
 #include "HairStrands/HairStrandsRendering.h"
 #include "RectLightSceneProxy.h"
 #include "Math/Halton.h"
+#include "RendererModule.h"
 
 /*------------------------------------------------------------------------------
 	Globals
@@ -221,6 +222,13 @@ static TAutoConsoleVariable<int32> CVarParallelInitViews(
 	ECVF_RenderThreadSafe
 	);          
 
+static TAutoConsoleVariable<int32> CVarSharedTranslucentSortDistances(
+	TEXT("r.SharedTranslucentSortDistances"),
+	1,
+	TEXT("Whether the translucent sort distance of each primitive is computed once per view during visibility and shared by all the translucency passes, instead of once per pass."),
+	ECVF_RenderThreadSafe
+	);
+
 float GLightMaxDrawDistanceScale = 1.0f;
 static FAutoConsoleVariableRef CVarLightMaxDrawDistanceScale(
 	TEXT("r.LightMaxDrawDistanceScale"),
@@ -1816,6 +1824,201 @@ struct FDrawCommandRelevancePacket
 	}
 };
 
+void FTranslucencyRelevancePassTable::Init(bool bAllowTranslucencyAfterDOF, bool bMobileSceneCapture)
+{
+	for (uint32 Index = 0; Index < NumEntries; ++Index)
+	{
+		FMeshPassMask& MeshPassMask = MeshPasses[Index];
+		uint16& TranslucencyPassBits = TranslucencyPasses[Index];
+		MeshPassMask.Reset();
+		TranslucencyPassBits = 0;
+
+		// Distortion alone is not translucency relevance
+		if ((Index & ~uint32(DistortionBit)) == 0)
+		{
+			continue;
+		}
+
+		auto AddTranslucencyPass = [&MeshPassMask, &TranslucencyPassBits](ETranslucencyPass::Type TranslucencyPass)
+		{
+			TranslucencyPassBits |= 1 << TranslucencyPass;
+			MeshPassMask.Set(TranslucencyPassToMeshPass(TranslucencyPass));
+		};
+
+		if (bAllowTranslucencyAfterDOF)
+		{
+			if (Index & NormalTranslucencyBit)
+			{
+				AddTranslucencyPass(ETranslucencyPass::TPT_StandardTranslucency);
+			}
+
+			for (int32 ResolutionIndex = (int32)EMobileDownsampleTranslucencyResolution::Full; ResolutionIndex < (int32)EMobileDownsampleTranslucencyResolution::Num; ResolutionIndex++)
+			{
+				const EMobileDownsampleTranslucencyResolution Resolution = (EMobileDownsampleTranslucencyResolution)ResolutionIndex;
+				if ((Index >> DownsampleTranslucencyResolutionShift) & GetMobileDownsampleTranslucencyResolutionBit(Resolution))
+				{
+					AddTranslucencyPass(GetMobileDownsampleTranslucencyPass(Resolution));
+				}
+			}
+
+			if (Index & SeparateTranslucencyBit)
+			{
+				AddTranslucencyPass(ETranslucencyPass::TPT_TranslucencyAfterDOF);
+			}
+
+			if (Index & SeparateTranslucencyModulateBit)
+			{
+				AddTranslucencyPass(ETranslucencyPass::TPT_TranslucencyAfterDOFModulate);
+			}
+		}
+		else // Otherwise, everything is rendered in a single bucket. This is not related to whether DOF is currently enabled or not.
+		{
+			// When using all translucency, Standard and AfterDOF are sorted together instead of being rendered like 2 buckets.
+			AddTranslucencyPass(ETranslucencyPass::TPT_AllTranslucency);
+		}
+
+		if (Index & DistortionBit)
+		{
+			MeshPassMask.Set(EMeshPass::Distortion);
+		}
+
+		if (bMobileSceneCapture)
+		{
+			MeshPassMask.Set(EMeshPass::MobileInverseOpacity);
+		}
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+/** The per flag branches FTranslucencyRelevancePassTable replaced, kept as the reference of the benchmark below. */
+static FMeshPassMask GetTranslucentMeshPassesReference(const FPrimitiveViewRelevance& ViewRelevance, bool bAllowTranslucencyAfterDOF, bool bMobileSceneCapture)
+{
+	FMeshPassMask PassMask;
+	if (bAllowTranslucencyAfterDOF)
+	{
+		if (ViewRelevance.bNormalTranslucency)
+		{
+			PassMask.Set(EMeshPass::TranslucencyStandard);
+		}
+
+		if (ViewRelevance.bDownSampleSeparateTranslucency)
+		{
+			for (int32 ResolutionIndex = (int32)EMobileDownsampleTranslucencyResolution::Full; ResolutionIndex < (int32)EMobileDownsampleTranslucencyResolution::Num; ResolutionIndex++)
+			{
+				const EMobileDownsampleTranslucencyResolution Resolution = (EMobileDownsampleTranslucencyResolution)ResolutionIndex;
+				if (ViewRelevance.DownSampleSeparateTranslucencyResolutionMask & GetMobileDownsampleTranslucencyResolutionBit(Resolution))
+				{
+					PassMask.Set(TranslucencyPassToMeshPass(GetMobileDownsampleTranslucencyPass(Resolution)));
+				}
+			}
+		}
+
+		if (ViewRelevance.bSeparateTranslucency)
+		{
+			PassMask.Set(EMeshPass::TranslucencyAfterDOF);
+		}
+
+		if (ViewRelevance.bSeparateTranslucencyModulate)
+		{
+			PassMask.Set(EMeshPass::TranslucencyAfterDOFModulate);
+		}
+	}
+	else
+	{
+		PassMask.Set(EMeshPass::TranslucencyAll);
+	}
+
+	if (ViewRelevance.bDistortion)
+	{
+		PassMask.Set(EMeshPass::Distortion);
+	}
+
+	if (bMobileSceneCapture)
+	{
+		PassMask.Set(EMeshPass::MobileInverseOpacity);
+	}
+	return PassMask;
+}
+
+/** Times the translucent mesh pass branches against FTranslucencyRelevancePassTable on synthetic primitive relevances. */
+static void BenchmarkTranslucencyRelevancePassTable(const TArray<FString>& Args)
+{
+	const int32 NumPrimitives = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 100000;
+	const int32 NumIterations = 20;
+
+	FRandomStream RandomStream(0x2E1E);
+	TArray<FPrimitiveViewRelevance> ViewRelevances;
+	ViewRelevances.SetNum(NumPrimitives);
+	for (FPrimitiveViewRelevance& ViewRelevance : ViewRelevances)
+	{
+		// Mostly standard translucency, some off-screen particles and after DOF materials
+		ViewRelevance.bNormalTranslucency = RandomStream.FRand() < 0.7f;
+		ViewRelevance.bSeparateTranslucency = RandomStream.FRand() < 0.2f;
+		ViewRelevance.bSeparateTranslucencyModulate = RandomStream.FRand() < 0.05f;
+		ViewRelevance.bDistortion = RandomStream.FRand() < 0.1f;
+		ViewRelevance.DownSampleSeparateTranslucencyResolutionMask = RandomStream.FRand() < 0.3f ? RandomStream.RandRange(1, 15) : 0;
+		ViewRelevance.bDownSampleSeparateTranslucency = ViewRelevance.DownSampleSeparateTranslucencyResolutionMask != 0;
+		if (!ViewRelevance.HasTranslucency())
+		{
+			ViewRelevance.bNormalTranslucency = true;
+		}
+	}
+
+	for (int32 ConfigIndex = 0; ConfigIndex < 4; ++ConfigIndex)
+	{
+		const bool bAllowTranslucencyAfterDOF = (ConfigIndex & 1) == 0;
+		const bool bMobileSceneCapture = (ConfigIndex & 2) != 0;
+
+		FTranslucencyRelevancePassTable Table;
+		Table.Init(bAllowTranslucencyAfterDOF, bMobileSceneCapture);
+
+		uint32 ReferenceHash = 0;
+		uint32 TableHash = 0;
+		bool bMatch = true;
+
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			for (const FPrimitiveViewRelevance& ViewRelevance : ViewRelevances)
+			{
+				ReferenceHash = ReferenceHash * 31 + GetTranslucentMeshPassesReference(ViewRelevance, bAllowTranslucencyAfterDOF, bMobileSceneCapture).Data;
+			}
+		}
+		const double ReferenceSeconds = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			for (const FPrimitiveViewRelevance& ViewRelevance : ViewRelevances)
+			{
+				TableHash = TableHash * 31 + Table.MeshPasses[FTranslucencyRelevancePassTable::GetIndex(ViewRelevance)].Data;
+			}
+		}
+		const double TableSeconds = FPlatformTime::Seconds() - StartTime;
+
+		for (int32 PrimitiveIndex = 0; PrimitiveIndex < NumPrimitives && bMatch; ++PrimitiveIndex)
+		{
+			const FPrimitiveViewRelevance& ViewRelevance = ViewRelevances[PrimitiveIndex];
+			bMatch = Table.MeshPasses[FTranslucencyRelevancePassTable::GetIndex(ViewRelevance)].Data == GetTranslucentMeshPassesReference(ViewRelevance, bAllowTranslucencyAfterDOF, bMobileSceneCapture).Data;
+		}
+
+		UE_LOG(LogRenderer, Display, TEXT("Translucency relevance of %d primitives (AfterDOF %d, mobile scene capture %d), milliseconds: branches %.3f, table %.3f%s"),
+			NumPrimitives,
+			bAllowTranslucencyAfterDOF,
+			bMobileSceneCapture,
+			ReferenceSeconds * 1000.0 / NumIterations,
+			TableSeconds * 1000.0 / NumIterations,
+			bMatch && ReferenceHash == TableHash ? TEXT("") : TEXT(", MISMATCH"));
+	}
+}
+
+static FAutoConsoleCommand GBenchmarkTranslucencyRelevancePassTableCmd(
+	TEXT("r.BenchmarkTranslucencyRelevance"),
+	TEXT("Compares the per flag translucent mesh pass branches with the per view relevance lookup table on synthetic primitives.\n")
+	TEXT("Arguments: [NumPrimitives=100000]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkTranslucencyRelevancePassTable));
+#endif // !UE_BUILD_SHIPPING
+
 struct FRelevancePacket
 {
 	const float CurrentWorldTime;
@@ -1830,11 +2033,15 @@ struct FRelevancePacket
 	FPrimitiveViewMasks& OutHasDynamicMeshElementsMasks;
 	FPrimitiveViewMasks& OutHasDynamicEditorMeshElementsMasks;
 	uint8* RESTRICT MarkMasks;
+	/** The view's TranslucentSortDistances, nullptr when they are not shared. Packets write disjoint primitive indices. */
+	float* RESTRICT TranslucentSortDistances;
 
 	FRelevancePrimSet<int32> Input;
 	FRelevancePrimSet<int32> RelevantStaticPrimitives;
 	FRelevancePrimSet<int32> NotDrawRelevant;
 	FRelevancePrimSet<int32> TranslucentSelfShadowPrimitives;
+	FRelevancePrimSet<int32> DownsampleTranslucencyPrimitives[(int32)EMobileDownsampleTranslucencyResolution::Num];
+	FRelevancePrimSet<int32> TranslucentPrimitives;
 	FRelevancePrimSet<FPrimitiveSceneInfo*> VisibleDynamicPrimitivesWithSimpleLights;
 	int32 NumVisibleDynamicPrimitives;
 	int32 NumVisibleDynamicEditorPrimitives;
@@ -1908,6 +2115,7 @@ struct FRelevancePacket
 		FPrimitiveViewMasks& InOutHasDynamicMeshElementsMasks,
 		FPrimitiveViewMasks& InOutHasDynamicEditorMeshElementsMasks,
 		uint8* InMarkMasks,
+		float* InTranslucentSortDistances,
 		FMemStackBase& InPrimitiveCustomDataMemStack,
 		FPrimitiveViewMasks& InOutHasViewCustomDataMasks)
 
@@ -1922,6 +2130,7 @@ struct FRelevancePacket
 		, OutHasDynamicMeshElementsMasks(InOutHasDynamicMeshElementsMasks)
 		, OutHasDynamicEditorMeshElementsMasks(InOutHasDynamicEditorMeshElementsMasks)
 		, MarkMasks(InMarkMasks)
+		, TranslucentSortDistances(InTranslucentSortDistances)
 		, NumVisibleDynamicPrimitives(0)
 		, NumVisibleDynamicEditorPrimitives(0)
 		, bHasDistortionPrimitives(false)
@@ -1943,9 +2152,27 @@ struct FRelevancePacket
 	void AnyThreadTask()
 	{
 		ComputeRelevance();
+		ComputeTranslucentSortDistances();
 		MarkRelevant();
 	}
 
+	/** Sort distances of the packet's translucent primitives, shared by all the translucency passes of the view. */
+	void ComputeTranslucentSortDistances()
+	{
+		if (TranslucentPrimitives.NumPrims > 0 && TranslucentSortDistances)
+		{
+			::ComputeTranslucentSortDistances(
+				View.TranslucentSortPolicy,
+				View.TranslucentSortAxis,
+				View.TranslucentSortDistancesViewOrigin,
+				View.TranslucentSortDistancesViewMatrix,
+				Scene->PrimitiveBounds,
+				TranslucentPrimitives.Prims,
+				TranslucentPrimitives.NumPrims,
+				TranslucentSortDistances);
+		}
+	}
+
 	void ComputeRelevance()
 	{
 		CombinedShadingModelMask = 0;
@@ -2025,36 +2252,27 @@ struct FRelevancePacket
 				OutHasViewCustomDataMasks[BitIndex] |= ViewBit;
 			}
 
+			if (bTranslucentRelevance)
+			{
+				TranslucentPrimitives.AddPrim(BitIndex);
+			}
+
 			if (bTranslucentRelevance && !bEditorRelevance && ViewRelevance.bRenderInMainPass)
 			{
-				if (View.Family->AllowTranslucencyAfterDOF())
+				const uint32 TranslucencyRelevanceIndex = FTranslucencyRelevancePassTable::GetIndex(ViewRelevance);
+				for (uint32 TranslucencyPasses = View.TranslucencyRelevancePassTable.TranslucencyPasses[TranslucencyRelevanceIndex]; TranslucencyPasses; TranslucencyPasses &= TranslucencyPasses - 1)
 				{
-					if (ViewRelevance.bNormalTranslucency)
-					{
-						TranslucentPrimCount.Add(ETranslucencyPass::TPT_StandardTranslucency, ViewRelevance.bUsesSceneColorCopy, ViewRelevance.bDisableOffscreenRendering);
-					}
-
-					//Yjh Created By 2020-7-25
-					if (ViewRelevance.bDownSampleSeparateTranslucency) {
-						TranslucentPrimCount.Add(ETranslucencyPass::TPT_TranslucencyDownSampleSeparate, ViewRelevance.bUsesSceneColorCopy, ViewRelevance.bDisableOffscreenRendering);
-					}
-					//End
-
-					if (ViewRelevance.bSeparateTranslucency)
-					{
-						TranslucentPrimCount.Add(ETranslucencyPass::TPT_TranslucencyAfterDOF, ViewRelevance.bUsesSceneColorCopy, ViewRelevance.bDisableOffscreenRendering);
-					}
+					TranslucentPrimCount.Add((ETranslucencyPass::Type)FMath::CountTrailingZeros(TranslucencyPasses), ViewRelevance.bUsesSceneColorCopy, ViewRelevance.bDisableOffscreenRendering);
+				}
 
-					if (ViewRelevance.bSeparateTranslucencyModulate)
+				if (View.Family->AllowTranslucencyAfterDOF())
+				{
+					for (uint32 ResolutionBits = TranslucencyRelevanceIndex >> FTranslucencyRelevancePassTable::DownsampleTranslucencyResolutionShift; ResolutionBits; ResolutionBits &= ResolutionBits - 1)
 					{
-						TranslucentPrimCount.Add(ETranslucencyPass::TPT_TranslucencyAfterDOFModulate, ViewRelevance.bUsesSceneColorCopy, ViewRelevance.bDisableOffscreenRendering);
+						// Bit 0 of GetMobileDownsampleTranslucencyResolutionBit is Full
+						DownsampleTranslucencyPrimitives[(int32)EMobileDownsampleTranslucencyResolution::Full + FMath::CountTrailingZeros(ResolutionBits)].AddPrim(BitIndex);
 					}
 				}
-				else // Otherwise, everything is rendered in a single bucket. This is not related to whether DOF is currently enabled or not.
-				{
-					// When using all translucency, Standard and AfterDOF are sorted together instead of being rendered like 2 buckets.
-					TranslucentPrimCount.Add(ETranslucencyPass::TPT_AllTranslucency, ViewRelevance.bUsesSceneColorCopy, ViewRelevance.bDisableOffscreenRendering);
-				}
 
 				if (ViewRelevance.bDistortion)
 				{
@@ -2346,46 +2564,10 @@ struct FRelevancePacket
 							&& !ViewRelevance.bEditorPrimitiveRelevance
 							&& ViewRelevance.bRenderInMainPass)
 						{
-							if (View.Family->AllowTranslucencyAfterDOF())
-							{
-								if (ViewRelevance.bNormalTranslucency)
-								{
-									DrawCommandPacket.AddCommandsForMesh(PrimitiveIndex, PrimitiveSceneInfo, StaticMeshRelevance, StaticMesh, Scene, bCanCache, EMeshPass::TranslucencyStandard);
-								}
-
-								//Yjh Created By 2020-7-25
-								//for static DrawCommand
-								if (ViewRelevance.bDownSampleSeparateTranslucency) {
-									DrawCommandPacket.AddCommandsForMesh(PrimitiveIndex, PrimitiveSceneInfo, StaticMeshRelevance, StaticMesh, Scene, bCanCache, EMeshPass::TranslucencyDownSampleSeparate);
-								}
-								//End
-
-
-								if (ViewRelevance.bSeparateTranslucency)
-								{
-									DrawCommandPacket.AddCommandsForMesh(PrimitiveIndex, PrimitiveSceneInfo, StaticMeshRelevance, StaticMesh, Scene, bCanCache, EMeshPass::TranslucencyAfterDOF);
-								}
-
-								if (ViewRelevance.bSeparateTranslucencyModulate)
-								{
-									DrawCommandPacket.AddCommandsForMesh(PrimitiveIndex, PrimitiveSceneInfo, StaticMeshRelevance, StaticMesh, Scene, bCanCache, EMeshPass::TranslucencyAfterDOFModulate);
-								}
-							}
-							else
+							const FMeshPassMask& TranslucentMeshPasses = View.TranslucencyRelevancePassTable.MeshPasses[FTranslucencyRelevancePassTable::GetIndex(ViewRelevance)];
+							for (uint32 MeshPasses = TranslucentMeshPasses.Data; MeshPasses; MeshPasses &= MeshPasses - 1)
 							{
-								// Otherwise, everything is rendered in a single bucket. This is not related to whether DOF is currently enabled or not.
-								// When using all translucency, Standard and AfterDOF are sorted together instead of being rendered like 2 buckets.
-								DrawCommandPacket.AddCommandsForMesh(PrimitiveIndex, PrimitiveSceneInfo, StaticMeshRelevance, StaticMesh, Scene, bCanCache, EMeshPass::TranslucencyAll);
-							}
-
-							if (ViewRelevance.bDistortion)
-							{
-								DrawCommandPacket.AddCommandsForMesh(PrimitiveIndex, PrimitiveSceneInfo, StaticMeshRelevance, StaticMesh, Scene, bCanCache, EMeshPass::Distortion);
-							}
-
-							if (ShadingPath == EShadingPath::Mobile && View.bIsSceneCapture)
-							{
-								DrawCommandPacket.AddCommandsForMesh(PrimitiveIndex, PrimitiveSceneInfo, StaticMeshRelevance, StaticMesh, Scene, bCanCache, EMeshPass::MobileInverseOpacity);
+								DrawCommandPacket.AddCommandsForMesh(PrimitiveIndex, PrimitiveSceneInfo, StaticMeshRelevance, StaticMesh, Scene, bCanCache, (EMeshPass::Type)FMath::CountTrailingZeros(MeshPasses));
 							}
 						}
 
@@ -2450,6 +2632,10 @@ struct FRelevancePacket
 		WriteView.bHasSingleLayerWaterMaterial |= bHasSingleLayerWaterMaterial;
 		WriteView.bHasTranslucencySeparateModulation |= bHasTranslucencySeparateModulation;
 		VisibleDynamicPrimitivesWithSimpleLights.AppendTo(WriteView.VisibleDynamicPrimitivesWithSimpleLights);
+		for (int32 ResolutionIndex = 0; ResolutionIndex < (int32)EMobileDownsampleTranslucencyResolution::Num; ResolutionIndex++)
+		{
+			DownsampleTranslucencyPrimitives[ResolutionIndex].AppendTo(WriteView.MobileDownsampleTranslucencyPrimitives[ResolutionIndex]);
+		}
 		WriteView.NumVisibleDynamicPrimitives += NumVisibleDynamicPrimitives;
 		WriteView.NumVisibleDynamicEditorPrimitives += NumVisibleDynamicEditorPrimitives;
 		WriteView.TranslucentPrimCount.Append(TranslucentPrimCount);
@@ -2545,6 +2731,21 @@ static void ComputeAndMarkRelevanceForViewParallel(
 	FFrozenSceneViewMatricesGuard FrozenMatricesGuard(View);
 	const FMarkRelevantStaticMeshesForViewData ViewData(View);
 
+	View.TranslucencyRelevancePassTable.Init(View.Family->AllowTranslucencyAfterDOF(), Scene->GetShadingPath() == EShadingPath::Mobile && View.bIsSceneCapture);
+
+	View.TranslucentSortDistances.Reset();
+	if (CVarSharedTranslucentSortDistances.GetValueOnRenderThread() != 0)
+	{
+		// Filled by the relevance packets, the mesh pass setup tasks check the transform still matches the view's.
+		// Primitives without translucent relevance are left NaN, the passes compute their distance if they have translucent commands anyway.
+		View.TranslucentSortDistances.SetNumUninitialized(Scene->PrimitiveBounds.Num());
+		FMemory::Memset(View.TranslucentSortDistances.GetData(), 0xFF, View.TranslucentSortDistances.Num() * sizeof(float));
+		View.TranslucentSortDistancesViewOrigin = View.ViewMatrices.GetViewOrigin();
+		View.TranslucentSortDistancesViewMatrix = View.ViewMatrices.GetViewMatrix();
+	}
+
+	float* TranslucentSortDistances = View.TranslucentSortDistances.Num() > 0 ? View.TranslucentSortDistances.GetData() : nullptr;
+
 	int32 NumMesh = View.StaticMeshVisibilityMap.Num();
 	uint8* RESTRICT MarkMasks = (uint8*)FMemStack::Get().Alloc(NumMesh + 31 , 8); // some padding to simplify the high speed transpose
 	FMemory::Memzero(MarkMasks, NumMesh + 31);
@@ -2571,6 +2772,7 @@ static void ComputeAndMarkRelevanceForViewParallel(
 				OutHasDynamicMeshElementsMasks,
 				OutHasDynamicEditorMeshElementsMasks,
 				MarkMasks, 
+				TranslucentSortDistances,
 				WillExecuteInParallel ? View.AllocateCustomDataMemStack() : View.GetCustomDataGlobalMemStack(),
 				HasViewCustomDataMasks);
 			Packets.Add(Packet);
@@ -2597,6 +2799,7 @@ static void ComputeAndMarkRelevanceForViewParallel(
 							OutHasDynamicMeshElementsMasks,
 							OutHasDynamicEditorMeshElementsMasks,
 							MarkMasks,
+							TranslucentSortDistances,
 							WillExecuteInParallel ? View.AllocateCustomDataMemStack() : View.GetCustomDataGlobalMemStack(),
 							HasViewCustomDataMasks);
 						Packets.Add(Packet);
@@ -2787,50 +2990,11 @@ void ComputeDynamicMeshRelevance(EShadingPath ShadingPath, bool bAddLightmapDens
 		&& !ViewRelevance.bEditorPrimitiveRelevance
 		&& ViewRelevance.bRenderInMainPass)
 	{
-		if (View.Family->AllowTranslucencyAfterDOF())
-		{
-			if (ViewRelevance.bNormalTranslucency)
-			{
-				PassMask.Set(EMeshPass::TranslucencyStandard);
-				View.NumVisibleDynamicMeshElements[EMeshPass::TranslucencyStandard] += NumElements;
-			}
-
-			//Yjh Created By 2020-7-25
-			//for dynamicMesh
-			if (ViewRelevance.bDownSampleSeparateTranslucency) {
-				PassMask.Set(EMeshPass::TranslucencyDownSampleSeparate);
-				View.NumVisibleDynamicMeshElements[EMeshPass::TranslucencyDownSampleSeparate] += NumElements;
-			}
-			//End
-
-			if (ViewRelevance.bSeparateTranslucency)
-			{
-				PassMask.Set(EMeshPass::TranslucencyAfterDOF);
-				View.NumVisibleDynamicMeshElements[EMeshPass::TranslucencyAfterDOF] += NumElements;
-			}
-
-			if (ViewRelevance.bSeparateTranslucencyModulate)
-			{
-				PassMask.Set(EMeshPass::TranslucencyAfterDOFModulate);
-				View.NumVisibleDynamicMeshElements[EMeshPass::TranslucencyAfterDOFModulate] += NumElements;
-			}
-		}
-		else
-		{
-			PassMask.Set(EMeshPass::TranslucencyAll);
-			View.NumVisibleDynamicMeshElements[EMeshPass::TranslucencyAll] += NumElements;
-		}
-
-		if (ViewRelevance.bDistortion)
-		{
-			PassMask.Set(EMeshPass::Distortion);
-			View.NumVisibleDynamicMeshElements[EMeshPass::Distortion] += NumElements;
-		}
-
-		if (ShadingPath == EShadingPath::Mobile && View.bIsSceneCapture)
+		const FMeshPassMask& TranslucentMeshPasses = View.TranslucencyRelevancePassTable.MeshPasses[FTranslucencyRelevancePassTable::GetIndex(ViewRelevance)];
+		TranslucentMeshPasses.AppendTo(PassMask);
+		for (uint32 MeshPasses = TranslucentMeshPasses.Data; MeshPasses; MeshPasses &= MeshPasses - 1)
 		{
-			PassMask.Set(EMeshPass::MobileInverseOpacity);
-			View.NumVisibleDynamicMeshElements[EMeshPass::MobileInverseOpacity] += NumElements;
+			View.NumVisibleDynamicMeshElements[FMath::CountTrailingZeros(MeshPasses)] += NumElements;
 		}
 	}
 
@@ -3008,7 +3172,7 @@ void FSceneRenderer::GatherDynamicMeshElements(
 /**
  * Helper for InitViews to detect large camera movement, in both angle and position.
  */
-static bool IsLargeCameraMovement(FSceneView& View, const FMatrix& PrevViewMatrix, const FVector& PrevViewOrigin, float CameraRotationThreshold, float CameraTranslationThreshold)
+bool IsLargeCameraMovement(const FSceneView& View, const FMatrix& PrevViewMatrix, const FVector& PrevViewOrigin, float CameraRotationThreshold, float CameraTranslationThreshold)
 {
 	float RotationThreshold = FMath::Cos(FMath::DegreesToRadians(CameraRotationThreshold));
 	float ViewRightAngle = View.ViewMatrices.GetViewMatrix().GetColumn(0) | PrevViewMatrix.GetColumn(0);
@@ -6,6 +6,9 @@ TranslucencyPass.h: Translucency pass enum.
 
 #pragma once
 
+#include "PixelFormat.h"
+#include "Materials/MobileDownsampleTranslucencyResolution.h"
+
 // enum instead of bool to get better visibility when we pass around multiple bools, also allows for easier extensions
 namespace ETranslucencyPass
 {
@@ -13,6 +16,9 @@ namespace ETranslucencyPass
 	{
 		TPT_StandardTranslucency,
 		TPT_TranslucencyDownSampleSeparate,
+		TPT_TranslucencyDownSampleSeparateFull,
+		TPT_TranslucencyDownSampleSeparateHalf,
+		TPT_TranslucencyDownSampleSeparateQuarter,
 		TPT_TranslucencyAfterDOF,
 		TPT_TranslucencyAfterDOFModulate,
 
@@ -20,4 +26,76 @@ namespace ETranslucencyPass
 		TPT_AllTranslucency,
 		TPT_MAX
 	};
-};
\ No newline at end of file
+};
+
+/** Translucency pass drawing the off-screen particles of a resolution tier, the Auto tier keeps the original pass. */
+inline ETranslucencyPass::Type GetMobileDownsampleTranslucencyPass(EMobileDownsampleTranslucencyResolution Resolution)
+{
+	switch (Resolution)
+	{
+	case EMobileDownsampleTranslucencyResolution::Full: return ETranslucencyPass::TPT_TranslucencyDownSampleSeparateFull;
+	case EMobileDownsampleTranslucencyResolution::Half: return ETranslucencyPass::TPT_TranslucencyDownSampleSeparateHalf;
+	case EMobileDownsampleTranslucencyResolution::Quarter: return ETranslucencyPass::TPT_TranslucencyDownSampleSeparateQuarter;
+	case EMobileDownsampleTranslucencyResolution::Auto: return ETranslucencyPass::TPT_TranslucencyDownSampleSeparate;
+	}
+
+	return ETranslucencyPass::TPT_MAX;
+}
+
+/** Resolution tier of a mobile off-screen particle pass, Disabled for the other passes. */
+inline EMobileDownsampleTranslucencyResolution GetMobileDownsampleTranslucencyResolution(ETranslucencyPass::Type TranslucencyPass)
+{
+	switch (TranslucencyPass)
+	{
+	case ETranslucencyPass::TPT_TranslucencyDownSampleSeparateFull: return EMobileDownsampleTranslucencyResolution::Full;
+	case ETranslucencyPass::TPT_TranslucencyDownSampleSeparateHalf: return EMobileDownsampleTranslucencyResolution::Half;
+	case ETranslucencyPass::TPT_TranslucencyDownSampleSeparateQuarter: return EMobileDownsampleTranslucencyResolution::Quarter;
+	case ETranslucencyPass::TPT_TranslucencyDownSampleSeparate: return EMobileDownsampleTranslucencyResolution::Auto;
+	}
+
+	return EMobileDownsampleTranslucencyResolution::Disabled;
+}
+
+/** Whether the pass draws mobile off-screen particles, of any resolution tier. */
+inline bool IsMobileDownsampleTranslucencyPass(ETranslucencyPass::Type TranslucencyPass)
+{
+	return TranslucencyPass >= ETranslucencyPass::TPT_TranslucencyDownSampleSeparate && TranslucencyPass <= ETranslucencyPass::TPT_TranslucencyDownSampleSeparateQuarter;
+}
+
+/**
+ * FMeshDrawCommandSortKey::Translucent::Priority of the additive mesh batches of the mobile off-screen particle passes, see
+ * r.Mobile.SeparateTranslucencyAdditiveOrderFree. Free in those passes, it is otherwise only used by single layer water.
+ */
+static constexpr uint16 MobileOrderFreeTranslucencySortPriority = 0;
+
+/**
+ * The single mobile translucency pass drawing the mesh batches of a material, TPT_AllTranslucency aside. A primitive mixing materials
+ * is relevant to the passes of all of them, each of its batches must still only be drawn by the pass of its own material.
+ */
+inline ETranslucencyPass::Type GetMobileTranslucencyPass(bool bMobileSeparateTranslucency, EMobileDownsampleTranslucencyResolution DownsampleResolution)
+{
+	if (DownsampleResolution != EMobileDownsampleTranslucencyResolution::Disabled)
+	{
+		return GetMobileDownsampleTranslucencyPass(DownsampleResolution);
+	}
+	return bMobileSeparateTranslucency ? ETranslucencyPass::TPT_TranslucencyAfterDOF : ETranslucencyPass::TPT_StandardTranslucency;
+}
+
+/**
+ * Storage of the low res color of the mobile off-screen particles, see r.Mobile.SeparateTranslucencyColorFormat.
+ * Both formats hold premultiplied color and transmittance, and are blended linearly by the base pass blend states.
+ */
+enum class EMobileDownsampleTranslucencyColorFormat : uint8
+{
+	/** PF_FloatRGBA. */
+	FloatRGBA,
+	/** PF_B8G8R8A8, the color is clamped to 1. */
+	RGBA8,
+	Num
+};
+
+/** Pixel format of the low res color target of a format. */
+inline EPixelFormat GetMobileDownsampleTranslucencyColorPixelFormat(EMobileDownsampleTranslucencyColorFormat Format)
+{
+	return Format == EMobileDownsampleTranslucencyColorFormat::RGBA8 ? PF_B8G8R8A8 : PF_FloatRGBA;
+}
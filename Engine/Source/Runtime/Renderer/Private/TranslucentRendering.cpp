@@ -93,6 +93,9 @@ EMeshPass::Type TranslucencyPassToMeshPass(ETranslucencyPass::Type TranslucencyP
 	//YJH Created By 2020-7-25
 	case ETranslucencyPass::TPT_TranslucencyDownSampleSeparate: TranslucencyMeshPass = EMeshPass::TranslucencyDownSampleSeparate; break;
 	//End
+	case ETranslucencyPass::TPT_TranslucencyDownSampleSeparateFull: TranslucencyMeshPass = EMeshPass::TranslucencyDownSampleSeparateFull; break;
+	case ETranslucencyPass::TPT_TranslucencyDownSampleSeparateHalf: TranslucencyMeshPass = EMeshPass::TranslucencyDownSampleSeparateHalf; break;
+	case ETranslucencyPass::TPT_TranslucencyDownSampleSeparateQuarter: TranslucencyMeshPass = EMeshPass::TranslucencyDownSampleSeparateQuarter; break;
 	case ETranslucencyPass::TPT_TranslucencyAfterDOF: TranslucencyMeshPass = EMeshPass::TranslucencyAfterDOF; break;
 	case ETranslucencyPass::TPT_TranslucencyAfterDOFModulate: TranslucencyMeshPass = EMeshPass::TranslucencyAfterDOFModulate; break;
 	case ETranslucencyPass::TPT_AllTranslucency: TranslucencyMeshPass = EMeshPass::TranslucencyAll; break;
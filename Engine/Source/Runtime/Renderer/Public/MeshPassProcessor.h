@@ -35,6 +35,9 @@ namespace EMeshPass
 		//YJH Created By 2020-7-25
 		TranslucencyDownSampleSeparate,
 		//End
+		TranslucencyDownSampleSeparateFull, /** Mobile off-screen particles with a fixed resolution tier, TranslucencyDownSampleSeparate holds the Auto tier. */
+		TranslucencyDownSampleSeparateHalf,
+		TranslucencyDownSampleSeparateQuarter,
 		TranslucencyAll, /** Drawing all translucency, regardless of separate or standard.  Used when drawing translucency outside of the main renderer, eg FRendererModule::DrawTile. */
 		LightmapDensity,
 		DebugViewMode, /** Any of EDebugViewShaderMode */
@@ -71,6 +74,9 @@ inline const TCHAR* GetMeshPassName(EMeshPass::Type MeshPass)
 	//YJH Created By 2020-7-25
 	case EMeshPass::TranslucencyDownSampleSeparate: return TEXT("TranslucencyDownSampleSeparate");
 	//End
+	case EMeshPass::TranslucencyDownSampleSeparateFull: return TEXT("TranslucencyDownSampleSeparateFull");
+	case EMeshPass::TranslucencyDownSampleSeparateHalf: return TEXT("TranslucencyDownSampleSeparateHalf");
+	case EMeshPass::TranslucencyDownSampleSeparateQuarter: return TEXT("TranslucencyDownSampleSeparateQuarter");
 	case EMeshPass::TranslucencyAfterDOF: return TEXT("TranslucencyAfterDOF");
 	case EMeshPass::TranslucencyAfterDOFModulate: return TEXT("TranslucencyAfterDOFModulate");
 	case EMeshPass::TranslucencyAll: return TEXT("TranslucencyAll");